@@ -0,0 +1,22 @@
+void main() {
+    int i, j, k, n, t, a[80];
+
+    n = 80;
+    for (k = 0; k < 2000; k = k + 1) {
+        for (i = 0; i < n; i = i + 1) {
+            a[i] = (i * 7919 + k) % 101;
+        }
+
+        for (i = 0; i < n; i = i + 1) {
+            for (j = i + 1; j < n; j = j + 1) {
+                if (a[i] > a[j]) {
+                    t = a[i];
+                    a[i] = a[j];
+                    a[j] = t;
+                }
+            }
+        }
+    }
+
+    print(a[0], a[1], a[2], a[n - 1]);
+}
@@ -5,45 +5,151 @@
 #ifndef LLCC_ALL_API_H
 #define LLCC_ALL_API_H
 
+#include "front-end/frontend_api.h"
 #include "front-end/include/syntax_analyzer.h"
 #include "front-end/include/inter_code_generator.h"
+#include "back-end/backend_api.h"
 #include "back-end/include/interpreter.h"
+#include "back-end/include/jit.h"
+#include "back-end/include/asm_generator.h"
+#include "back-end/include/compile_cache.h"
 #include "lib/include/file_tools.h"
+#include "build_id.h"
 
 #include <ctime>
 #include <iostream>
 using std::cout;
 using std::endl;
 
+// 编译器版本，只用来显示；编译缓存的键是构建时算出的 LLCC_BUILD_ID
+#define LLCC_VERSION "v1.1"
+
+
+/**
+ * @brief 执行加载好的程序
+ */
+inline void execute_program(const Program & program, bool jit, string output) {
+    if (jit) {
+        Jit j;
+        if (! output.empty() && ! j.setOutputFile(output))
+            openOutputError(output);
+        j.execute(program);
+        return;
+    }
+
+    Interpreter intp;
+    if (! output.empty() && ! intp.setOutputFile(output))
+        openOutputError(output);
+    intp.execute(program);
+}
+
 
 /**
- * @brief 解释执行中间代码
- * @param path 中间代码文件路径
+ * @brief 编译并执行源文件，源代码没变时直接执行编译缓存里的字节码，跳过前端
+ * @param path 源文件路径
+ * @param jit 是否用 JIT 执行
+ * @param output 输出文件路径，空的输出到 stdout
  */
-inline void compile_and_execute(string path) {
+inline void compile_and_execute(string path, bool jit = false, string output = "") {
+    OperandScope operands;
+
 	// 读取源文件
-    vector<string> source_file = readSourceFile(path);
+    SourceFile source_file;
+    openSourceFile(source_file, path);
 
     time_t start_time = time(nullptr);
     cout << "start compiling " << path << "..." << endl << endl;
 
+    if (jit && ! Jit::isSupported()) {
+        cout << "JIT is not supported on this platform, fall back to the interpreter" << endl;
+        jit = false;
+    }
+
+    // 缓存文件先读进来，能用才算编译完了
+    Program program;
+    CompileCache cache(LLCC_BUILD_ID);
+    string entry = cache.enabled() ? cache.entryPath(source_file.data(), source_file.size()) : "";
+    if (! entry.empty() && Bytecode::isBytecodeFile(entry)) {
+        if (cache.load(entry, program)) {
+            cout << "compile finish in 0 sec(s) (cached)." << endl << endl;
+            cout << "------ start executing ------" << endl;
+            execute_program(program, jit, output);
+            return;
+        }
+        // 坏掉的缓存文件当作没有，重新编译覆盖掉
+        cout << "cached bytecode `" << entry << "` is broken, recompiling" << endl << endl;
+    }
+
 	// 词法分析 并 语法分析
-    SyntaxAnalyzer sa;
-    sa.analyze(source_file, false);
+    SyntaxTreeArena arena;
+    SyntaxAnalyzer sa(& arena);
+    sa.analyze(source_file.data(), source_file.size(), false);
 
-	// 语义分析并生成中间代码
+	// 语义分析并生成中间代码，之后语法树就没用了
     InterCodeGenerator icg;
     icg.analyze(sa.getSyntaxTree(), false);
-    icg.saveToFile(path + ".ic");
+    arena.release();
+
+	// 中间代码直接解码成程序，存进缓存，然后就地执行，不写 .ic 也不从缓存读回来
+    program.load(icg.getInterCode(), &icg.getLines());
+    if (! entry.empty())
+        cache.store(program, entry);
 
     time_t end_time = time(nullptr);
     cout << "compile finish in " << (end_time - start_time) << " sec(s)." << endl << endl;
 
-	// 解释执行
     cout << "------ start executing ------" << endl;
-    vector<Quadruple> inter_code_file = readInterCodeFile(path + ".ic");
-    Interpreter intp;
-    intp.execute(inter_code_file);
+    execute_program(program, jit, output);
+}
+
+
+/**
+ * @brief 编译源文件，生成二进制字节码文件，可以用 -i 执行；输入是 .ic 文件时直接转换
+ * @param path 源文件或者中间代码文件路径
+ * @param output 字节码文件路径，默认是 path + ".icb"
+ */
+inline void bytecode_generator(string path, string output = "") {
+    if (output.empty())
+        output = path + ".icb";
+
+    OperandScope operands;
+    bool is_inter_code = path.size() > 3 && path.substr(path.size() - 3) == ".ic";
+    Program program;
+    if (is_inter_code) {
+        InterCodeReader reader;
+        openInterCodeFile(reader, path);
+        program.load(reader);
+    }
+    else {
+        vector<int> lines;
+        vector<Quadruple> inter_code = code_generator(path, false, &lines);
+        program.load(inter_code, &lines);
+    }
+    if (! Bytecode::save(program, output))
+        openOutputError(output);
+
+    cout << "bytecode saved to " << output << endl;
+}
+
+
+/**
+ * @brief 编译源文件，生成 x86-64 汇编文件，可以直接用 gcc 汇编链接
+ * @param path 源文件路径
+ * @param output 汇编文件路径，默认是 path + ".s"
+ */
+inline void emit_asm(string path, string output = "") {
+    OperandScope operands;
+    if (output.empty())
+        output = path + ".s";
+
+    // 中间代码直接从内存里降低，不写 .ic 再读回来
+    vector<int> lines;
+    vector<Quadruple> inter_code = code_generator(path, false, &lines);
+    AsmGenerator ag;
+    ag.generate(inter_code, &lines);
+    ag.saveToFile(output);
+
+    cout << "assembly saved to " << output << endl;
 }
 
 #endif //LLCC_ALL_API_H
@@ -7,19 +7,89 @@
 #define LLCC_BACKEND_API_H
 
 #include "include/interpreter.h"
+#include "include/bytecode.h"
+#include "include/linker.h"
+#include "../lib/include/inter_code_writer.h"
 #include "../lib/include/file_tools.h"
 
 /**
- * @brief 解释执行中间代码
- * @param path 中间代码文件路径
+ * @brief 输出文件打不开就报错退出
  */
-inline void interpreter(string path) {
-    vector<Quadruple> inter_code_file = readInterCodeFile(path);
+inline void openOutputError(string output) {
+    cout << "File error" << endl;
+    cout << "cannot open `" << output << "` for writing" << endl;
+    exit(0);
+}
 
+
+/**
+ * @brief 解释执行中间代码，文本 (.ic) 和字节码 (.icb) 按文件头区分
+ * @param path 中间代码文件路径
+ * @param output 输出文件路径，空的输出到 stdout
+ * @param checkpoint 检查点文件，收到 SIGUSR1 / SIGINT / SIGTERM 时保存，空的不保存
+ * @param steps 另外每执行这么多条指令保存一次检查点，0 表示不定期保存
+ * @param resume 从这个检查点恢复，空的从头执行
+ */
+inline void interpreter(string path, string output = "", string checkpoint = "",
+                        long long steps = 0, string resume = "") {
+    OperandScope operands;
     Interpreter intp;
-    intp.execute(inter_code_file);
+    if (! output.empty() && ! intp.setOutputFile(output, ! resume.empty()))
+        openOutputError(output);
+    if (! checkpoint.empty())
+        intp.setCheckpoint(checkpoint, steps);
+    if (! resume.empty())
+        intp.setResume(resume);
+
+    if (Bytecode::isBytecodeFile(path)) {
+        if (! intp.executeBytecode(path)) {
+            cout << "File error" << endl;
+            cout << "`" << path << "` is not a valid bytecode file of this llcc version" << endl;
+            exit(0);
+        }
+        return;
+    }
+
+    InterCodeReader reader;
+    openInterCodeFile(reader, path);
+    intp.execute(reader);
 }
 
 
 
+/**
+ * @brief 把分别编译的目标文件链接成完整的程序
+ * @param inputs 目标文件 (.ico)，恰好一个里有 main
+ * @param output 输出文件路径，默认是 a.out.ic (binary 时是 a.out.icb)
+ * @param binary 输出字节码文件而不是文本的中间代码
+ */
+inline void link_objects(const vector<string> & inputs, string output = "", bool binary = false) {
+    if (output.empty())
+        output = binary ? "a.out.icb" : "a.out.ic";
+
+    OperandScope operands;
+    vector<Quadruple> code;
+    vector<int> lines;
+    try {
+        Linker linker;
+        for (auto & input: inputs)
+            linker.addObject(input);
+        linker.link(code, lines);
+    }
+    catch (Error & e) {
+        cout << "Link errors :" << endl;
+        cout << e;
+        exit(0);
+    }
+
+    // 链接结果先校验一遍，两种输出都一样
+    Program program;
+    program.load(code, &lines);
+    if (! (binary ? Bytecode::save(program, output) : InterCodeWriter::save(output, code, lines)))
+        openOutputError(output);
+
+    cout << "linked " << inputs.size() << " object(s) into " << output << endl;
+}
+
+
 #endif //LLCC_BACKEND_API_H
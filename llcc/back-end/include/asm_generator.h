@@ -0,0 +1,36 @@
+/**
+ * @file asm_generator.h
+ * @brief 把四元式编译成 GNU as 汇编 (x86-64, ELF)，gcc 汇编链接后直接运行
+ */
+#ifndef LLCC_ASM_GENERATOR_H
+#define LLCC_ASM_GENERATOR_H
+
+#include "../../lib/include/quadruple.h"
+#include "program.h"
+#include "gas_writer.h"
+
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+
+class AsmGenerator {
+private:
+    Program program;  // 预解码后的程序
+    string assembly;  // 生成的汇编
+
+    static string _escape(const string & str);
+    long long _memorySize();
+    string _runtime();
+    string _data(GasWriter & as, const vector<int> & pc_labels);
+
+public:
+    AsmGenerator();
+    void generate(const vector<Quadruple> & _code, const vector<int> * lines = nullptr);
+    void saveToFile(string path);
+};
+
+
+#endif //LLCC_ASM_GENERATOR_H
@@ -0,0 +1,61 @@
+/**
+ * @file bytecode.h
+ * @brief 二进制字节码文件 (.icb)，保存校验过的预解码程序，读入时只读映射，直接在映射上执行
+ *
+ * 文件布局，前面各段的记录大小都是 8 的倍数，映射 (按页对齐) 或者读到对齐的内存里就可以直接用:
+ *      | BytecodeHeader | 指令 x code_count | 下标操作数 x index_count | 行号表 x line_count |
+ *      | 字符串表 (offset, length) x string_count | 字符串内容，每个以 '\0' 结尾 |
+ *
+ * 指令和操作数按本机的内存布局存放，记录大小写在头里，不一致的文件拒绝读入。
+ * 立即数已经按指令类型解码在操作数里，pc+N 也已经改写成绝对地址，
+ * 所以常量池里只剩字符串。
+ * 文件的内容不可信，读入时在映射上只读地重新校验一遍 (见 Verifier)，栈的大小也重新算。
+ * 只有自己刚写下的文件 (编译缓存) 可以当作可信的，跳过校验，只碰到执行到的页。
+ */
+#ifndef LLCC_BYTECODE_H
+#define LLCC_BYTECODE_H
+
+#include "program.h"
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+using std::string;
+using std::vector;
+
+#define BYTECODE_MAGIC "LLCB"
+#define BYTECODE_VERSION 2
+
+
+struct BytecodeHeader {
+    char magic[4];          // BYTECODE_MAGIC
+    uint32_t version;       // BYTECODE_VERSION
+    uint32_t record_size;   // sizeof(Instruction)
+    uint32_t operand_size;  // sizeof(Operand)
+    uint32_t code_count;    // 指令条数，含末尾的哨兵 HALT
+    uint32_t index_count;   // 下标操作数个数
+    uint32_t string_count;  // 字符串个数
+    uint32_t string_bytes;  // 字符串内容的字节数
+    uint32_t line_count;    // 行号表的项数
+    uint32_t reserved;      // 凑齐 8 字节，写 0
+    int32_t v_size;         // 全局变量个数
+    int32_t t_size;         // 旧格式临时变量个数
+    int64_t stack_size;     // 栈的大小，可信的文件直接用，否则重新校验时再算一遍
+};
+
+
+class Bytecode {
+private:
+    static void _clean(Operand & dst, const Operand & src);
+    static bool _checkHeader(const BytecodeHeader & header, uint64_t file_size);
+    static bool _fail(Program & program);
+
+public:
+    static bool isBytecodeFile(const string & path);
+    static bool save(const Program & program, const string & path);
+    static bool load(const string & path, Program & program, bool trusted = false);
+};
+
+
+#endif //LLCC_BYTECODE_H
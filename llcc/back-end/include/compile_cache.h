@@ -0,0 +1,40 @@
+/**
+ * @file compile_cache.h
+ * @brief 编译缓存，按源代码和编译器构建标识的哈希存放编译好的字节码 (.icb)
+ *
+ * 缓存目录依次取 $LLCC_CACHE_DIR，$XDG_CACHE_HOME/llcc，$HOME/.cache/llcc，
+ * LLCC_CACHE_DIR 设成空串就不用缓存。
+ * 写入时先写临时文件再 rename，多个 llcc 进程同时读写同一个目录也不会读到半个文件。
+ * 缓存里的文件都是校验过的程序写下的，读的时候当作可信的，不再逐页校验。
+ */
+#ifndef LLCC_COMPILE_CACHE_H
+#define LLCC_COMPILE_CACHE_H
+
+#include "program.h"
+#include "bytecode.h"
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+using std::string;
+using std::vector;
+
+
+class CompileCache {
+private:
+    string dir;       // 缓存目录，空的表示不用缓存
+    string version;   // 编译器的构建标识，换了编译器旧的缓存就对不上
+
+    static bool _makeDirs(const string & path);
+
+public:
+    CompileCache(const string & _version);
+    bool enabled() const;
+    string entryPath(const char * source, size_t length) const;
+    bool load(const string & entry, Program & program) const;
+    bool store(const Program & program, const string & entry) const;
+};
+
+
+#endif //LLCC_COMPILE_CACHE_H
@@ -0,0 +1,94 @@
+/**
+ * @file execution_context.h
+ * @brief 一次执行的可变状态: pc，全局变量和栈，输出
+ *
+ * Program 加载后只读，多个 ExecutionContext (可以在不同线程里) 同时执行同一个 Program，
+ * 各自只分配自己的全局变量和栈。
+ *
+ * 检查点文件保存一次执行的全部状态，恢复后接着执行，结果和没中断过一样:
+ *      | CheckpointHeader | 内存 (Value) x used |
+ * 内存从 used 往后都是 0。
+ */
+#ifndef LLCC_EXECUTION_CONTEXT_H
+#define LLCC_EXECUTION_CONTEXT_H
+
+#include "program.h"
+#include "output_sink.h"
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+using std::string;
+using std::vector;
+
+#define CHECKPOINT_MAGIC "LLCK"
+#define CHECKPOINT_VERSION 1
+
+
+struct CheckpointHeader {
+    char magic[4];          // CHECKPOINT_MAGIC
+    uint32_t version;       // CHECKPOINT_VERSION
+    uint64_t fingerprint;   // Program::fingerprint()，换了程序不能恢复
+    int64_t memory_size;    // 内存的大小 (Value 个数)
+    int64_t used;           // 保存了前多少个 Value
+    int64_t index;          // pc
+    int64_t fp, sp;         // 相对内存开头的位置
+    int64_t output_size;    // 检查点时一共输出了多少字节
+};
+
+
+class ExecutionContext {
+private:
+    const Program & program;    // 共享的程序
+    OutputSink & output;        // PRINT 的输出
+    const Instruction * code;   // program 的代码
+    int index;                  // 我的pc指针
+    vector<Value> memory;       // 全局变量和栈，布局见 program.h
+    Value * base;               // 0 号全局变量的位置，前面是旧格式的临时变量
+    Value * bottom;             // 栈底，全局变量之上
+    Value * limit;              // 栈的上限
+    Value * fp;                 // 帧指针
+    Value * sp;                 // 栈顶
+    string checkpoint_path;     // 检查点文件，空的表示不保存
+    long long checkpoint_steps; // 每执行这么多条指令保存一次，0 表示只在收到信号时保存
+    unsigned saves_seen;        // 处理过的 SIGUSR1 / SIGINT+SIGTERM 计数，见 execution_context.cc
+    unsigned stops_seen;
+    bool stopped;               // 收到 SIGINT / SIGTERM，保存后停下了
+
+    void _reset();
+    void _loop(bool verbose);
+    void _executeStepped(bool verbose);
+    bool _saveCheckpoint();
+    bool _loadCheckpoint(const string & path);
+    Value _getValue(const Operand & operand);
+    Value & _slot(const Operand & operand);
+    Value & _indexed(Value * frame, const Operand & operand, Value * low, Value * high);
+    int _jumpTarget(const Operand & operand);
+
+    void _calc(int op);
+    void _execute(bool verbose = false);
+    void _executeThreaded();
+    void _print();
+    void _assign();
+    void _jump();
+    void _pop();
+    void _push();
+    void _call();
+    void _ret();
+    void _enter();
+    void _fatal(const char * message);
+
+public:
+    ExecutionContext(const Program & _program, OutputSink & _output);
+    ExecutionContext(const ExecutionContext &) = delete;
+    ExecutionContext & operator = (const ExecutionContext &) = delete;
+
+    void setCheckpoint(const string & path, long long steps = 0);
+    bool isStopped() const;
+    void run(bool verbose = false);
+    bool resume(const string & path, bool verbose = false);
+};
+
+
+#endif //LLCC_EXECUTION_CONTEXT_H
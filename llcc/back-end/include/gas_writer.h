@@ -0,0 +1,88 @@
+/**
+ * @file gas_writer.h
+ * @brief 把 x86-64 指令输出成 GNU as 的 intel 语法汇编
+ */
+#ifndef LLCC_GAS_WRITER_H
+#define LLCC_GAS_WRITER_H
+
+#include "x86_emitter.h"
+
+#include <string>
+#include <sstream>
+
+using std::string;
+using std::to_string;
+using std::stringstream;
+
+
+class GasWriter: public X86Emitter {
+private:
+    stringstream out;  // 生成的汇编
+    int label_count;   // 已经申请的 label 数
+
+    static const string REG_64[];
+    static const string REG_32[];
+    static const string COND[];
+
+    string _reg64(X86_REG_ENUM reg);
+    string _reg32(X86_REG_ENUM reg);
+    string _xmm(int xmm);
+    string _mem(const X86Mem & mem);
+    void _line(const string & ins);
+
+public:
+    GasWriter();
+
+    string labelName(int label);
+    static string runtimeName(X86_RUNTIME_ENUM func);
+    static string stringName(int string_index);
+    string str();
+
+    int newLabel() override;
+    void bind(int label) override;
+
+    // 通用寄存器
+    void push(X86_REG_ENUM reg) override;
+    void pop(X86_REG_ENUM reg) override;
+    void ret() override;
+    void movImm64(X86_REG_ENUM dst, uint64_t imm) override;
+    void movImm32(X86_REG_ENUM dst, int32_t imm) override;
+    void mov64(X86_REG_ENUM dst, X86_REG_ENUM src) override;
+    void movLoad(X86_REG_ENUM dst, const X86Mem & mem) override;
+    void movStore(const X86Mem & mem, X86_REG_ENUM src) override;
+    void lea(X86_REG_ENUM dst, const X86Mem & mem) override;
+    void add64(X86_REG_ENUM dst, X86_REG_ENUM src) override;
+    void sub64(X86_REG_ENUM dst, X86_REG_ENUM src) override;
+    void imul64(X86_REG_ENUM dst, X86_REG_ENUM src) override;
+    void cqo() override;
+    void idiv64(X86_REG_ENUM src) override;
+    void addImm64(X86_REG_ENUM dst, int32_t imm) override;
+    void subImm64(X86_REG_ENUM dst, int32_t imm) override;
+    void cmp64(X86_REG_ENUM a, X86_REG_ENUM b) override;
+    void cmpImm64(X86_REG_ENUM a, int32_t imm) override;
+
+    // SSE2 标量浮点
+    void movsdLoad(int xmm, const X86Mem & mem) override;
+    void movsdStore(const X86Mem & mem, int xmm) override;
+    void movqToXmm(int xmm, X86_REG_ENUM src) override;
+    void cvttsd2si64(X86_REG_ENUM dst, int xmm) override;
+    void cvtsi2sd64(int xmm, X86_REG_ENUM src) override;
+    void addsd(int dst, int src) override;
+    void subsd(int dst, int src) override;
+    void mulsd(int dst, int src) override;
+    void divsd(int dst, int src) override;
+    void ucomisd(int a, int b) override;
+
+    // 跳转
+    void jmp(int label) override;
+    void jcc(X86_COND_ENUM cond, int label) override;
+    void jmpMem(const X86Mem & mem) override;
+    void jmpReg(X86_REG_ENUM reg) override;
+    void callReg(X86_REG_ENUM reg) override;
+
+    void callRuntime(X86_RUNTIME_ENUM func) override;
+    void loadStringAddress(X86_REG_ENUM dst, int string_index) override;
+};
+
+
+#endif //LLCC_GAS_WRITER_H
@@ -0,0 +1,60 @@
+/**
+ * @file instruction.h
+ * @brief 预解码后的指令，解释器执行时不再处理字符串
+ */
+#ifndef LLCC_INSTRUCTION_H
+#define LLCC_INSTRUCTION_H
+
+#include "../../lib/include/quadruple.h"
+
+#include <cstdint>
+
+
+enum class OPERAND_KIND_ENUM {
+    NONE,          // 空操作数
+    IMMEDIATE,     // 立即数             3.5
+    PC,            // 相对pc的地址       pc+3
+    VAR,           // 寄存器             v12, 旧格式的临时变量 t3
+    VAR_INDEXED,   // 变址寻址           v0[v4]
+    LOCAL,         // 栈帧里的变量       l2, 参数在帧指针下面 l-3
+    LOCAL_INDEXED, // 栈帧里的变址寻址   l0[l4]
+    STRING         // 字符串常量         "hello"
+};
+
+
+/**
+ * @brief 寄存器和栈上的一个值，整数和浮点数共用 8 字节，怎么解释由指令决定
+ */
+union Value {
+    int64_t i;
+    double d;
+};
+
+
+/**
+ * @brief 操作数
+ * slot 的含义随 kind 变化：
+ *      VAR 为寄存器下标，VAR_INDEXED 为基址，PC 为偏移，STRING 为字符串池下标
+ *      LOCAL / LOCAL_INDEXED 同 VAR / VAR_INDEXED，但相对帧指针
+ *      旧格式的临时变量 tK 放在寄存器文件的负下标 -(K + 1) 处
+ * index 只对 *_INDEXED 有效，是下标操作数在操作数池中的位置
+ * value 只对 IMMEDIATE 有效，按指令的操作数类型解码成整数或浮点数
+ */
+struct Operand {
+    OPERAND_KIND_ENUM kind;
+    int slot;
+    int index;
+    Value value;
+};
+
+
+/**
+ * @brief 预解码的四元式
+ */
+struct Instruction {
+    INTER_CODE_OP_ENUM op;
+    Operand arg1, arg2, res;
+};
+
+
+#endif //LLCC_INSTRUCTION_H
@@ -7,40 +7,40 @@
 
 #include "../../lib/include/str_tools.h"
 #include "../../lib/include/quadruple.h"
+#include "program.h"
+#include "bytecode.h"
+#include "output_sink.h"
+#include "execution_context.h"
 
-#include <stack>
 #include <string>
 #include <vector>
 
-using std::stack;
 using std::string;
 using std::vector;
 
 
+/**
+ * @brief 加载并执行程序，执行状态在 ExecutionContext 里
+ */
 class Interpreter {
 private:
-    int index;              // 我的pc指针
-    int v_size;             // 变量表
-    int t_size;             // 零食变量表
-    vector<Quadruple> code; // 代码
-    vector<double> t_stack; // 零食变量栈
-    vector<double> v_stack; // 变量栈
-    stack<double> activity; // 活动栈
-
-    double _getValue(string value_str);
-    int _getAddress(string value_str);
-
-    void _calc(int op);
-    void _execute(bool verbose = false);
-    void _print();
-    void _assign();
-    void _jump();
-    void _pop();
-    void _push();
+    Program program;            // 预解码后的程序
+    OutputSink output;          // PRINT 的输出
+    string checkpoint_path;     // 执行时保存检查点的文件
+    long long checkpoint_steps; // 每执行多少条指令保存一次
+    string resume_path;         // 从这个检查点恢复，空的表示从头执行
+
+    void _run(const Program & _program, bool verbose);
 
 public:
     Interpreter();
-    void execute(vector<Quadruple> _code, bool verbose = false);
+    bool setOutputFile(const string & path, bool append = false);
+    void setCheckpoint(const string & path, long long steps = 0);
+    void setResume(const string & path);
+    void execute(const vector<Quadruple> & _code, bool verbose = false, const vector<int> * lines = nullptr);
+    void execute(InterCodeReader & reader, bool verbose = false);
+    void execute(const Program & _program, bool verbose = false);
+    bool executeBytecode(const string & path, bool verbose = false);
 };
 
 
@@ -0,0 +1,47 @@
+/**
+ * @file jit.h
+ * @brief 把四元式翻译成 x86-64 机器码直接执行
+ */
+#ifndef LLCC_JIT_H
+#define LLCC_JIT_H
+
+#include "../../lib/include/quadruple.h"
+#include "program.h"
+#include "x86_assembler.h"
+#include "x86_lowering.h"
+#include "bytecode.h"
+#include "output_sink.h"
+
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+// 只在 x86-64 的类 unix 系统上可用 (需要 mmap)
+#if defined(__x86_64__) && (defined(__linux__) || defined(__APPLE__))
+#define LLCC_JIT_SUPPORTED
+#endif
+
+
+class Jit {
+private:
+    Program program;           // 预解码后的程序
+    X86Assembler as;           // 机器码
+    vector<Value> memory;      // 寄存器文件 + 栈，布局见 program.h
+    vector<void *> jump_table; // pc -> 机器码地址，用于寄存器间接跳转
+    OutputSink output;         // PRINT 的输出
+
+    void _run(const Program & _program);
+
+public:
+    Jit();
+    static bool isSupported();
+    bool setOutputFile(const string & path);
+    void execute(const vector<Quadruple> & _code, const vector<int> * lines = nullptr);
+    void execute(const Program & _program);
+    bool executeBytecode(const string & path);
+};
+
+
+#endif //LLCC_JIT_H
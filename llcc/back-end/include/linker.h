@@ -0,0 +1,101 @@
+/**
+ * @file linker.h
+ * @brief 把几个分别编译的可重定位目标文件 (.ico) 链接成一个完整的程序
+ *
+ * 链接后的布局:
+ *      | ENTER 全局数据区大小 | 各文件的全局代码，有 main 的放最后 | 各文件的函数 |
+ *
+ * 没有 main 的文件的全局代码 (全局变量初始化) 执行完顺着落到下一个文件的全局代码，
+ * 最后执行 main，main 结束跳到末尾的哨兵。
+ *
+ * 全局数据区:
+ *      | 全局变量符号，同名的只有一份 | 文件 1 的数据区 | 文件 2 的数据区 | ... |
+ *
+ * 每个文件的 v 操作数是它自己数据区里的位置，落在全局变量符号里的改成符号的位置，
+ * 其余的 (main 的局部变量和临时变量) 加上这个文件数据区的起点。
+ */
+#ifndef LLCC_LINKER_H
+#define LLCC_LINKER_H
+
+#include "../../lib/include/error.h"
+#include "../../lib/include/str_tools.h"
+#include "../../lib/include/quadruple.h"
+#include "../../lib/include/inter_code_reader.h"
+#include "../../lib/include/inter_code_writer.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+using std::map;
+using std::string;
+using std::vector;
+
+
+/**
+ * @brief 全局变量符号，几个文件里同名的必须类型和大小都一样，最多一个有初值
+ */
+struct LinkData {
+    string name;
+    string type;        // 声明的类型，int / double / array-int ...
+    int slot;           // 在目标文件数据区里的位置，链接后是在全局数据区里的位置
+    int size;           // 占几个位置
+    bool initialized;   // 有没有初值
+};
+
+
+/**
+ * @brief 对别的文件里函数的调用
+ */
+struct LinkCall {
+    int pc;             // CALL 的位置
+    string name;
+    string arg_types;   // 实参类型 int;double
+};
+
+
+/**
+ * @brief 一个目标文件
+ */
+struct LinkUnit {
+    string path;
+    vector<Quadruple> code;     // pc 0 是本文件数据区的 ENTER
+    vector<int> lines;          // 每条四元式的源代码行号
+    int global_end;             // [1, global_end) 是全局代码，后面是函数
+    bool has_main;
+    int frame_size;             // 本文件数据区的大小
+    map<string, int> funcs;     // 定义的函数 -> pc
+    map<string, string> param_types;
+    vector<LinkData> data;
+    vector<int> code_relocs;    // res 是本文件里的 pc 的四元式
+    vector<LinkCall> calls;
+
+    int global_base;            // 全局代码在链接后的起点
+    int func_base;              // 函数在链接后的起点
+    int data_base;              // 本文件数据区在全局数据区里的起点
+};
+
+
+class Linker {
+private:
+    vector<LinkUnit> units;
+    map<string, LinkData> data;     // 全局变量符号，slot 是链接后的位置
+    int code_size;                  // 链接后的代码长度，不含哨兵
+
+    static vector<string> _split(const string & record);
+    static int _number(const string & field, const LinkUnit & unit);
+    void _readRecords(InterCodeReader & reader, LinkUnit & unit);
+    void _layout();
+    int _codeAddress(const LinkUnit & unit, int pc);
+    int _dataSlot(const LinkUnit & unit, int slot);
+    string _relocateData(const LinkUnit & unit, const string & text);
+    int _resolve(const LinkUnit & unit, const LinkCall & call);
+
+public:
+    Linker();
+    void addObject(const string & path);
+    void link(vector<Quadruple> & code, vector<int> & lines);
+};
+
+
+#endif //LLCC_LINKER_H
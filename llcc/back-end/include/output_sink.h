@@ -0,0 +1,56 @@
+/**
+ * @file output_sink.h
+ * @brief PRINT 的输出缓冲，整数和浮点数直接格式化到缓冲区里
+ */
+#ifndef LLCC_OUTPUT_SINK_H
+#define LLCC_OUTPUT_SINK_H
+
+#include <string>
+#include <cstdio>
+#include <cstdint>
+
+using std::string;
+
+#define OUTPUT_BUFFER_SIZE (1 << 16)
+
+
+// 什么时候把缓冲区写出去
+enum class FLUSH_POLICY_ENUM {
+    FULL,   // 缓冲区满了或者结束时
+    LINE,   // 每次换行
+    ALWAYS  // 每次输出，和调试信息交替输出时用
+};
+
+
+class OutputSink {
+private:
+    FILE * file;                     // 输出目标
+    bool owned;                      // file 是不是自己打开的
+    FLUSH_POLICY_ENUM policy;
+    char buffer[OUTPUT_BUFFER_SIZE];
+    int length;                      // 缓冲区里已有的字节数
+    int64_t flushed;                 // 已经写出去的字节数
+
+    void _reserve(int size);
+    void _written();
+
+public:
+    OutputSink();
+    ~OutputSink();
+
+    bool open(const string & path, bool append = false);
+    bool truncate(int64_t size);
+    int64_t size() const;
+    void setFlushPolicy(FLUSH_POLICY_ENUM _policy);
+
+    void writeInt(int64_t value);
+    void writeDouble(double value);
+    void writeString(const string & str);
+    void writeString(const char * str, int size);
+    void writeChar(char ch);
+    void writeNewline();
+    void flush();
+};
+
+
+#endif //LLCC_OUTPUT_SINK_H
@@ -0,0 +1,129 @@
+/**
+ * @file program.h
+ * @brief 预解码后的程序，解释器和 JIT 共用
+ */
+#ifndef LLCC_PROGRAM_H
+#define LLCC_PROGRAM_H
+
+#include "../../lib/include/str_tools.h"
+#include "../../lib/include/quadruple.h"
+#include "../../lib/include/inter_code_reader.h"
+#include "instruction.h"
+
+#include <string>
+#include <vector>
+#include <algorithm>
+
+using std::string;
+using std::vector;
+
+/*
+ * 运行时的内存是一整块连续的栈:
+ *
+ *      | 旧格式临时变量 | 全局变量 (v) | 栈帧 ... |
+ *                      ^ base
+ *
+ * 全局变量就是最外层的栈帧，大小由 pc 0 的 ENTER 声明。函数的栈帧:
+ *
+ *      | 参数 ... | 返回地址 | 调用者的帧指针 | 局部变量和临时变量 (l) ... |
+ *                                           ^ fp
+ *
+ * CALL 写入两个链接字，ENTER 把栈顶移到 fp + 帧大小，RET 连同参数一起弹出
+ */
+#define PROGRAM_STACK_SIZE (1 << 20) // 栈的默认大小 (Value 个数)，用在算不出栈深度的程序上
+#define PROGRAM_INDEX_DEPTH 64       // 下标操作数最多嵌套几层，执行时算地址是递归的
+
+
+/**
+ * @brief 行号表的一项: 从 pc 开始 (到下一项之前) 的指令都来自源代码第 line 行，0 表示不知道
+ */
+struct LineEntry {
+    int32_t pc;
+    int32_t line;
+};
+
+
+/**
+ * @brief 字符串表的一项: 内容是字符串区的 [offset, offset + length)，后面跟着 '\0'
+ */
+struct StringEntry {
+    uint32_t offset;
+    uint32_t length;
+};
+
+
+// 立即数的解码方式
+enum class VALUE_TYPE_ENUM {
+    INT,    // 整数
+    DOUBLE, // 浮点数
+    RAW     // 看字面量本身，有小数点的是浮点数 (PUSH 的操作数)
+};
+
+
+/**
+ * @brief 可以执行的程序，代码要么是从四元式解码出来存在 *_storage 里的，
+ * 要么直接指向只读映射的字节码文件，执行时只通过 code / index_pool / string_table 访问
+ */
+class Program {
+    friend class Bytecode;  // 读写字节码文件时直接填字段，不经过解码
+
+private:
+    const Instruction * code;       // 预解码后的代码，末尾是哨兵 HALT
+    int code_size;                  // 指令条数，含哨兵
+    const Operand * index_pool;     // 变址寻址的下标操作数
+    int index_size;
+    const StringEntry * string_table;   // 字符串常量，内容在 string_data 里
+    int string_count;
+    const char * string_data;
+    int v_size;                     // 全局变量个数
+    int t_size;                     // 旧格式临时变量个数
+    long long stack_size;           // 栈的大小 (Value 个数)，校验时算出
+    const LineEntry * line_table;   // 行号表，按 pc 排序，执行时不用，报错和调试时查
+    int line_count;
+
+    vector<Instruction> code_storage;   // 解码的时候代码存在这里，映射字节码时为空
+    vector<Operand> index_storage;
+    vector<LineEntry> line_storage;
+    vector<StringEntry> string_storage;
+    string text_storage;                // 解码出来的字符串内容
+    const void * mapping;               // 映射的字节码文件，没有是 nullptr
+    size_t mapping_size;
+
+    static bool _isFloat(INTER_CODE_OP_ENUM op);
+    Operand _decodeOperand(const string & value_str, VALUE_TYPE_ENUM type = VALUE_TYPE_ENUM::INT);
+    void _begin();
+    void _append(const Quadruple & q);
+    void _finish();
+    void _resolvePc(Operand & operand, int pc);
+    void _addLine(int pc, int line);
+    void _bindStorage();
+    static void _hash(uint64_t & hash, const void * data, size_t size);
+    static void _hashOperand(uint64_t & hash, const Operand & operand);
+
+public:
+    Program();
+    ~Program();
+    Program(const Program &) = delete;
+    Program & operator = (const Program &) = delete;
+
+    void load(const vector<Quadruple> & quadruples, const vector<int> * lines = nullptr);
+    void load(InterCodeReader & reader);
+    void release();
+    uint64_t fingerprint() const;
+    int lineOf(int pc) const;
+    const char * stringAt(int i) const;
+    int stringLength(int i) const;
+
+    // 加载后只读，执行时只通过这些访问
+    const Instruction * getCode() const { return code; }
+    int getCodeSize() const { return code_size; }
+    const Operand * getIndexPool() const { return index_pool; }
+    int getIndexSize() const { return index_size; }
+    int getStringCount() const { return string_count; }
+    int getVSize() const { return v_size; }
+    int getTSize() const { return t_size; }
+    long long getStackSize() const { return stack_size; }
+};
+
+
+#endif //LLCC_PROGRAM_H
@@ -0,0 +1,55 @@
+/**
+ * @file verifier.h
+ * @brief 加载时校验字节码，检查跳转目标和操作数，算出栈需要多大，只读不改程序
+ */
+#ifndef LLCC_VERIFIER_H
+#define LLCC_VERIFIER_H
+
+#include "../../lib/include/error.h"
+#include "../../lib/include/str_tools.h"
+#include "program.h"
+
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+
+/**
+ * @brief 一段栈帧: 从函数的 ENTER 到下一个 ENTER 之前，0 号是 pc 0 开始的全局代码
+ */
+struct FrameInfo {
+    int start, end;   // [start, end)
+    int frame_size;   // ENTER 声明的帧大小
+    int param_count;  // RET 弹出的参数个数，-1 表示没有 RET
+};
+
+
+class Verifier {
+private:
+    const Program & program;
+    bool from_file;             // 程序来自字节码文件，见构造函数
+    vector<FrameInfo> frames;   // 按 start 排序
+    vector<int> frame_of;       // pc -> 所在栈帧的下标
+    vector<long long> need;     // 每段栈帧执行时最多用多少栈
+
+    void _checkEncoding();
+    void _splitFrames();
+    void _checkInstruction(int pc);
+    void _checkValue(const Operand & operand, int pc, int index_bound, int depth = 0);
+    void _checkMemory(const Operand & operand, int pc, int index_bound, int depth = 0);
+    void _checkSlot(OPERAND_KIND_ENUM kind, long long slot, int pc);
+    void _checkTarget(const Operand & operand, int pc);
+    static bool _isStatic(const Operand & operand);
+    static int64_t _immediate(const Operand & operand, int pc);
+    long long _stackNeed(int frame);
+    string _where(int pc);
+
+public:
+    Verifier(const Program & _program, bool _from_file = false);
+    long long verify();
+};
+
+
+#endif //LLCC_VERIFIER_H
@@ -0,0 +1,92 @@
+/**
+ * @file x86_assembler.h
+ * @brief 一个很小的 x86-64 机器码汇编器，只覆盖 JIT 用到的指令
+ */
+#ifndef LLCC_X86_ASSEMBLER_H
+#define LLCC_X86_ASSEMBLER_H
+
+#include "x86_emitter.h"
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+using std::string;
+using std::vector;
+
+
+class X86Assembler: public X86Emitter {
+private:
+    vector<uint8_t> buffer;      // 生成的机器码
+    vector<int> label_pos;       // label 的位置，-1 表示还没有绑定
+    vector<int> fixup_pos;       // 待回填的 rel32 位置
+    vector<int> fixup_label;     // 待回填的 rel32 对应的 label
+    vector<void *> runtime;      // 运行时函数的地址
+    const vector<const char *> * string_pool; // 字符串常量的地址
+
+    void _byte(int b);
+    void _int32(int32_t x);
+    void _rex(bool w, int reg, int index, int base, bool force = false);
+    void _modrm(int reg, const X86Mem & mem);
+    void _modrmReg(int reg, int rm);
+    void _sse(int prefix, int opcode, int reg, const X86Mem & mem);
+    void _sseReg(int prefix, int opcode, int reg, int rm, bool w = false);
+    void _rel32(int label);
+
+public:
+    X86Assembler();
+
+    void setRuntime(X86_RUNTIME_ENUM func, void * address);
+    void setStringPool(const vector<const char *> * _string_pool);
+    int position();
+    int labelPosition(int label);
+    const vector<uint8_t> & finish();
+
+    int newLabel() override;
+    void bind(int label) override;
+
+    // 通用寄存器
+    void push(X86_REG_ENUM reg) override;
+    void pop(X86_REG_ENUM reg) override;
+    void ret() override;
+    void movImm64(X86_REG_ENUM dst, uint64_t imm) override;
+    void movImm32(X86_REG_ENUM dst, int32_t imm) override;
+    void mov64(X86_REG_ENUM dst, X86_REG_ENUM src) override;
+    void movLoad(X86_REG_ENUM dst, const X86Mem & mem) override;
+    void movStore(const X86Mem & mem, X86_REG_ENUM src) override;
+    void lea(X86_REG_ENUM dst, const X86Mem & mem) override;
+    void add64(X86_REG_ENUM dst, X86_REG_ENUM src) override;
+    void sub64(X86_REG_ENUM dst, X86_REG_ENUM src) override;
+    void imul64(X86_REG_ENUM dst, X86_REG_ENUM src) override;
+    void cqo() override;
+    void idiv64(X86_REG_ENUM src) override;
+    void addImm64(X86_REG_ENUM dst, int32_t imm) override;
+    void subImm64(X86_REG_ENUM dst, int32_t imm) override;
+    void cmp64(X86_REG_ENUM a, X86_REG_ENUM b) override;
+    void cmpImm64(X86_REG_ENUM a, int32_t imm) override;
+
+    // SSE2 标量浮点
+    void movsdLoad(int xmm, const X86Mem & mem) override;
+    void movsdStore(const X86Mem & mem, int xmm) override;
+    void movqToXmm(int xmm, X86_REG_ENUM src) override;
+    void cvttsd2si64(X86_REG_ENUM dst, int xmm) override;
+    void cvtsi2sd64(int xmm, X86_REG_ENUM src) override;
+    void addsd(int dst, int src) override;
+    void subsd(int dst, int src) override;
+    void mulsd(int dst, int src) override;
+    void divsd(int dst, int src) override;
+    void ucomisd(int a, int b) override;
+
+    // 跳转
+    void jmp(int label) override;
+    void jcc(X86_COND_ENUM cond, int label) override;
+    void jmpMem(const X86Mem & mem) override;
+    void jmpReg(X86_REG_ENUM reg) override;
+    void callReg(X86_REG_ENUM reg) override;
+
+    void callRuntime(X86_RUNTIME_ENUM func) override;
+    void loadStringAddress(X86_REG_ENUM dst, int string_index) override;
+};
+
+
+#endif //LLCC_X86_ASSEMBLER_H
@@ -0,0 +1,114 @@
+/**
+ * @file x86_emitter.h
+ * @brief x86-64 指令输出接口，JIT 输出机器码，--emit-asm 输出 GNU as 汇编
+ */
+#ifndef LLCC_X86_EMITTER_H
+#define LLCC_X86_EMITTER_H
+
+#include <cstdint>
+
+
+enum class X86_REG_ENUM {
+    RAX = 0, RCX, RDX, RBX, RSP, RBP, RSI, RDI,
+    R8, R9, R10, R11, R12, R13, R14, R15,
+    NONE = -1
+};
+
+
+// 条件码，对应 Jcc 的低 4 位
+enum class X86_COND_ENUM {
+    B  = 0x2,
+    AE = 0x3,
+    E  = 0x4,
+    NE = 0x5,
+    BE = 0x6,
+    A  = 0x7,
+    P  = 0xA,
+    NP = 0xB,
+    L  = 0xC,
+    G  = 0xF
+};
+
+
+// 生成的代码会调用的运行时函数，第一个参数 (rdi) 都是生成的函数收到的 context
+enum class X86_RUNTIME_ENUM {
+    PRINT_INT,      // 输出 rsi
+    PRINT_DOUBLE,   // 输出 xmm0
+    PRINT_STRING,   // 输出 rsi 指向的字符串
+    PRINT_NEWLINE,  // 换行
+    STACK_EMPTY,    // 栈空报错，不返回
+    STACK_OVERFLOW, // 栈满报错，不返回
+    INDEX_OUT_OF_RANGE // 下标越界报错，不返回
+};
+
+
+/**
+ * @brief 内存操作数 [base + index * scale + disp]
+ */
+struct X86Mem {
+    X86_REG_ENUM base;
+    X86_REG_ENUM index;
+    int scale;
+    int disp;
+
+    X86Mem(X86_REG_ENUM _base, int _disp = 0,
+           X86_REG_ENUM _index = X86_REG_ENUM::NONE, int _scale = 1);
+};
+
+
+/**
+ * @brief 指令输出接口，xmm 参数是 xmm 寄存器编号
+ */
+class X86Emitter {
+public:
+    virtual ~X86Emitter();
+
+    virtual int newLabel() = 0;
+    virtual void bind(int label) = 0;
+
+    // 通用寄存器
+    virtual void push(X86_REG_ENUM reg) = 0;
+    virtual void pop(X86_REG_ENUM reg) = 0;
+    virtual void ret() = 0;
+    virtual void movImm64(X86_REG_ENUM dst, uint64_t imm) = 0;
+    virtual void movImm32(X86_REG_ENUM dst, int32_t imm) = 0;
+    virtual void mov64(X86_REG_ENUM dst, X86_REG_ENUM src) = 0;
+    virtual void movLoad(X86_REG_ENUM dst, const X86Mem & mem) = 0;
+    virtual void movStore(const X86Mem & mem, X86_REG_ENUM src) = 0;
+    virtual void lea(X86_REG_ENUM dst, const X86Mem & mem) = 0;
+    virtual void add64(X86_REG_ENUM dst, X86_REG_ENUM src) = 0;
+    virtual void sub64(X86_REG_ENUM dst, X86_REG_ENUM src) = 0;
+    virtual void imul64(X86_REG_ENUM dst, X86_REG_ENUM src) = 0;
+    virtual void cqo() = 0;
+    virtual void idiv64(X86_REG_ENUM src) = 0;
+    virtual void addImm64(X86_REG_ENUM dst, int32_t imm) = 0;
+    virtual void subImm64(X86_REG_ENUM dst, int32_t imm) = 0;
+    virtual void cmp64(X86_REG_ENUM a, X86_REG_ENUM b) = 0;
+    virtual void cmpImm64(X86_REG_ENUM a, int32_t imm) = 0;
+
+    // SSE2 标量浮点
+    virtual void movsdLoad(int xmm, const X86Mem & mem) = 0;
+    virtual void movsdStore(const X86Mem & mem, int xmm) = 0;
+    virtual void movqToXmm(int xmm, X86_REG_ENUM src) = 0;
+    virtual void cvttsd2si64(X86_REG_ENUM dst, int xmm) = 0;
+    virtual void cvtsi2sd64(int xmm, X86_REG_ENUM src) = 0;
+    virtual void addsd(int dst, int src) = 0;
+    virtual void subsd(int dst, int src) = 0;
+    virtual void mulsd(int dst, int src) = 0;
+    virtual void divsd(int dst, int src) = 0;
+    virtual void ucomisd(int a, int b) = 0;
+
+    // 跳转
+    virtual void jmp(int label) = 0;
+    virtual void jcc(X86_COND_ENUM cond, int label) = 0;
+    virtual void jmpMem(const X86Mem & mem) = 0;
+    virtual void jmpReg(X86_REG_ENUM reg) = 0;
+    virtual void callReg(X86_REG_ENUM reg) = 0;
+
+    // 和输出目标相关的: 调用运行时，取字符串常量的地址
+    virtual void callRuntime(X86_RUNTIME_ENUM func) = 0;
+    virtual void loadStringAddress(X86_REG_ENUM dst, int string_index) = 0;
+};
+
+
+#endif //LLCC_X86_EMITTER_H
@@ -0,0 +1,52 @@
+/**
+ * @file x86_lowering.h
+ * @brief 把预解码的程序翻译成 x86-64 指令，JIT 和 --emit-asm 共用
+ */
+#ifndef LLCC_X86_LOWERING_H
+#define LLCC_X86_LOWERING_H
+
+#include "program.h"
+#include "x86_emitter.h"
+
+#include <vector>
+
+using std::vector;
+
+
+/**
+ * @brief 生成的函数原型:
+ *      void f(Value * base, Value * stack, Value * stack_limit, void ** jump_table, void * context)
+ *
+ * base 是 0 号全局变量的地址，stack 是全局变量之上的栈底，内存布局见 program.h
+ * jump_table[pc] 是第 pc 条指令的入口地址，由使用者根据 pc_labels 填好
+ * context 原样作为第一个参数传给运行时函数，生成的代码不看它
+ */
+class X86Lowering {
+private:
+    const Program & program;   // 预解码后的程序
+    X86Emitter & as;           // 指令输出
+    int exit_label;            // 函数出口
+    int empty_label;           // 栈空报错
+    int overflow_label;        // 栈满报错
+    int index_label;           // 下标越界报错
+
+    void _lowerInstruction(int pc);
+    void _loadInt(X86_REG_ENUM reg, const Operand & operand, int pc);
+    void _loadDouble(int xmm, const Operand & operand, int pc);
+    static bool _isMemory(const Operand & operand);
+    X86Mem _address(const Operand & operand, int pc);
+    bool _staticTarget(const Operand & operand, int pc, int & target);
+    void _jumpTo(const Operand & operand, int pc);
+    void _dispatch();
+    void _branch(const Instruction & ins, int pc);
+    void _callRuntime(X86_RUNTIME_ENUM func);
+
+public:
+    vector<int> pc_labels;     // 每条指令对应的 label
+
+    X86Lowering(const Program & _program, X86Emitter & _as);
+    void lower();
+};
+
+
+#endif //LLCC_X86_LOWERING_H
@@ -0,0 +1,200 @@
+/**
+ * @file asm_generator.cc
+ * @brief 汇编生成具体实现
+ *
+ * 生成的文件包括:
+ *      llcc_program    程序本身，和 JIT 生成的函数一样
+ *      llcc_print_*    很小的运行时，用 libc 的 printf 输出
+ *      main            准备好寄存器文件和活动栈，调用 llcc_program
+ */
+
+#include "../include/asm_generator.h"
+#include "../include/x86_lowering.h"
+
+#include <cstdio>
+#include <fstream>
+
+using std::ofstream;
+
+
+/**
+ * @brief 构造函数
+ */
+AsmGenerator::AsmGenerator() = default;
+
+
+/**
+ * @brief 生成汇编
+ * @param lines 每条四元式的源代码行号，校验报错时用
+ */
+void AsmGenerator::generate(const vector<Quadruple> & _code, const vector<int> * lines) {
+    program.load(_code, lines);
+
+    GasWriter as;
+    X86Lowering lowering(program, as);
+    lowering.lower();
+
+    assembly = "    .intel_syntax noprefix\n\n";
+    assembly += "    .text\n";
+    assembly += "llcc_program:\n";
+    assembly += as.str();
+    assembly += _runtime();
+    assembly += _data(as, lowering.pc_labels);
+}
+
+
+/**
+ * @brief 把汇编写入文件
+ */
+void AsmGenerator::saveToFile(string path) {
+    ofstream out_file;
+    out_file.open(path, ofstream::out | ofstream::trunc);
+    out_file << assembly;
+    out_file.close();
+}
+
+
+/**
+ * @brief 转义成 .asciz 里的字符串
+ */
+string AsmGenerator::_escape(const string & str) {
+    string ret;
+    char buf[8];
+    for (auto ch: str) {
+        unsigned char c = (unsigned char) ch;
+        if (c == '\\' || c == '"') {
+            ret += '\\';
+            ret += ch;
+        }
+        else if (c < 32 || c >= 127) {
+            snprintf(buf, sizeof(buf), "\\%03o", c);
+            ret += buf;
+        }
+        else
+            ret += ch;
+    }
+    return ret;
+}
+
+
+/**
+ * @brief 寄存器文件 + 栈一共多少个 Value
+ */
+long long AsmGenerator::_memorySize() {
+    return program.getTSize() + program.getVSize() + program.getStackSize();
+}
+
+
+/**
+ * @brief 运行时函数和 main，调用 libc 前保持栈 16 字节对齐，运行时函数用不到 context (rdi)
+ */
+string AsmGenerator::_runtime() {
+    string ret;
+
+    ret += "\n" + GasWriter::runtimeName(X86_RUNTIME_ENUM::PRINT_INT) + ":\n";
+    ret += "    sub rsp, 8\n";
+    ret += "    lea rdi, [rip + .Lfmt_int]\n";
+    ret += "    xor eax, eax\n";
+    ret += "    call printf@PLT\n";
+    ret += "    add rsp, 8\n";
+    ret += "    ret\n";
+
+    ret += "\n" + GasWriter::runtimeName(X86_RUNTIME_ENUM::PRINT_DOUBLE) + ":\n";
+    ret += "    sub rsp, 8\n";
+    ret += "    lea rdi, [rip + .Lfmt_double]\n";
+    ret += "    mov eax, 1\n";
+    ret += "    call printf@PLT\n";
+    ret += "    add rsp, 8\n";
+    ret += "    ret\n";
+
+    ret += "\n" + GasWriter::runtimeName(X86_RUNTIME_ENUM::PRINT_STRING) + ":\n";
+    ret += "    sub rsp, 8\n";
+    ret += "    lea rdi, [rip + .Lfmt_string]\n";
+    ret += "    xor eax, eax\n";
+    ret += "    call printf@PLT\n";
+    ret += "    add rsp, 8\n";
+    ret += "    ret\n";
+
+    ret += "\n" + GasWriter::runtimeName(X86_RUNTIME_ENUM::PRINT_NEWLINE) + ":\n";
+    ret += "    sub rsp, 8\n";
+    ret += "    mov edi, 10\n";
+    ret += "    call putchar@PLT\n";
+    ret += "    add rsp, 8\n";
+    ret += "    ret\n";
+
+    ret += "\n" + GasWriter::runtimeName(X86_RUNTIME_ENUM::STACK_EMPTY) + ":\n";
+    ret += "    sub rsp, 8\n";
+    ret += "    lea rdi, [rip + .Lmsg_empty]\n";
+    ret += "    call puts@PLT\n";
+    ret += "    xor edi, edi\n";
+    ret += "    call exit@PLT\n";
+
+    ret += "\n" + GasWriter::runtimeName(X86_RUNTIME_ENUM::STACK_OVERFLOW) + ":\n";
+    ret += "    sub rsp, 8\n";
+    ret += "    lea rdi, [rip + .Lmsg_overflow]\n";
+    ret += "    call puts@PLT\n";
+    ret += "    xor edi, edi\n";
+    ret += "    call exit@PLT\n";
+
+    ret += "\n" + GasWriter::runtimeName(X86_RUNTIME_ENUM::INDEX_OUT_OF_RANGE) + ":\n";
+    ret += "    sub rsp, 8\n";
+    ret += "    lea rdi, [rip + .Lmsg_index]\n";
+    ret += "    call puts@PLT\n";
+    ret += "    xor edi, edi\n";
+    ret += "    call exit@PLT\n";
+
+    ret += "\n    .globl main\n";
+    ret += "    .type main, @function\n";
+    ret += "main:\n";
+    ret += "    sub rsp, 8\n";
+    ret += "    lea rdi, [rip + llcc_memory + " + to_string(program.getTSize() * 8) + "]\n";
+    ret += "    lea rsi, [rip + llcc_memory + " + to_string((program.getTSize() + program.getVSize()) * 8) + "]\n";
+    ret += "    lea rdx, [rip + llcc_memory + " + to_string(_memorySize() * 8) + "]\n";
+    ret += "    lea rcx, [rip + llcc_jump_table]\n";
+    ret += "    xor r8d, r8d\n";
+    ret += "    call llcc_program\n";
+    ret += "    xor eax, eax\n";
+    ret += "    add rsp, 8\n";
+    ret += "    ret\n";
+
+    return ret;
+}
+
+
+/**
+ * @brief 字符串常量，跳转表，寄存器文件和栈
+ */
+string AsmGenerator::_data(GasWriter & as, const vector<int> & pc_labels) {
+    string ret;
+
+    ret += "\n    .section .rodata\n";
+    ret += ".Lfmt_int:\n    .asciz \"%lld \"\n";
+    ret += ".Lfmt_double:\n    .asciz \"%g \"\n";
+    ret += ".Lfmt_string:\n    .asciz \"%s \"\n";
+    ret += ".Lmsg_empty:\n    .asciz \"Stacks is empty!!!\"\n";
+    ret += ".Lmsg_overflow:\n    .asciz \"Stack overflow!!!\"\n";
+    ret += ".Lmsg_index:\n    .asciz \"Index out of range!!!\"\n";
+    for (int i = 0; i < program.getStringCount(); i ++) {
+        string str(program.stringAt(i), program.stringLength(i));
+        ret += GasWriter::stringName(i) + ":\n    .asciz \"" + _escape(str) + "\"\n";
+    }
+
+    // 跳转表里是绝对地址，放在重定位后只读的段里
+    ret += "\n    .section .data.rel.ro, \"aw\"\n";
+    ret += "    .balign 8\n";
+    ret += "llcc_jump_table:\n";
+    for (auto label: pc_labels)
+        ret += "    .quad " + as.labelName(label) + "\n";
+
+    // 寄存器文件和栈必须连续，函数帧里的参数会越过栈底访问调用者压的值
+    ret += "\n    .bss\n";
+    ret += "    .balign 16\n";
+    ret += "llcc_memory:\n";
+    // 大小是 0 时 gas 会对 .zero 报警告
+    if (_memorySize() > 0)
+        ret += "    .zero " + to_string(_memorySize() * 8) + "\n";
+
+    ret += "\n    .section .note.GNU-stack, \"\", @progbits\n";
+
+    return ret;
+}
@@ -0,0 +1,261 @@
+/**
+ * @file bytecode.cc
+ * @brief 二进制字节码文件具体实现
+ */
+
+#include "../include/bytecode.h"
+#include "../include/verifier.h"
+
+#include <cstdio>
+#include <climits>
+#include <cstring>
+#include <type_traits>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+static_assert(std::is_standard_layout<Instruction>::value, "Instruction is written to .icb as is");
+static_assert(sizeof(BytecodeHeader) % 8 == 0 && sizeof(Instruction) % 8 == 0 && sizeof(Operand) % 8 == 0 &&
+              sizeof(LineEntry) % 8 == 0 && sizeof(StringEntry) % 8 == 0,
+              "sections of .icb must stay 8-byte aligned");
+
+
+/**
+ * @brief 只拷贝字段，dst 事先清零，填充字节都是 0，同一个程序写出的文件逐字节相同
+ */
+void Bytecode::_clean(Operand & dst, const Operand & src) {
+    dst.kind = src.kind;
+    dst.slot = src.slot;
+    dst.index = src.index;
+    dst.value = src.value;
+}
+
+
+/**
+ * @brief 头和文件大小对不对得上
+ */
+bool Bytecode::_checkHeader(const BytecodeHeader & header, uint64_t file_size) {
+    if (memcmp(header.magic, BYTECODE_MAGIC, 4) != 0 || header.version != BYTECODE_VERSION)
+        return false;
+    if (header.record_size != sizeof(Instruction) || header.operand_size != sizeof(Operand))
+        return false;
+    if (header.code_count == 0 || header.v_size < 0 || header.t_size < 0 || header.stack_size < 0)
+        return false;
+    // 变量的偏移 (slot * 8) 在生成的机器码里是 32 位的
+    if (header.v_size > INT_MAX / 8 || header.t_size > INT_MAX / 8)
+        return false;
+
+    uint64_t expected = sizeof(BytecodeHeader) +
+                        uint64_t(header.code_count) * sizeof(Instruction) +
+                        uint64_t(header.index_count) * sizeof(Operand) +
+                        uint64_t(header.line_count) * sizeof(LineEntry) +
+                        uint64_t(header.string_count) * sizeof(StringEntry) +
+                        header.string_bytes;
+    return expected == file_size;
+}
+
+
+/**
+ * @brief 看文件头是不是字节码
+ */
+bool Bytecode::isBytecodeFile(const string & path) {
+    FILE * f = fopen(path.c_str(), "rb");
+    if (! f)
+        return false;
+
+    char magic[4];
+    bool ret = fread(magic, 1, 4, f) == 4 && memcmp(magic, BYTECODE_MAGIC, 4) == 0;
+    fclose(f);
+    return ret;
+}
+
+
+/**
+ * @brief 保存成字节码文件
+ * @param program 加载 (校验) 过的程序
+ * @return 能不能写
+ */
+bool Bytecode::save(const Program & program, const string & path) {
+    FILE * f = fopen(path.c_str(), "wb");
+    if (! f)
+        return false;
+
+    BytecodeHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, BYTECODE_MAGIC, 4);
+    header.version = BYTECODE_VERSION;
+    header.record_size = sizeof(Instruction);
+    header.operand_size = sizeof(Operand);
+    header.code_count = program.code_size;
+    header.index_count = program.index_size;
+    header.line_count = program.line_count;
+    header.string_count = program.string_count;
+    header.v_size = program.v_size;
+    header.t_size = program.t_size;
+    header.stack_size = program.stack_size;
+
+    // 字符串重新紧挨着排一遍，映射来的程序里可能有空隙
+    vector<StringEntry> strings;
+    for (int i = 0; i < program.string_count; i ++) {
+        StringEntry item;
+        item.offset = header.string_bytes;
+        item.length = program.stringLength(i);
+        strings.emplace_back(item);
+        header.string_bytes += item.length + 1;
+    }
+
+    vector<Instruction> code(program.code_size);
+    memset(code.data(), 0, code.size() * sizeof(Instruction));
+    for (size_t i = 0; i < code.size(); i ++) {
+        code[i].op = program.code[i].op;
+        _clean(code[i].arg1, program.code[i].arg1);
+        _clean(code[i].arg2, program.code[i].arg2);
+        _clean(code[i].res, program.code[i].res);
+    }
+
+    vector<Operand> index_pool(program.index_size);
+    memset(index_pool.data(), 0, index_pool.size() * sizeof(Operand));
+    for (size_t i = 0; i < index_pool.size(); i ++)
+        _clean(index_pool[i], program.index_pool[i]);
+
+    fwrite(&header, sizeof(header), 1, f);
+    fwrite(code.data(), sizeof(Instruction), code.size(), f);
+    fwrite(index_pool.data(), sizeof(Operand), index_pool.size(), f);
+    fwrite(program.line_table, sizeof(LineEntry), program.line_count, f);
+    fwrite(strings.data(), sizeof(StringEntry), strings.size(), f);
+    for (int i = 0; i < program.string_count; i ++)
+        fwrite(program.stringAt(i), 1, program.stringLength(i) + 1, f);
+
+    bool ok = ! ferror(f);
+    return fclose(f) == 0 && ok;
+}
+
+
+/**
+ * @brief 读入字节码文件，能映射就只读映射整个文件，指令、下标操作数和字符串直接指向映射，不再解码
+ * 文件的内容默认不可信，在映射上只读地重新校验一遍，栈的大小也重新算，不用头里的
+ * @param trusted 文件是这个 llcc 自己校验后写下的 (编译缓存)，只查头和文件大小，
+ *                不再逐页读行号表、字符串和代码，冷启动只碰到执行到的页
+ * @return 文件是否完整并且通过校验
+ */
+bool Bytecode::load(const string & path, Program & program, bool trusted) {
+    program.release();
+
+    const char * data = nullptr;
+    uint64_t file_size = 0;
+    vector<char> bytes;
+#if defined(__unix__) || defined(__APPLE__)
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size >= off_t(sizeof(BytecodeHeader))) {
+        void * mapping = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping != MAP_FAILED) {
+            program.mapping = mapping;
+            program.mapping_size = st.st_size;
+            data = (const char *) mapping;
+            file_size = st.st_size;
+        }
+    }
+    close(fd);
+#endif
+
+    // 不能映射的时候整个读进来，vector 分配的内存对齐到 8 字节
+    vector<Instruction> fallback;
+    if (! data) {
+        FILE * f = fopen(path.c_str(), "rb");
+        if (! f)
+            return false;
+        fseek(f, 0, SEEK_END);
+        long size = ftell(f);
+        fseek(f, 0, SEEK_SET);
+        fallback.resize(size < 0 ? 0 : (size + sizeof(Instruction) - 1) / sizeof(Instruction));
+        bool ok = size >= 0 && fread(fallback.data(), 1, size, f) == size_t(size);
+        fclose(f);
+        if (! ok)
+            return false;
+        data = (const char *) fallback.data();
+        file_size = size;
+    }
+
+    BytecodeHeader header;
+    if (file_size < sizeof(header))
+        return _fail(program);
+    memcpy(&header, data, sizeof(header));
+    if (! _checkHeader(header, file_size))
+        return _fail(program);
+
+    const char * cursor = data + sizeof(header);
+    const Instruction * code = (const Instruction *) cursor;
+    cursor += uint64_t(header.code_count) * sizeof(Instruction);
+    const Operand * index_pool = (const Operand *) cursor;
+    cursor += uint64_t(header.index_count) * sizeof(Operand);
+    const LineEntry * lines = (const LineEntry *) cursor;
+    cursor += uint64_t(header.line_count) * sizeof(LineEntry);
+    const StringEntry * strings = (const StringEntry *) cursor;
+    cursor += uint64_t(header.string_count) * sizeof(StringEntry);
+
+    // 末尾必须是哨兵，行号表按 pc 严格递增 (查的时候二分)，字符串不能越界并且以 '\0' 结尾
+    if (! trusted) {
+        if (code[header.code_count - 1].op != INTER_CODE_OP_ENUM::HALT)
+            return _fail(program);
+        for (uint32_t i = 0; i < header.line_count; i ++)
+            if (lines[i].pc < 0 || uint32_t(lines[i].pc) >= header.code_count ||
+                (i > 0 && lines[i].pc <= lines[i - 1].pc))
+                return _fail(program);
+        for (uint32_t i = 0; i < header.string_count; i ++)
+            if (uint64_t(strings[i].offset) + strings[i].length >= header.string_bytes ||
+                cursor[strings[i].offset + strings[i].length] != '\0')
+                return _fail(program);
+    }
+
+    if (program.mapping) {
+        program.code = code;
+        program.code_size = header.code_count;
+        program.index_pool = index_pool;
+        program.index_size = header.index_count;
+        program.line_table = lines;
+        program.line_count = header.line_count;
+        program.string_table = strings;
+        program.string_count = header.string_count;
+        program.string_data = cursor;
+    }
+    else {
+        program.code_storage.assign(code, code + header.code_count);
+        program.index_storage.assign(index_pool, index_pool + header.index_count);
+        program.line_storage.assign(lines, lines + header.line_count);
+        program.string_storage.assign(strings, strings + header.string_count);
+        program.text_storage.assign(cursor, header.string_bytes);
+        program._bindStorage();
+    }
+    program.v_size = header.v_size;
+    program.t_size = header.t_size;
+
+    if (trusted) {
+        program.stack_size = header.stack_size;
+        return true;
+    }
+    try {
+        Verifier verifier(program, true);
+        program.stack_size = verifier.verify();
+    }
+    catch (Error &) {
+        return _fail(program);
+    }
+    return true;
+}
+
+
+/**
+ * @brief 读入失败，放掉已经映射的文件
+ */
+bool Bytecode::_fail(Program & program) {
+    program.release();
+    return false;
+}
@@ -0,0 +1,122 @@
+/**
+ * @file compile_cache.cc
+ * @brief 编译缓存具体实现
+ */
+
+#include "../include/compile_cache.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#include <sys/stat.h>
+#define LLCC_CACHE_SUPPORTED
+#endif
+
+// FNV-1a 64
+#define CACHE_HASH_OFFSET 14695981039346656037ULL
+#define CACHE_HASH_PRIME 1099511628211ULL
+
+
+/**
+ * @brief 构造函数，找缓存目录，建不了目录就不用缓存
+ * @param _version 编译器的构建标识 (源代码的哈希，见 build_id.cmake)
+ */
+CompileCache::CompileCache(const string & _version): version(_version) {
+#ifdef LLCC_CACHE_SUPPORTED
+    const char * env = getenv("LLCC_CACHE_DIR");
+    if (env)
+        dir = env;
+    else if ((env = getenv("XDG_CACHE_HOME")) && * env)
+        dir = string(env) + "/llcc";
+    else if ((env = getenv("HOME")) && * env)
+        dir = string(env) + "/.cache/llcc";
+
+    if (! dir.empty() && ! _makeDirs(dir))
+        dir.clear();
+#endif
+}
+
+
+/**
+ * @brief 逐级建目录，已经存在也算成功
+ */
+bool CompileCache::_makeDirs(const string & path) {
+#ifdef LLCC_CACHE_SUPPORTED
+    for (size_t i = 1; i <= path.size(); i ++) {
+        if (i < path.size() && path[i] != '/')
+            continue;
+        string prefix = path.substr(0, i);
+        if (mkdir(prefix.c_str(), 0755) != 0) {
+            struct stat st;
+            if (stat(prefix.c_str(), &st) != 0 || ! S_ISDIR(st.st_mode))
+                return false;
+        }
+    }
+    return true;
+#else
+    (void) path;
+    return false;
+#endif
+}
+
+
+bool CompileCache::enabled() const {
+    return ! dir.empty();
+}
+
+
+/**
+ * @brief 源代码对应的缓存文件路径，文件不一定存在
+ *
+ * 键是编译器的构建标识、字节码格式和源代码一起的哈希，再加上源代码的长度
+ */
+string CompileCache::entryPath(const char * source, size_t length) const {
+    uint64_t hash = CACHE_HASH_OFFSET;
+    auto feed = [&hash](const char * data, size_t size) {
+        for (size_t i = 0; i < size; i ++) {
+            hash ^= uint8_t(data[i]);
+            hash *= CACHE_HASH_PRIME;
+        }
+    };
+
+    string tag = version + "/" + BYTECODE_MAGIC + char('0' + BYTECODE_VERSION);
+    feed(tag.c_str(), tag.size() + 1);
+    feed(source, length);
+
+    char name[64];
+    snprintf(name, sizeof(name), "/%016llx-%llx.icb", (unsigned long long) hash, (unsigned long long) length);
+    return dir + name;
+}
+
+
+/**
+ * @brief 读入缓存里的程序，文件是 store 写下的，只查头和大小，不再校验
+ * @return 文件是否完整，不完整的当作没有缓存
+ */
+bool CompileCache::load(const string & entry, Program & program) const {
+    return Bytecode::load(entry, program, true);
+}
+
+
+/**
+ * @brief 把加载 (校验) 过的程序写进缓存
+ * @param entry entryPath 返回的路径
+ * @return 写没写成
+ */
+bool CompileCache::store(const Program & program, const string & entry) const {
+#ifdef LLCC_CACHE_SUPPORTED
+    // 每个进程写自己的临时文件，写完再原子地换上去
+    string temp = entry + ".tmp" + std::to_string((long long) getpid());
+    if (Bytecode::save(program, temp) && rename(temp.c_str(), entry.c_str()) == 0)
+        return true;
+
+    remove(temp.c_str());
+    return false;
+#else
+    (void) program;
+    (void) entry;
+    return false;
+#endif
+}
@@ -0,0 +1,748 @@
+/**
+ * @file execution_context.cc
+ * @brief 一次执行的状态和解释执行具体实现
+ */
+
+#include "../include/execution_context.h"
+
+#include <atomic>
+#include <mutex>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define LLCC_SIGACTION
+#endif
+
+using std::cout;
+using std::cerr;
+using std::endl;
+
+// GCC / Clang 支持 labels as values，用直接线索化分派，其他编译器退回 switch
+#if defined(__GNUC__)
+#define LLCC_THREADED_DISPATCH
+#endif
+
+// 信号处理函数里只把收到的次数加一，每个 ExecutionContext 记着自己处理到了第几次，
+// 同时执行的几个都能看到同一个信号，谁也不会替别人把请求清掉
+static std::atomic<unsigned> checkpoint_saves(0);   // SIGUSR1: 保存后继续执行
+static std::atomic<unsigned> checkpoint_stops(0);   // SIGINT / SIGTERM: 保存后停下
+static_assert(ATOMIC_INT_LOCK_FREE == 2, "checkpoint counters are updated in a signal handler");
+
+static const int CHECKPOINT_SIGNALS[] = {
+        SIGINT, SIGTERM,
+#ifdef SIGUSR1
+        SIGUSR1
+#endif
+};
+#define CHECKPOINT_SIGNAL_COUNT int(sizeof(CHECKPOINT_SIGNALS) / sizeof(CHECKPOINT_SIGNALS[0]))
+
+// 要保存检查点的执行有几个，第一个装上信号处理函数，最后一个换回原来的
+static std::mutex checkpoint_mutex;
+static int checkpoint_users = 0;
+#ifdef LLCC_SIGACTION
+static struct sigaction checkpoint_previous[CHECKPOINT_SIGNAL_COUNT];
+#else
+static void (* checkpoint_previous[CHECKPOINT_SIGNAL_COUNT])(int);
+#endif
+
+
+static void onCheckpointSignal(int sig) {
+    if (sig == SIGINT || sig == SIGTERM)
+        checkpoint_stops ++;
+    else
+        checkpoint_saves ++;
+}
+
+
+static void installCheckpointSignals() {
+    std::lock_guard<std::mutex> lock(checkpoint_mutex);
+    if (checkpoint_users ++ > 0)
+        return;
+
+    for (int i = 0; i < CHECKPOINT_SIGNAL_COUNT; i ++) {
+#ifdef LLCC_SIGACTION
+        struct sigaction action;
+        memset(&action, 0, sizeof(action));
+        action.sa_handler = onCheckpointSignal;
+        sigemptyset(&action.sa_mask);
+        action.sa_flags = SA_RESTART;
+        sigaction(CHECKPOINT_SIGNALS[i], &action, &checkpoint_previous[i]);
+#else
+        checkpoint_previous[i] = signal(CHECKPOINT_SIGNALS[i], onCheckpointSignal);
+#endif
+    }
+}
+
+
+static void restoreCheckpointSignals() {
+    std::lock_guard<std::mutex> lock(checkpoint_mutex);
+    if (-- checkpoint_users > 0)
+        return;
+
+    for (int i = 0; i < CHECKPOINT_SIGNAL_COUNT; i ++) {
+#ifdef LLCC_SIGACTION
+        sigaction(CHECKPOINT_SIGNALS[i], &checkpoint_previous[i], nullptr);
+#else
+        signal(CHECKPOINT_SIGNALS[i], checkpoint_previous[i]);
+#endif
+    }
+}
+
+
+/**
+ * @brief 构造函数
+ * @param _program 加载好的程序，执行期间不能改，可以被多个 ExecutionContext 同时使用
+ * @param _output PRINT 的输出
+ */
+ExecutionContext::ExecutionContext(const Program & _program, OutputSink & _output):
+        program(_program), output(_output) {
+    code = nullptr;
+    index = 0;
+    base = bottom = limit = fp = sp = nullptr;
+    checkpoint_steps = 0;
+    saves_seen = stops_seen = 0;
+    stopped = false;
+}
+
+
+/**
+ * @brief 执行时保存检查点
+ * @param path 检查点文件，每次覆盖
+ * @param steps 每执行这么多条指令保存一次，0 表示只在收到 SIGUSR1 / SIGINT / SIGTERM 时保存，
+ *              SIGINT / SIGTERM 保存后停下，run / resume 提前返回，见 isStopped
+ */
+void ExecutionContext::setCheckpoint(const string & path, long long steps) {
+    checkpoint_path = path;
+    checkpoint_steps = steps;
+}
+
+
+/**
+ * @brief 是不是收到 SIGINT / SIGTERM，保存了检查点后停下的，没执行完
+ */
+bool ExecutionContext::isStopped() const {
+    return stopped;
+}
+
+
+/**
+ * @brief 从 pc 0 开始执行一遍，每次都重新分配全局变量和栈
+ * @param verbose 每条指令前输出 pc 和栈
+ */
+void ExecutionContext::run(bool verbose) {
+    _reset();
+    _loop(verbose);
+}
+
+
+/**
+ * @brief 从检查点恢复，接着执行
+ * @return 检查点文件是不是这个程序的，不是的话什么都不执行
+ */
+bool ExecutionContext::resume(const string & path, bool verbose) {
+    _reset();
+    if (! _loadCheckpoint(path))
+        return false;
+
+    _loop(verbose);
+    return true;
+}
+
+
+/**
+ * @brief 回到初始状态，全局变量和栈清零
+ */
+void ExecutionContext::_reset() {
+    code = program.getCode();
+    index = 0;
+    stopped = false;
+
+    // 大小在解码时就确定了，执行时不再扩容
+    Value zero;
+    zero.i = 0;
+    memory.assign(program.getTSize() + program.getVSize() + program.getStackSize(), zero);
+    base = memory.data() + program.getTSize();
+    bottom = base + program.getVSize();
+    limit = memory.data() + memory.size();
+    fp = base;
+    sp = bottom;
+}
+
+
+void ExecutionContext::_loop(bool verbose) {
+    // 和调试信息交替输出
+    if (verbose)
+        output.setFlushPolicy(FLUSH_POLICY_ENUM::ALWAYS);
+
+    // 要数指令或者输出调试信息时一条一条执行，否则走线索化分派
+    if (verbose || ! checkpoint_path.empty())
+        _executeStepped(verbose);
+    else
+        _executeThreaded();
+
+    output.flush();
+}
+
+
+/**
+ * @brief 逐条执行，指令之间处理检查点
+ */
+void ExecutionContext::_executeStepped(bool verbose) {
+    bool checkpoint = ! checkpoint_path.empty();
+    if (checkpoint) {
+        installCheckpointSignals();
+        saves_seen = checkpoint_saves.load(std::memory_order_relaxed);
+        stops_seen = checkpoint_stops.load(std::memory_order_relaxed);
+    }
+
+    // 末尾是哨兵 HALT
+    int code_len = program.getCodeSize() - 1;
+    long long steps = 0;
+    while (index < code_len) {
+        _execute(verbose);
+        if (! checkpoint)
+            continue;
+
+        steps ++;
+        unsigned saves = checkpoint_saves.load(std::memory_order_relaxed);
+        unsigned stops = checkpoint_stops.load(std::memory_order_relaxed);
+        if (saves == saves_seen && stops == stops_seen && steps != checkpoint_steps)
+            continue;
+        steps = 0;
+        saves_seen = saves;
+
+        if (! _saveCheckpoint())
+            cerr << "cannot write checkpoint `" << checkpoint_path << "`" << endl;
+        if (stops != stops_seen) {
+            cerr << "stopped at pc " << index << ", resume with the checkpoint `" << checkpoint_path << "`" << endl;
+            stopped = true;
+            break;
+        }
+    }
+
+    if (checkpoint)
+        restoreCheckpointSignals();
+}
+
+
+/**
+ * @brief 保存检查点: 先把输出写出去，再写临时文件，写完换上去，中途被杀也不会留下半个检查点
+ */
+bool ExecutionContext::_saveCheckpoint() {
+    output.flush();
+
+    // 末尾的 0 不用存
+    int64_t used = memory.size();
+    while (used > 0 && memory[used - 1].i == 0)
+        used --;
+
+    CheckpointHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CHECKPOINT_MAGIC, 4);
+    header.version = CHECKPOINT_VERSION;
+    header.fingerprint = program.fingerprint();
+    header.memory_size = memory.size();
+    header.used = used;
+    header.index = index;
+    header.fp = fp - memory.data();
+    header.sp = sp - memory.data();
+    header.output_size = output.size();
+
+    string temp = checkpoint_path + ".tmp";
+    FILE * f = fopen(temp.c_str(), "wb");
+    if (! f)
+        return false;
+    bool ok = fwrite(&header, sizeof(header), 1, f) == 1 &&
+              fwrite(memory.data(), sizeof(Value), used, f) == size_t(used);
+    ok = fclose(f) == 0 && ok;
+
+    return ok && rename(temp.c_str(), checkpoint_path.c_str()) == 0;
+}
+
+
+/**
+ * @brief 读入检查点，输出截到检查点时的长度
+ */
+bool ExecutionContext::_loadCheckpoint(const string & path) {
+    FILE * f = fopen(path.c_str(), "rb");
+    if (! f)
+        return false;
+
+    CheckpointHeader header;
+    bool ok = fread(&header, sizeof(header), 1, f) == 1 &&
+              memcmp(header.magic, CHECKPOINT_MAGIC, 4) == 0 &&
+              header.version == CHECKPOINT_VERSION &&
+              header.fingerprint == program.fingerprint() &&
+              header.memory_size == int64_t(memory.size()) &&
+              0 <= header.used && header.used <= header.memory_size &&
+              0 <= header.index && header.index < program.getCodeSize() &&
+              0 <= header.fp && header.fp <= header.memory_size &&
+              0 <= header.sp && header.sp <= header.memory_size;
+    ok = ok && fread(memory.data(), sizeof(Value), header.used, f) == size_t(header.used);
+    fclose(f);
+    if (! ok || ! output.truncate(header.output_size))
+        return false;
+
+    index = int(header.index);
+    fp = memory.data() + header.fp;
+    sp = memory.data() + header.sp;
+    return true;
+}
+
+
+/**
+ * @brief 解释执行
+ */
+void ExecutionContext::_execute(bool verbose) {
+    int op = int(code[index].op);
+    if (verbose) {
+        cout << "processing code #" << index;
+        int line = program.lineOf(index);
+        if (line > 0)
+            cout << " (line " << line << ")";
+        cout << "  stack: ";
+        for (Value * p = sp; p > bottom; )
+            cout << (-- p) -> i << ", ";
+        cout << endl;
+    }
+
+    switch (op) {
+        case int(INTER_CODE_OP_ENUM::MOV):
+        case int(INTER_CODE_OP_ENUM::FMOV):
+        case int(INTER_CODE_OP_ENUM::ITOF):
+        case int(INTER_CODE_OP_ENUM::FTOI):
+            _assign();
+            index ++;
+            break;
+        case int(INTER_CODE_OP_ENUM::ADD):
+        case int(INTER_CODE_OP_ENUM::SUB):
+        case int(INTER_CODE_OP_ENUM::MUL):
+        case int(INTER_CODE_OP_ENUM::MOD):
+        case int(INTER_CODE_OP_ENUM::DIV):
+        case int(INTER_CODE_OP_ENUM::FADD):
+        case int(INTER_CODE_OP_ENUM::FSUB):
+        case int(INTER_CODE_OP_ENUM::FMUL):
+        case int(INTER_CODE_OP_ENUM::FDIV):
+            _calc(op);
+            index ++;
+            break;
+        case int(INTER_CODE_OP_ENUM::PRINT):
+        case int(INTER_CODE_OP_ENUM::FPRINT):
+            _print();
+            index ++;
+            break;
+        case int(INTER_CODE_OP_ENUM::J):
+        case int(INTER_CODE_OP_ENUM::JE):
+        case int(INTER_CODE_OP_ENUM::JNE):
+        case int(INTER_CODE_OP_ENUM::JL):
+        case int(INTER_CODE_OP_ENUM::JG):
+        case int(INTER_CODE_OP_ENUM::FJE):
+        case int(INTER_CODE_OP_ENUM::FJNE):
+        case int(INTER_CODE_OP_ENUM::FJL):
+        case int(INTER_CODE_OP_ENUM::FJG):
+            _jump();
+            break;
+        case int(INTER_CODE_OP_ENUM::POP):
+            _pop();
+            index ++;
+            break;
+        case int(INTER_CODE_OP_ENUM::PUSH):
+            _push();
+            index ++;
+            break;
+        case int(INTER_CODE_OP_ENUM::CALL):
+            _call();
+            break;
+        case int(INTER_CODE_OP_ENUM::RET):
+            _ret();
+            break;
+        case int(INTER_CODE_OP_ENUM::ENTER):
+            _enter();
+            index ++;
+            break;
+        case int(INTER_CODE_OP_ENUM::HALT):
+            index = program.getCodeSize() - 1;
+            break;
+        default:
+            break;
+    }
+}
+
+
+/**
+ * @brief 线索化解释执行，每个 handler 执行完直接跳到下一条指令的 handler
+ */
+void ExecutionContext::_executeThreaded() {
+#ifdef LLCC_THREADED_DISPATCH
+    // 顺序和 INTER_CODE_OP_ENUM 一致
+    static void * handlers[] = {
+            &&do_add, &&do_sub, &&do_div, &&do_mul, &&do_mod,
+            &&do_j, &&do_je, &&do_jne, &&do_jl, &&do_jg,
+            &&do_mov, &&do_print, &&do_pop, &&do_push,
+            &&do_fadd, &&do_fsub, &&do_fdiv, &&do_fmul,
+            &&do_fje, &&do_fjne, &&do_fjl, &&do_fjg,
+            &&do_mov, &&do_print, &&do_itof, &&do_ftoi,
+            &&do_call, &&do_ret, &&do_enter, &&do_halt
+    };
+    const Instruction * ins;
+
+#define DISPATCH() do { ins = &code[index]; goto * handlers[int(ins -> op)]; } while (0)
+#define NEXT() do { index ++; DISPATCH(); } while (0)
+#define BRANCH(cond) do { if (cond) { index = _jumpTarget(ins -> res); DISPATCH(); } NEXT(); } while (0)
+#define INT_ARG(x) _getValue(ins -> x).i
+#define FLOAT_ARG(x) _getValue(ins -> x).d
+
+    DISPATCH();
+
+    do_add:
+        _slot(ins -> res).i = INT_ARG(arg1) + INT_ARG(arg2);
+        NEXT();
+    do_sub:
+        _slot(ins -> res).i = INT_ARG(arg1) - INT_ARG(arg2);
+        NEXT();
+    do_mul:
+        _slot(ins -> res).i = INT_ARG(arg1) * INT_ARG(arg2);
+        NEXT();
+    do_div:
+        _slot(ins -> res).i = INT_ARG(arg1) / INT_ARG(arg2);
+        NEXT();
+    do_mod:
+        _slot(ins -> res).i = INT_ARG(arg1) % INT_ARG(arg2);
+        NEXT();
+    do_fadd:
+        _slot(ins -> res).d = FLOAT_ARG(arg1) + FLOAT_ARG(arg2);
+        NEXT();
+    do_fsub:
+        _slot(ins -> res).d = FLOAT_ARG(arg1) - FLOAT_ARG(arg2);
+        NEXT();
+    do_fmul:
+        _slot(ins -> res).d = FLOAT_ARG(arg1) * FLOAT_ARG(arg2);
+        NEXT();
+    do_fdiv:
+        _slot(ins -> res).d = FLOAT_ARG(arg1) / FLOAT_ARG(arg2);
+        NEXT();
+    do_j:
+        index = _jumpTarget(ins -> res);
+        DISPATCH();
+    do_je:
+        BRANCH(INT_ARG(arg1) == INT_ARG(arg2));
+    do_jne:
+        BRANCH(INT_ARG(arg1) != INT_ARG(arg2));
+    do_jl:
+        BRANCH(INT_ARG(arg1) < INT_ARG(arg2));
+    do_jg:
+        BRANCH(INT_ARG(arg1) > INT_ARG(arg2));
+    do_fje:
+        BRANCH(FLOAT_ARG(arg1) == FLOAT_ARG(arg2));
+    do_fjne:
+        BRANCH(FLOAT_ARG(arg1) != FLOAT_ARG(arg2));
+    do_fjl:
+        BRANCH(FLOAT_ARG(arg1) < FLOAT_ARG(arg2));
+    do_fjg:
+        BRANCH(FLOAT_ARG(arg1) > FLOAT_ARG(arg2));
+    do_mov:
+        // MOV 和 FMOV 都是按位复制，立即数在解码时已经按类型处理
+        _slot(ins -> res) = _getValue(ins -> arg1);
+        NEXT();
+    do_itof:
+        _slot(ins -> res).d = double(INT_ARG(arg1));
+        NEXT();
+    do_ftoi:
+        _slot(ins -> res).i = int64_t(FLOAT_ARG(arg1));
+        NEXT();
+    do_print:
+        _print();
+        NEXT();
+    do_pop:
+        _pop();
+        NEXT();
+    do_push:
+        _push();
+        NEXT();
+    do_call:
+        _call();
+        DISPATCH();
+    do_ret:
+        _ret();
+        DISPATCH();
+    do_enter:
+        _enter();
+        NEXT();
+    do_halt:
+        return;
+
+#undef FLOAT_ARG
+#undef INT_ARG
+#undef BRANCH
+#undef NEXT
+#undef DISPATCH
+#else
+    int code_len = program.getCodeSize() - 1;
+    while (index < code_len)
+        _execute(false);
+#endif
+}
+
+
+
+/**
+ * @brief 执行print
+ */
+void ExecutionContext::_print() {
+    const Operand & value = code[index].arg1;
+    if (value.kind == OPERAND_KIND_ENUM::NONE) {
+        output.writeNewline();
+        return;
+    }
+
+    if (value.kind == OPERAND_KIND_ENUM::STRING)
+        output.writeString(program.stringAt(value.slot), program.stringLength(value.slot));
+    else if (code[index].op == INTER_CODE_OP_ENUM::FPRINT)
+        output.writeDouble(_getValue(value).d);
+    else
+        output.writeInt(_getValue(value).i);
+    output.writeChar(' ');
+}
+
+
+/**
+ * @brief 运行时错误，先把已有的输出写出去再报错退出，知道行号时带上出错的行
+ */
+void ExecutionContext::_fatal(const char * message) {
+    output.writeString(message);
+    int line = program.lineOf(index);
+    if (line > 0) {
+        output.writeString(" On line ");
+        output.writeInt(line);
+    }
+    output.writeNewline();
+    output.flush();
+    exit(0);
+}
+
+
+/**
+ * @brief 执行运行
+ */
+void ExecutionContext::_calc(int op) {
+    Value a = _getValue(code[index].arg1);
+    Value b = _getValue(code[index].arg2);
+    Value & value = _slot(code[index].res);
+
+    switch (op) {
+        case int(INTER_CODE_OP_ENUM::ADD):
+            value.i = a.i + b.i;
+            break;
+        case int(INTER_CODE_OP_ENUM::SUB):
+            value.i = a.i - b.i;
+            break;
+        case int(INTER_CODE_OP_ENUM::MUL):
+            value.i = a.i * b.i;
+            break;
+        case int(INTER_CODE_OP_ENUM::DIV):
+            value.i = a.i / b.i;
+            break;
+        case int(INTER_CODE_OP_ENUM::MOD):
+            value.i = a.i % b.i;
+            break;
+        case int(INTER_CODE_OP_ENUM::FADD):
+            value.d = a.d + b.d;
+            break;
+        case int(INTER_CODE_OP_ENUM::FSUB):
+            value.d = a.d - b.d;
+            break;
+        case int(INTER_CODE_OP_ENUM::FMUL):
+            value.d = a.d * b.d;
+            break;
+        case int(INTER_CODE_OP_ENUM::FDIV):
+            value.d = a.d / b.d;
+            break;
+    }
+}
+
+
+/**
+ * @brief 执行赋值和类型转换
+ */
+void ExecutionContext::_assign() {
+    // 先读取右值
+    Value r_value = _getValue(code[index].arg1);
+
+    // 再写入左值
+    Value & l_value = _slot(code[index].res);
+    if (code[index].op == INTER_CODE_OP_ENUM::ITOF)
+        l_value.d = double(r_value.i);
+    else if (code[index].op == INTER_CODE_OP_ENUM::FTOI)
+        l_value.i = int64_t(r_value.d);
+    else
+        l_value = r_value;
+}
+
+
+/**
+ * @brief 解释跳转
+ */
+void ExecutionContext::_jump() {
+    INTER_CODE_OP_ENUM op = code[index].op;
+    if (op == INTER_CODE_OP_ENUM::J) {
+        index = _jumpTarget(code[index].res);
+        return;
+    }
+
+    Value a = _getValue(code[index].arg1);
+    Value b = _getValue(code[index].arg2);
+
+    if ((op == INTER_CODE_OP_ENUM::JE   && a.i == b.i) ||
+        (op == INTER_CODE_OP_ENUM::JNE  && a.i != b.i) ||
+        (op == INTER_CODE_OP_ENUM::JG   && a.i > b.i) ||
+        (op == INTER_CODE_OP_ENUM::JL   && a.i < b.i) ||
+        (op == INTER_CODE_OP_ENUM::FJE  && a.d == b.d) ||
+        (op == INTER_CODE_OP_ENUM::FJNE && a.d != b.d) ||
+        (op == INTER_CODE_OP_ENUM::FJG  && a.d > b.d) ||
+        (op == INTER_CODE_OP_ENUM::FJL  && a.d < b.d))
+        index = _jumpTarget(code[index].res);
+    else
+        index ++;
+}
+
+
+/**
+ * @brief 计算跳转目标，静态目标加载时已经校验过，存在变量里的越界目标统一落到末尾的哨兵上
+ */
+int ExecutionContext::_jumpTarget(const Operand & operand) {
+    if (operand.kind == OPERAND_KIND_ENUM::IMMEDIATE)
+        return int(operand.value.i);
+
+    int64_t ret = _getValue(operand).i;
+    int halt_index = program.getCodeSize() - 1;
+
+    return (ret < 0 || ret > halt_index) ? halt_index : int(ret);
+}
+
+
+/**
+ * @brief 或得值
+ */
+Value ExecutionContext::_getValue(const Operand & operand) {
+    Value ret;
+    switch (operand.kind) {
+        case OPERAND_KIND_ENUM::PC:
+            ret.i = index + operand.slot;
+            return ret;
+        case OPERAND_KIND_ENUM::VAR:
+            return base[operand.slot];
+        case OPERAND_KIND_ENUM::LOCAL:
+            return fp[operand.slot];
+        case OPERAND_KIND_ENUM::VAR_INDEXED:
+        case OPERAND_KIND_ENUM::LOCAL_INDEXED:
+            // 相对寻址 || 相对变址寻址
+            return _slot(operand);
+        default:
+            // 立即数，空操作数为 0
+            return operand.value;
+    }
+}
+
+
+/**
+ * @brief 操作数对应的寄存器，全局变量相对 0 号寄存器，局部变量相对帧指针
+ */
+Value & ExecutionContext::_slot(const Operand & operand) {
+    switch (operand.kind) {
+        case OPERAND_KIND_ENUM::LOCAL:
+            return fp[operand.slot];
+        case OPERAND_KIND_ENUM::LOCAL_INDEXED:
+            return _indexed(fp, operand, fp, sp);
+        case OPERAND_KIND_ENUM::VAR_INDEXED:
+            return _indexed(base, operand, memory.data(), bottom);
+        default:
+            return base[operand.slot];
+    }
+}
+
+
+/**
+ * @brief 变址寻址，下标在运行时才知道，越出所在的区域就报错
+ * 全局变量只能落在 [旧格式临时变量, 栈底)，局部变量只能落在当前栈帧 [fp, sp)，碰不到参数后面的链接字
+ */
+Value & ExecutionContext::_indexed(Value * frame, const Operand & operand, Value * low, Value * high) {
+    Value * ret = frame + operand.slot + _getValue(program.getIndexPool()[operand.index]).i;
+    if (ret < low || ret >= high)
+        _fatal("Index out of range!!!");
+
+    return * ret;
+}
+
+
+
+/**
+ * @brief 出战
+ */
+void ExecutionContext::_pop() {
+    if (sp <= bottom)
+        _fatal("Stacks is empty!!!");
+    Value v = * (-- sp);
+
+    _slot(code[index].res) = v;
+}
+
+
+/**
+ * @brief 进栈
+ */
+void ExecutionContext::_push() {
+    if (sp >= limit)
+        _fatal("Stack overflow!!!");
+    * (sp ++) = _getValue(code[index].res);
+}
+
+
+/**
+ * @brief 调用函数，参数已经在栈上了，在参数后面写入返回地址和帧指针
+ */
+void ExecutionContext::_call() {
+    if (limit - sp < FRAME_LINK_SIZE)
+        _fatal("Stack overflow!!!");
+    sp[0].i = index + 1;
+    sp[1].i = fp - memory.data();
+    fp = sp + FRAME_LINK_SIZE;
+    sp = fp;
+
+    index = _jumpTarget(code[index].res);
+}
+
+
+/**
+ * @brief 函数返回，弹出栈帧和 res 个参数
+ * 链接字要是被改坏了 (返回地址不是指令，帧指针不在调用者的栈帧里) 就报错，不跳到别处去
+ */
+void ExecutionContext::_ret() {
+    Value * frame = fp;
+    Value * caller_sp = frame - FRAME_LINK_SIZE - code[index].res.value.i;
+    if (caller_sp < bottom || caller_sp > sp)
+        _fatal("Stacks is empty!!!");
+
+    int64_t return_index = frame[-2].i;
+    int64_t caller_fp = frame[-1].i;
+    if (return_index < 0 || return_index >= program.getCodeSize() ||
+        caller_fp < base - memory.data() || caller_fp > caller_sp - memory.data())
+        _fatal("Return address is broken!!!");
+
+    sp = caller_sp;
+    index = int(return_index);
+    fp = memory.data() + caller_fp;
+}
+
+
+/**
+ * @brief 分配当前栈帧
+ */
+void ExecutionContext::_enter() {
+    int64_t size = code[index].res.value.i;
+    if (limit - fp < size)
+        _fatal("Stack overflow!!!");
+    sp = fp + size;
+}
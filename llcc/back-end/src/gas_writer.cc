@@ -0,0 +1,300 @@
+/**
+ * @file gas_writer.cc
+ * @brief GNU as 汇编输出具体实现
+ */
+
+#include "../include/gas_writer.h"
+
+
+const string GasWriter::REG_64[] = {
+    "rax", "rcx", "rdx", "rbx", "rsp", "rbp", "rsi", "rdi",
+    "r8", "r9", "r10", "r11", "r12", "r13", "r14", "r15"
+};
+
+
+const string GasWriter::REG_32[] = {
+    "eax", "ecx", "edx", "ebx", "esp", "ebp", "esi", "edi",
+    "r8d", "r9d", "r10d", "r11d", "r12d", "r13d", "r14d", "r15d"
+};
+
+
+// 按 X86_COND_ENUM 的值索引
+const string GasWriter::COND[] = {
+    "o", "no", "b", "ae", "e", "ne", "be", "a",
+    "s", "ns", "p", "np", "l", "ge", "le", "g"
+};
+
+
+/**
+ * @brief 构造函数
+ */
+GasWriter::GasWriter() {
+    label_count = 0;
+}
+
+
+string GasWriter::_reg64(X86_REG_ENUM reg) {
+    return REG_64[int(reg)];
+}
+
+
+string GasWriter::_reg32(X86_REG_ENUM reg) {
+    return REG_32[int(reg)];
+}
+
+
+string GasWriter::_xmm(int xmm) {
+    return "xmm" + to_string(xmm);
+}
+
+
+/**
+ * @brief 内存操作数，都是 8 字节
+ */
+string GasWriter::_mem(const X86Mem & mem) {
+    string ret = "qword ptr [" + _reg64(mem.base);
+    if (mem.index != X86_REG_ENUM::NONE)
+        ret += " + " + _reg64(mem.index) + "*" + to_string(mem.scale);
+    if (mem.disp > 0)
+        ret += " + " + to_string(mem.disp);
+    else if (mem.disp < 0)
+        ret += " - " + to_string(- (long long) mem.disp);
+    return ret + "]";
+}
+
+
+void GasWriter::_line(const string & ins) {
+    out << "    " << ins << "\n";
+}
+
+
+/**
+ * @brief label 在汇编里的名字，.L 开头的不会进符号表
+ */
+string GasWriter::labelName(int label) {
+    return ".L" + to_string(label);
+}
+
+
+/**
+ * @brief 运行时函数在汇编里的名字
+ */
+string GasWriter::runtimeName(X86_RUNTIME_ENUM func) {
+    switch (func) {
+        case X86_RUNTIME_ENUM::PRINT_INT:
+            return "llcc_print_int";
+        case X86_RUNTIME_ENUM::PRINT_DOUBLE:
+            return "llcc_print_double";
+        case X86_RUNTIME_ENUM::PRINT_STRING:
+            return "llcc_print_string";
+        case X86_RUNTIME_ENUM::PRINT_NEWLINE:
+            return "llcc_print_newline";
+        case X86_RUNTIME_ENUM::STACK_EMPTY:
+            return "llcc_stack_empty";
+        case X86_RUNTIME_ENUM::STACK_OVERFLOW:
+            return "llcc_stack_overflow";
+        default:
+            return "llcc_index_out_of_range";
+    }
+}
+
+
+/**
+ * @brief 字符串常量在汇编里的名字
+ */
+string GasWriter::stringName(int string_index) {
+    return ".Lstr" + to_string(string_index);
+}
+
+
+/**
+ * @brief 到目前为止生成的汇编
+ */
+string GasWriter::str() {
+    return out.str();
+}
+
+
+int GasWriter::newLabel() {
+    return label_count ++;
+}
+
+
+void GasWriter::bind(int label) {
+    out << labelName(label) << ":\n";
+}
+
+
+void GasWriter::push(X86_REG_ENUM reg) {
+    _line("push " + _reg64(reg));
+}
+
+
+void GasWriter::pop(X86_REG_ENUM reg) {
+    _line("pop " + _reg64(reg));
+}
+
+
+void GasWriter::ret() {
+    _line("ret");
+}
+
+
+void GasWriter::movImm64(X86_REG_ENUM dst, uint64_t imm) {
+    _line("movabs " + _reg64(dst) + ", " + to_string(imm));
+}
+
+
+void GasWriter::movImm32(X86_REG_ENUM dst, int32_t imm) {
+    _line("mov " + _reg32(dst) + ", " + to_string(imm));
+}
+
+
+void GasWriter::mov64(X86_REG_ENUM dst, X86_REG_ENUM src) {
+    _line("mov " + _reg64(dst) + ", " + _reg64(src));
+}
+
+
+void GasWriter::lea(X86_REG_ENUM dst, const X86Mem & mem) {
+    _line("lea " + _reg64(dst) + ", " + _mem(mem));
+}
+
+
+void GasWriter::movLoad(X86_REG_ENUM dst, const X86Mem & mem) {
+    _line("mov " + _reg64(dst) + ", " + _mem(mem));
+}
+
+
+void GasWriter::movStore(const X86Mem & mem, X86_REG_ENUM src) {
+    _line("mov " + _mem(mem) + ", " + _reg64(src));
+}
+
+
+void GasWriter::add64(X86_REG_ENUM dst, X86_REG_ENUM src) {
+    _line("add " + _reg64(dst) + ", " + _reg64(src));
+}
+
+
+void GasWriter::sub64(X86_REG_ENUM dst, X86_REG_ENUM src) {
+    _line("sub " + _reg64(dst) + ", " + _reg64(src));
+}
+
+
+void GasWriter::imul64(X86_REG_ENUM dst, X86_REG_ENUM src) {
+    _line("imul " + _reg64(dst) + ", " + _reg64(src));
+}
+
+
+void GasWriter::cqo() {
+    _line("cqo");
+}
+
+
+void GasWriter::idiv64(X86_REG_ENUM src) {
+    _line("idiv " + _reg64(src));
+}
+
+
+void GasWriter::addImm64(X86_REG_ENUM dst, int32_t imm) {
+    _line("add " + _reg64(dst) + ", " + to_string(imm));
+}
+
+
+void GasWriter::subImm64(X86_REG_ENUM dst, int32_t imm) {
+    _line("sub " + _reg64(dst) + ", " + to_string(imm));
+}
+
+
+void GasWriter::cmp64(X86_REG_ENUM a, X86_REG_ENUM b) {
+    _line("cmp " + _reg64(a) + ", " + _reg64(b));
+}
+
+
+void GasWriter::cmpImm64(X86_REG_ENUM a, int32_t imm) {
+    _line("cmp " + _reg64(a) + ", " + to_string(imm));
+}
+
+
+void GasWriter::movsdLoad(int xmm, const X86Mem & mem) {
+    _line("movsd " + _xmm(xmm) + ", " + _mem(mem));
+}
+
+
+void GasWriter::movsdStore(const X86Mem & mem, int xmm) {
+    _line("movsd " + _mem(mem) + ", " + _xmm(xmm));
+}
+
+
+void GasWriter::movqToXmm(int xmm, X86_REG_ENUM src) {
+    _line("movq " + _xmm(xmm) + ", " + _reg64(src));
+}
+
+
+void GasWriter::cvttsd2si64(X86_REG_ENUM dst, int xmm) {
+    _line("cvttsd2si " + _reg64(dst) + ", " + _xmm(xmm));
+}
+
+
+void GasWriter::cvtsi2sd64(int xmm, X86_REG_ENUM src) {
+    _line("cvtsi2sd " + _xmm(xmm) + ", " + _reg64(src));
+}
+
+
+void GasWriter::addsd(int dst, int src) {
+    _line("addsd " + _xmm(dst) + ", " + _xmm(src));
+}
+
+
+void GasWriter::subsd(int dst, int src) {
+    _line("subsd " + _xmm(dst) + ", " + _xmm(src));
+}
+
+
+void GasWriter::mulsd(int dst, int src) {
+    _line("mulsd " + _xmm(dst) + ", " + _xmm(src));
+}
+
+
+void GasWriter::divsd(int dst, int src) {
+    _line("divsd " + _xmm(dst) + ", " + _xmm(src));
+}
+
+
+void GasWriter::ucomisd(int a, int b) {
+    _line("ucomisd " + _xmm(a) + ", " + _xmm(b));
+}
+
+
+void GasWriter::jmp(int label) {
+    _line("jmp " + labelName(label));
+}
+
+
+void GasWriter::jcc(X86_COND_ENUM cond, int label) {
+    _line("j" + COND[int(cond)] + " " + labelName(label));
+}
+
+
+void GasWriter::jmpMem(const X86Mem & mem) {
+    _line("jmp " + _mem(mem));
+}
+
+
+void GasWriter::jmpReg(X86_REG_ENUM reg) {
+    _line("jmp " + _reg64(reg));
+}
+
+
+void GasWriter::callReg(X86_REG_ENUM reg) {
+    _line("call " + _reg64(reg));
+}
+
+
+void GasWriter::callRuntime(X86_RUNTIME_ENUM func) {
+    _line("call " + runtimeName(func));
+}
+
+
+void GasWriter::loadStringAddress(X86_REG_ENUM dst, int string_index) {
+    _line("lea " + _reg64(dst) + ", [rip + " + stringName(string_index) + "]");
+}
@@ -4,268 +4,93 @@
  */
 
 #include "../include/interpreter.h"
-#define INCREMENT 100
 
-Interpreter::Interpreter() = default;
-
-
-/**
- * @brief 解释执行
- */
-void Interpreter::execute(vector<Quadruple> _code, bool verbose) {
-    code = move(_code);
-    index = 0;
-    while (not activity.empty())
-        activity.pop();
-
-    // 初始大小 之后动态变换
-    t_size = 20;
-    t_stack.resize(t_size);
-    v_size = 100;
-    v_stack.resize(v_size);
-
-    int code_len = code.size();
-    while (index < code_len)
-        _execute(verbose);
+Interpreter::Interpreter() {
+    checkpoint_steps = 0;
 }
 
 
 /**
- * @brief 解释执行
+ * @brief 输出写到文件里而不是 stdout
+ * @param append 接在原有内容后面，从检查点恢复时用
+ * @return 能不能打开
  */
-void Interpreter::_execute(bool verbose) {
-    int op = int(code[index].op);
-    if (verbose) {
-        cout << "processing code #" << index << "t1= "  << t_stack[1] << "  stack: ";
-        stack<double> ns = activity;
-        while (not ns.empty()) {
-            cout << ns.top() << ", ";
-            ns.pop();
-        }
-        cout << endl;
-    }
-
-    switch (op) {
-        case int(INTER_CODE_OP_ENUM::MOV):
-            _assign();
-            index ++;
-            break;
-        case int(INTER_CODE_OP_ENUM::ADD):
-        case int(INTER_CODE_OP_ENUM::SUB):
-        case int(INTER_CODE_OP_ENUM::MUL):
-        case int(INTER_CODE_OP_ENUM::MOD):
-        case int(INTER_CODE_OP_ENUM::DIV):
-            _calc(op);
-            index ++;
-            break;
-        case int(INTER_CODE_OP_ENUM::PRINT):
-            _print();
-            index ++;
-            break;
-        case int(INTER_CODE_OP_ENUM::J):
-        case int(INTER_CODE_OP_ENUM::JE):
-        case int(INTER_CODE_OP_ENUM::JNE):
-        case int(INTER_CODE_OP_ENUM::JL):
-        case int(INTER_CODE_OP_ENUM::JG):
-            _jump();
-            break;
-        case int(INTER_CODE_OP_ENUM::POP):
-            _pop();
-            index ++;
-            break;
-        case int(INTER_CODE_OP_ENUM::PUSH):
-            _push();
-            index ++;
-            break;
-        default:
-            break;
-    }
+bool Interpreter::setOutputFile(const string & path, bool append) {
+    return output.open(path, append);
 }
 
 
-
 /**
- * @brief 执行print
+ * @brief 执行时保存检查点，见 ExecutionContext::setCheckpoint
  */
-void Interpreter::_print() {
-    string value_str = code[index].arg1;
-    if (value_str == "")
-        cout << endl;
-    else if (value_str[0] == '\"' || value_str[0] == '\'')
-        cout << value_str.substr(1, value_str.size() - 2) << " ";
-    else
-        cout << _getValue(value_str) << " ";
-}
-
-
-/**
- * @brief 执行运行
- */
-void Interpreter::_calc(int op) {
-    int a = _getValue(code[index].arg1);
-    int b = _getValue(code[index].arg2);
-    int value;
-
-    switch (op) {
-        case int(INTER_CODE_OP_ENUM::ADD):
-            value = a + b;
-            break;
-        case int(INTER_CODE_OP_ENUM::SUB):
-            value = a - b;
-            break;
-        case int(INTER_CODE_OP_ENUM::MUL):
-            value = a * b;
-            break;
-        case int(INTER_CODE_OP_ENUM::DIV):
-            value = a / b;
-            break;
-        case int(INTER_CODE_OP_ENUM::MOD):
-            value = int(a) % int(b);
-            break;
-    }
-
-    string res = code[index].res;
-    int temp_index = _getAddress(res);
-    // 读取res
-    if (res[0] == 'v')
-        v_stack[temp_index] = value;
-    else
-        t_stack[temp_index] = value;
+void Interpreter::setCheckpoint(const string & path, long long steps) {
+    checkpoint_path = path;
+    checkpoint_steps = steps;
 }
 
 
 /**
- * @brief 执行赋值
+ * @brief 不从头执行，从检查点恢复
  */
-void Interpreter::_assign() {
-    string res = code[index].res;
-
-    // 先读取右值
-    double r_value = _getValue(code[index].arg1);
-
-    int temp_index = _getAddress(res);
-
-    // 再读取左值
-    if (res[0] == 'v')
-        v_stack[temp_index] = r_value;
-    else
-        t_stack[temp_index] = r_value;
+void Interpreter::setResume(const string & path) {
+    resume_path = path;
 }
 
 
 /**
- * @brief 解释跳转
+ * @brief 解释执行
+ * @param lines 每条四元式的源代码行号，报错时用
  */
-void Interpreter::_jump() {
-    INTER_CODE_OP_ENUM op = code[index].op;
-    if (op == INTER_CODE_OP_ENUM::J) {
-        index = int(_getValue(code[index].res));
-        return;
-    }
-
-    double a = _getValue(code[index].arg1);
-    double b = _getValue(code[index].arg2);
-
-    if ((op == INTER_CODE_OP_ENUM::JE  && a == b) ||
-        (op == INTER_CODE_OP_ENUM::JNE && a != b) ||
-        (op == INTER_CODE_OP_ENUM::JG  && a > b) ||
-        (op == INTER_CODE_OP_ENUM::JL  && a < b))
-        index = int(_getValue(code[index].res));
-    else
-        index ++;
+void Interpreter::execute(const vector<Quadruple> & _code, bool verbose, const vector<int> * lines) {
+    program.load(_code, lines);
+    _run(program, verbose);
 }
 
 
 /**
- * @brief 获得地址
+ * @brief 边读中间代码文件边解码，再解释执行
  */
-int Interpreter::_getAddress(string value_str) {
-    if (value_str[0] == 'v') {
-        int len = value_str.size();
-        for (int i = 0; i < len; i ++) {
-            if (value_str[i] == '[') {
-                // 相对寻址
-                int offset = _getValue(value_str.substr(i + 1, len - i - 2));
-                int base = _getValue(value_str.substr(1, i - 1));
-                return offset + base;
-            }
-        }
-
-        int ret = string2int(value_str.substr(1));
-        if (ret >= v_size) {
-            v_size += INCREMENT;
-            v_stack.resize(v_size);
-        }
-
-        return ret;
-    }
-    else {
-        int ret = string2int(value_str.substr(1));
-        if (ret >= t_size) {
-            t_size += INCREMENT;
-            t_stack.resize(t_size);
-        }
-
-        return ret;
-    }
+void Interpreter::execute(InterCodeReader & reader, bool verbose) {
+    program.load(reader);
+    _run(program, verbose);
 }
 
 
 /**
- * @brief 或得值
+ * @brief 解释执行别人加载好的程序，不拷贝
  */
-double Interpreter::_getValue(string value_str) {
-    if (value_str[0] == 'p') {
-        return index + string2int(value_str.substr(3));
-    }
-    // 寻址
-    if (value_str[0] == 'v') {
-        int len = value_str.size();
-        for (int i = 0; i < len; i ++)
-            if (value_str[i] == '[') {
-                // 相对寻址 || 相对变址寻址
-                int offset = _getValue(value_str.substr(i + 1, len - i - 2));
-                int base = _getValue(value_str.substr(1, i - 1));
-                return v_stack[offset + base];
-            }
-
-        // 立即数寻址
-        int temp_index = string2int(value_str.substr(1));
-        return v_stack[temp_index];
-    }
-    // 临时变量
-    if (value_str[0] == 't') {
-        int temp_index = string2int(value_str.substr(1));
-        return t_stack[temp_index];
-    }
-    // 立即数
-    else
-        return string2double(value_str);
+void Interpreter::execute(const Program & _program, bool verbose) {
+    _run(_program, verbose);
 }
 
 
-
 /**
- * @brief 出战
+ * @brief 解释执行字节码文件
+ * @return 文件是否完整，不完整时什么都不执行
  */
-void Interpreter::_pop() {
-    string res = code[index].res;
-    if (activity.empty()) {cout << "Stacks is empty!!!\n"; exit(0);}
-    double v = activity.top();
-    activity.pop();
+bool Interpreter::executeBytecode(const string & path, bool verbose) {
+    if (! Bytecode::load(path, program))
+        return false;
 
-    int temp_index = _getAddress(res);
-    if (res[0] == 'v')
-        v_stack[temp_index] = v;
-    else
-        t_stack[temp_index] = v;
+    _run(program, verbose);
+    return true;
 }
 
 
 /**
- * @brief 进栈
+ * @brief 用自己的上下文执行已经加载好的程序
  */
-void Interpreter::_push() {
-    double v = _getValue(code[index].res);
-    activity.push(v);
+void Interpreter::_run(const Program & _program, bool verbose) {
+    ExecutionContext context(_program, output);
+    if (! checkpoint_path.empty())
+        context.setCheckpoint(checkpoint_path, checkpoint_steps);
+
+    if (resume_path.empty())
+        context.run(verbose);
+    else if (! context.resume(resume_path, verbose)) {
+        cout << "File error" << endl;
+        cout << "cannot resume from `" << resume_path << "`: not a checkpoint of this program, "
+             << "or the output has been cut short" << endl;
+        exit(0);
+    }
 }
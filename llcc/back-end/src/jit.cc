@@ -0,0 +1,207 @@
+/**
+ * @file jit.cc
+ * @brief JIT 具体实现，翻译见 x86_lowering.cc
+ */
+
+#include "../include/jit.h"
+
+#include <cstring>
+#include <iostream>
+
+#ifdef LLCC_JIT_SUPPORTED
+#include <sys/mman.h>
+#endif
+
+using std::cout;
+using std::endl;
+
+// 生成的函数，context 是这次执行的输出，原样作为第一个参数传给下面的运行时函数
+typedef void (* JitEntry)(Value * base, Value * stack, Value * stack_limit, void ** jump_table,
+                          OutputSink * output);
+
+
+/**
+ * @brief 运行时: 输出一个整数
+ */
+static void jitPrintInt(OutputSink * output, int64_t value) {
+    output -> writeInt(value);
+    output -> writeChar(' ');
+}
+
+
+/**
+ * @brief 运行时: 输出一个浮点数
+ */
+static void jitPrintDouble(OutputSink * output, double value) {
+    output -> writeDouble(value);
+    output -> writeChar(' ');
+}
+
+
+/**
+ * @brief 运行时: 输出字符串常量
+ */
+static void jitPrintString(OutputSink * output, const char * str) {
+    output -> writeString(str);
+    output -> writeChar(' ');
+}
+
+
+/**
+ * @brief 运行时: 换行
+ */
+static void jitPrintNewline(OutputSink * output) {
+    output -> writeNewline();
+}
+
+
+/**
+ * @brief 先把已有的输出写出去再报错退出
+ */
+static void jitFatal(OutputSink * output, const char * message) {
+    output -> writeString(message);
+    output -> writeNewline();
+    output -> flush();
+    exit(0);
+}
+
+
+/**
+ * @brief 运行时: 栈空
+ */
+static void jitStackEmpty(OutputSink * output) {
+    jitFatal(output, "Stacks is empty!!!");
+}
+
+
+/**
+ * @brief 运行时: 栈满
+ */
+static void jitStackOverflow(OutputSink * output) {
+    jitFatal(output, "Stack overflow!!!");
+}
+
+
+/**
+ * @brief 运行时: 下标越界
+ */
+static void jitIndexOutOfRange(OutputSink * output) {
+    jitFatal(output, "Index out of range!!!");
+}
+
+
+/**
+ * @brief JIT 构造函数
+ */
+Jit::Jit() = default;
+
+
+/**
+ * @brief 输出写到文件里而不是 stdout
+ * @return 能不能打开
+ */
+bool Jit::setOutputFile(const string & path) {
+    return output.open(path);
+}
+
+
+/**
+ * @brief 当前平台是否支持 JIT
+ */
+bool Jit::isSupported() {
+#ifdef LLCC_JIT_SUPPORTED
+    return true;
+#else
+    return false;
+#endif
+}
+
+
+/**
+ * @brief 编译成机器码并执行
+ * @param lines 每条四元式的源代码行号，校验报错时用
+ */
+void Jit::execute(const vector<Quadruple> & _code, const vector<int> * lines) {
+    program.load(_code, lines);
+    _run(program);
+}
+
+
+/**
+ * @brief 编译别人加载好的程序并执行，不拷贝
+ */
+void Jit::execute(const Program & _program) {
+    _run(_program);
+}
+
+
+/**
+ * @brief 编译字节码文件并执行
+ * @return 文件是否完整，不完整时什么都不执行
+ */
+bool Jit::executeBytecode(const string & path) {
+    if (! Bytecode::load(path, program))
+        return false;
+
+    _run(program);
+    return true;
+}
+
+
+/**
+ * @brief 把已经加载好的程序编译成机器码并执行
+ */
+void Jit::_run(const Program & _program) {
+#ifdef LLCC_JIT_SUPPORTED
+    as = X86Assembler();
+    as.setRuntime(X86_RUNTIME_ENUM::PRINT_INT, (void *) jitPrintInt);
+    as.setRuntime(X86_RUNTIME_ENUM::PRINT_DOUBLE, (void *) jitPrintDouble);
+    as.setRuntime(X86_RUNTIME_ENUM::PRINT_STRING, (void *) jitPrintString);
+    as.setRuntime(X86_RUNTIME_ENUM::PRINT_NEWLINE, (void *) jitPrintNewline);
+    as.setRuntime(X86_RUNTIME_ENUM::STACK_EMPTY, (void *) jitStackEmpty);
+    as.setRuntime(X86_RUNTIME_ENUM::STACK_OVERFLOW, (void *) jitStackOverflow);
+    as.setRuntime(X86_RUNTIME_ENUM::INDEX_OUT_OF_RANGE, (void *) jitIndexOutOfRange);
+    // 字符串就在程序里 (可能是映射的文件)，生成的代码直接用它们的地址
+    vector<const char *> strings;
+    for (int i = 0; i < _program.getStringCount(); i ++)
+        strings.emplace_back(_program.stringAt(i));
+    as.setStringPool(&strings);
+
+    X86Lowering lowering(_program, as);
+    lowering.lower();
+    const vector<uint8_t> & machine_code = as.finish();
+
+    // 先写后改成可执行，不同时可写可执行
+    size_t size = machine_code.size();
+    void * mem = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mem == MAP_FAILED) {
+        cout << "JIT error: cannot allocate executable memory" << endl;
+        exit(0);
+    }
+    memcpy(mem, machine_code.data(), size);
+    if (mprotect(mem, size, PROT_READ | PROT_EXEC) != 0) {
+        munmap(mem, size);
+        cout << "JIT error: cannot make the generated code executable" << endl;
+        exit(0);
+    }
+
+    int code_len = _program.getCodeSize();
+    jump_table.resize(code_len);
+    for (int i = 0; i < code_len; i ++)
+        jump_table[i] = (uint8_t *) mem + as.labelPosition(lowering.pc_labels[i]);
+
+    Value zero;
+    zero.i = 0;
+    memory.assign(_program.getTSize() + _program.getVSize() + _program.getStackSize(), zero);
+    Value * base = memory.data() + _program.getTSize();
+
+    JitEntry entry = reinterpret_cast<JitEntry>(mem);
+    entry(base, base + _program.getVSize(), memory.data() + memory.size(), jump_table.data(), &output);
+    output.flush();
+
+    munmap(mem, size);
+#else
+    cout << "JIT error: not supported on this platform" << endl;
+    exit(0);
+#endif
+}
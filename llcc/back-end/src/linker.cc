@@ -0,0 +1,320 @@
+/**
+ * @file linker.cc
+ * @brief 链接器具体实现
+ */
+
+#include "../include/linker.h"
+
+#include <cctype>
+#include <algorithm>
+
+
+Linker::Linker() {
+    code_size = 0;
+}
+
+
+/**
+ * @brief 按逗号切开一条记录，空字段也保留
+ */
+vector<string> Linker::_split(const string & record) {
+    vector<string> ret;
+    size_t start = 0;
+    while (true) {
+        size_t comma = record.find(',', start);
+        if (comma == string::npos) {
+            ret.emplace_back(record.substr(start));
+            return ret;
+        }
+        ret.emplace_back(record.substr(start, comma - start));
+        start = comma + 1;
+    }
+}
+
+
+/**
+ * @brief 记录里的非负整数，不是就说明文件坏了
+ */
+int Linker::_number(const string & field, const LinkUnit & unit) {
+    if (field.empty() || field.size() > 9)
+        throw Error("`" + unit.path + "` is broken: bad number `" + field + "`");
+    for (char ch: field)
+        if (! isdigit(ch))
+            throw Error("`" + unit.path + "` is broken: bad number `" + field + "`");
+    return string2int(field);
+}
+
+
+/**
+ * @brief 读入一个目标文件
+ */
+void Linker::addObject(const string & path) {
+    InterCodeReader reader;
+    if (! reader.open(path))
+        throw Error("no file named `" + path + "`");
+
+    LinkUnit unit;
+    unit.path = path;
+    unit.global_end = -1;
+    unit.has_main = false;
+    unit.global_base = unit.func_base = unit.data_base = 0;
+
+    Quadruple q(INTER_CODE_OP_ENUM::HALT, "", "", "");
+    while (reader.next(q))
+        unit.code.emplace_back(q);
+    _readRecords(reader, unit);
+
+    int l = unit.code.size();
+    if (l == 0 || unit.code[0].op != INTER_CODE_OP_ENUM::ENTER || unit.global_end < 1 || unit.global_end > l)
+        throw Error("`" + path + "` is broken: bad layout");
+    unit.frame_size = _number(Quadruple::text(unit.code[0].res), unit);
+
+    for (int pc: unit.code_relocs)
+        if (pc >= l)
+            throw Error("`" + path + "` is broken: relocation out of range");
+    for (auto & call: unit.calls)
+        if (call.pc >= l || unit.code[call.pc].op != INTER_CODE_OP_ENUM::CALL)
+            throw Error("`" + path + "` is broken: relocation out of range");
+
+    units.emplace_back(std::move(unit));
+}
+
+
+/**
+ * @brief 读四元式后面的记录: 行号表，符号表，重定位表
+ */
+void Linker::_readRecords(InterCodeReader & reader, LinkUnit & unit) {
+    int l = unit.code.size();
+    unit.lines.assign(l, 0);
+
+    bool is_object = false;
+    int line_pc = 0, line = 0;
+    string record;
+    while (reader.nextRecord(record)) {
+        vector<string> fields = _split(record);
+        const string & kind = fields[0];
+
+        if (kind == "OBJECT" && fields.size() == 2) {
+            if (_number(fields[1], unit) != INTER_CODE_OBJECT_VERSION)
+                throw Error("`" + unit.path + "` is an object of another llcc version, compile it again");
+            is_object = true;
+        }
+        else if (kind == "LINE" && fields.size() == 3) {
+            // 行号表只在行号变化的地方记，上一项一直管到这一项之前
+            int pc = std::min(_number(fields[1], unit), l);
+            for (int i = line_pc; i < pc; i ++)
+                unit.lines[i] = line;
+            line_pc = std::max(line_pc, pc);
+            line = _number(fields[2], unit);
+        }
+        else if (kind == "UNIT" && fields.size() == 3) {
+            unit.global_end = _number(fields[1], unit);
+            unit.has_main = fields[2] == "1";
+        }
+        else if (kind == "FUNC" && fields.size() == 4) {
+            unit.funcs[fields[1]] = _number(fields[2], unit);
+            unit.param_types[fields[1]] = fields[3];
+        }
+        else if (kind == "DATA" && fields.size() == 6) {
+            LinkData item;
+            item.name = fields[1];
+            item.slot = _number(fields[2], unit);
+            item.size = _number(fields[3], unit);
+            item.type = fields[4];
+            item.initialized = fields[5] == "1";
+            unit.data.emplace_back(item);
+        }
+        else if (kind == "RELOC" && fields.size() == 3 && fields[2] == "CODE")
+            unit.code_relocs.emplace_back(_number(fields[1], unit));
+        else if (kind == "RELOC" && fields.size() == 5 && fields[2] == "CALL") {
+            LinkCall call;
+            call.pc = _number(fields[1], unit);
+            call.name = fields[3];
+            call.arg_types = fields[4];
+            unit.calls.emplace_back(call);
+        }
+        else
+            throw Error("`" + unit.path + "` is broken: unknown record `" + record + "`");
+    }
+
+    for (int i = line_pc; i < l; i ++)
+        unit.lines[i] = line;
+
+    if (! is_object)
+        throw Error("`" + unit.path + "` is not a relocatable object, compile it with -a -m");
+}
+
+
+/**
+ * @brief 排布代码和数据，合并同名的全局变量
+ */
+void Linker::_layout() {
+    int main_unit = -1;
+    int l = units.size();
+    for (int i = 0; i < l; i ++)
+        if (units[i].has_main) {
+            if (main_unit >= 0)
+                throw Error("multiple definition of `main` in `" + units[main_unit].path + "` and `" +
+                            units[i].path + "`");
+            main_unit = i;
+        }
+    if (main_unit < 0)
+        throw Error("function `main` is not defined");
+
+    // 有 main 的文件的全局代码放最后，其他文件的全局变量先初始化
+    code_size = 1;
+    for (int i = 0; i < l; i ++)
+        if (i != main_unit) {
+            units[i].global_base = code_size;
+            code_size += units[i].global_end - 1;
+        }
+    units[main_unit].global_base = code_size;
+    code_size += units[main_unit].global_end - 1;
+    for (auto & unit: units) {
+        unit.func_base = code_size;
+        code_size += int(unit.code.size()) - unit.global_end;
+    }
+
+    // 全局变量符号
+    map<string, string> defined_in, initialized_in;
+    int data_size = 0;
+    for (auto & unit: units)
+        for (auto & item: unit.data) {
+            auto it = data.find(item.name);
+            if (it == data.end()) {
+                LinkData shared = item;
+                shared.slot = data_size;
+                data_size += item.size;
+                data[item.name] = shared;
+                defined_in[item.name] = unit.path;
+            }
+            else if (it -> second.type != item.type || it -> second.size != item.size)
+                throw Error("global `" + item.name + "` is declared differently in `" + defined_in[item.name] +
+                            "` and `" + unit.path + "`");
+
+            if (item.initialized) {
+                if (initialized_in.count(item.name))
+                    throw Error("multiple definition of `" + item.name + "` in `" + initialized_in[item.name] +
+                                "` and `" + unit.path + "`");
+                initialized_in[item.name] = unit.path;
+            }
+        }
+
+    // 各文件自己的数据区
+    for (auto & unit: units) {
+        unit.data_base = data_size;
+        data_size += unit.frame_size;
+    }
+
+    // 函数不能重复定义
+    map<string, string> func_in;
+    for (auto & unit: units)
+        for (auto & it: unit.funcs) {
+            if (func_in.count(it.first))
+                throw Error("multiple definition of `" + it.first + "` in `" + func_in[it.first] + "` and `" +
+                            unit.path + "`");
+            func_in[it.first] = unit.path;
+        }
+}
+
+
+/**
+ * @brief 目标文件里的 pc 在链接后的位置，跳到结尾的都落到哨兵上
+ */
+int Linker::_codeAddress(const LinkUnit & unit, int pc) {
+    if (pc < unit.global_end)
+        return unit.global_base + pc - 1;
+    if (pc < int(unit.code.size()))
+        return unit.func_base + pc - unit.global_end;
+    return code_size;
+}
+
+
+/**
+ * @brief 目标文件数据区的位置在链接后的位置
+ */
+int Linker::_dataSlot(const LinkUnit & unit, int slot) {
+    for (auto & item: unit.data)
+        if (item.slot <= slot && slot < item.slot + item.size)
+            return data[item.name].slot + slot - item.slot;
+    return unit.data_base + slot;
+}
+
+
+/**
+ * @brief 改写操作数里的全局变量，包括下标里的: v3[v5] -> v10[v12]
+ */
+string Linker::_relocateData(const LinkUnit & unit, const string & text) {
+    if (text.empty() || (text[0] != 'v' && text[0] != 'l'))
+        return text;
+
+    size_t bracket = text.find('[');
+    string index;
+    if (bracket != string::npos)
+        index = "[" + _relocateData(unit, text.substr(bracket + 1, text.size() - bracket - 2)) + "]";
+    else
+        bracket = text.size();
+
+    if (text[0] == 'l')
+        return text.substr(0, bracket) + index;
+    return "v" + int2string(_dataSlot(unit, string2int(text.substr(1, bracket - 1)))) + index;
+}
+
+
+/**
+ * @brief 找到被调用的函数，核对实参和形参的类型
+ * @return 链接后函数的 ENTER 的位置
+ */
+int Linker::_resolve(const LinkUnit & unit, const LinkCall & call) {
+    for (auto & callee: units) {
+        auto it = callee.funcs.find(call.name);
+        if (it == callee.funcs.end())
+            continue;
+
+        const string & param_types = callee.param_types.at(call.name);
+        if (param_types != call.arg_types)
+            throw Error("`" + unit.path + "` calls `" + call.name + "(" + call.arg_types + ")` but `" +
+                        callee.path + "` defines `" + call.name + "(" + param_types + ")`");
+        return _codeAddress(callee, it -> second);
+    }
+    throw Error("undefined reference to `" + call.name + "` in `" + unit.path + "`");
+}
+
+
+/**
+ * @brief 链接
+ * @param code 链接好的四元式
+ * @param lines 每条四元式的源代码行号
+ */
+void Linker::link(vector<Quadruple> & code, vector<int> & lines) {
+    _layout();
+
+    code.assign(code_size, Quadruple(INTER_CODE_OP_ENUM::HALT, "", "", ""));
+    lines.assign(code_size, 0);
+
+    int data_size = 0;
+    for (auto & unit: units) {
+        data_size = unit.data_base + unit.frame_size;
+
+        int l = unit.code.size();
+        for (int pc = 1; pc < l; pc ++) {
+            const Quadruple & q = unit.code[pc];
+            int at = _codeAddress(unit, pc);
+            code[at].op = q.op;
+            code[at].arg1 = Quadruple::intern(_relocateData(unit, Quadruple::text(q.arg1)));
+            code[at].arg2 = Quadruple::intern(_relocateData(unit, Quadruple::text(q.arg2)));
+            code[at].res = Quadruple::intern(_relocateData(unit, Quadruple::text(q.res)));
+            lines[at] = unit.lines[pc];
+        }
+
+        for (int pc: unit.code_relocs) {
+            int target = _number(Quadruple::text(unit.code[pc].res), unit);
+            code[_codeAddress(unit, pc)].res = Quadruple::intern(int2string(_codeAddress(unit, target)));
+        }
+        for (auto & call: unit.calls)
+            code[_codeAddress(unit, call.pc)].res = Quadruple::intern(int2string(_resolve(unit, call)));
+    }
+
+    // 全局数据区连同各文件的数据区
+    code[0] = Quadruple(INTER_CODE_OP_ENUM::ENTER, "", "", int2string(data_size));
+}
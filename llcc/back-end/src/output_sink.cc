@@ -0,0 +1,206 @@
+/**
+ * @file output_sink.cc
+ * @brief PRINT 的输出缓冲具体实现
+ */
+
+#include "../include/output_sink.h"
+
+#include <cmath>
+#include <cstring>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+
+
+/**
+ * @brief 构造函数，默认输出到 stdout，终端上按行刷新，重定向到文件时写满再刷新
+ */
+OutputSink::OutputSink() {
+    file = stdout;
+    owned = false;
+    length = 0;
+    flushed = 0;
+    policy = FLUSH_POLICY_ENUM::FULL;
+#if defined(__unix__) || defined(__APPLE__)
+    if (isatty(fileno(stdout)))
+        policy = FLUSH_POLICY_ENUM::LINE;
+#endif
+}
+
+
+OutputSink::~OutputSink() {
+    flush();
+    if (owned)
+        fclose(file);
+}
+
+
+/**
+ * @brief 改为输出到文件
+ * @param append 接在原有内容后面，从检查点恢复时用
+ * @return 能不能打开
+ */
+bool OutputSink::open(const string & path, bool append) {
+    FILE * f = fopen(path.c_str(), append ? "a" : "w");
+    if (! f)
+        return false;
+
+    flush();
+    if (owned)
+        fclose(file);
+    file = f;
+    owned = true;
+    policy = FLUSH_POLICY_ENUM::FULL;
+    flushed = 0;
+    if (append) {
+        fseek(file, 0, SEEK_END);
+        flushed = ftell(file);
+    }
+    return true;
+}
+
+
+/**
+ * @brief 从检查点恢复: 输出文件截到检查点时的长度，丢掉检查点之后又输出的部分；
+ * stdout 没法截，只从这里接着数
+ * @return 文件有没有检查点时那么长
+ */
+bool OutputSink::truncate(int64_t size) {
+    flush();
+    if (! owned) {
+        flushed = size;
+        return true;
+    }
+    if (flushed < size)
+        return false;
+#if defined(__unix__) || defined(__APPLE__)
+    if (ftruncate(fileno(file), size) != 0)
+        return false;
+#else
+    if (flushed != size)
+        return false;
+#endif
+    fseek(file, 0, SEEK_END);
+    flushed = size;
+    return true;
+}
+
+
+/**
+ * @brief 一共输出了多少字节，含缓冲区里的
+ */
+int64_t OutputSink::size() const {
+    return flushed + length;
+}
+
+
+void OutputSink::setFlushPolicy(FLUSH_POLICY_ENUM _policy) {
+    policy = _policy;
+}
+
+
+/**
+ * @brief 保证缓冲区还能放下 size 个字节
+ */
+void OutputSink::_reserve(int size) {
+    if (length + size > OUTPUT_BUFFER_SIZE)
+        flush();
+}
+
+
+/**
+ * @brief 每次输出之后按策略刷新
+ */
+void OutputSink::_written() {
+    if (policy == FLUSH_POLICY_ENUM::ALWAYS)
+        flush();
+}
+
+
+/**
+ * @brief 输出整数，从低位往高位写到临时区再拷贝
+ */
+void OutputSink::writeInt(int64_t value) {
+    char digits[24];
+    int pos = sizeof(digits);
+
+    // 用无符号数取反，INT64_MIN 也不会溢出
+    uint64_t x = value < 0 ? 0 - uint64_t(value) : uint64_t(value);
+    do {
+        digits[-- pos] = char('0' + x % 10);
+        x /= 10;
+    } while (x);
+    if (value < 0)
+        digits[-- pos] = '-';
+
+    int size = sizeof(digits) - pos;
+    _reserve(size);
+    memcpy(buffer + length, digits + pos, size);
+    length += size;
+    _written();
+}
+
+
+/**
+ * @brief 输出浮点数，格式和 cout 默认的一样 (%g)，6 位以内的整数值直接按整数输出
+ */
+void OutputSink::writeDouble(double value) {
+    if (value == std::floor(value) && std::fabs(value) < 1e6 && ! (value == 0 && std::signbit(value))) {
+        writeInt(int64_t(value));
+        return;
+    }
+
+    _reserve(32);
+    length += snprintf(buffer + length, 32, "%g", value);
+    _written();
+}
+
+
+void OutputSink::writeString(const string & str) {
+    writeString(str.data(), str.size());
+}
+
+
+void OutputSink::writeString(const char * str, int size) {
+    _reserve(size);
+
+    // 比缓冲区还大的直接写出去
+    if (size > OUTPUT_BUFFER_SIZE) {
+        fwrite(str, 1, size, file);
+        flushed += size;
+        _written();
+        return;
+    }
+
+    memcpy(buffer + length, str, size);
+    length += size;
+    _written();
+}
+
+
+void OutputSink::writeChar(char ch) {
+    _reserve(1);
+    buffer[length ++] = ch;
+    _written();
+}
+
+
+void OutputSink::writeNewline() {
+    _reserve(1);
+    buffer[length ++] = '\n';
+    if (policy != FLUSH_POLICY_ENUM::FULL)
+        flush();
+}
+
+
+/**
+ * @brief 把缓冲区写出去
+ */
+void OutputSink::flush() {
+    if (length > 0)
+        fwrite(buffer, 1, length, file);
+    flushed += length;
+    length = 0;
+    fflush(file);
+}
@@ -0,0 +1,387 @@
+/**
+ * @file program.cc
+ * @brief 预解码后的程序
+ */
+
+#include "../include/program.h"
+#include "../include/verifier.h"
+
+#include <cstdlib>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#endif
+
+#define INCREMENT 100
+
+
+Program::Program() {
+    code = nullptr;
+    index_pool = nullptr;
+    line_table = nullptr;
+    string_table = nullptr;
+    string_data = nullptr;
+    code_size = index_size = line_count = string_count = 0;
+    v_size = t_size = 0;
+    stack_size = 0;
+    mapping = nullptr;
+    mapping_size = 0;
+}
+
+
+Program::~Program() {
+    release();
+}
+
+
+/**
+ * @brief 释放代码，解除字节码文件的映射
+ */
+void Program::release() {
+#if defined(__unix__) || defined(__APPLE__)
+    if (mapping)
+        munmap(const_cast<void *>(mapping), mapping_size);
+#endif
+    mapping = nullptr;
+    mapping_size = 0;
+
+    code_storage.clear();
+    index_storage.clear();
+    line_storage.clear();
+    string_storage.clear();
+    text_storage.clear();
+    code = nullptr;
+    index_pool = nullptr;
+    line_table = nullptr;
+    string_table = nullptr;
+    string_data = nullptr;
+    code_size = index_size = line_count = string_count = 0;
+}
+
+
+/**
+ * @brief 代码改为指向 *_storage
+ */
+void Program::_bindStorage() {
+    code = code_storage.data();
+    code_size = code_storage.size();
+    index_pool = index_storage.data();
+    index_size = index_storage.size();
+    line_table = line_storage.data();
+    line_count = line_storage.size();
+    string_table = string_storage.data();
+    string_count = string_storage.size();
+    string_data = text_storage.data();
+}
+
+
+/**
+ * @brief 预解码，把四元式的字符串操作数翻译成 Operand，再校验
+ * @param lines 每条四元式的源代码行号，没有就不要行号表
+ */
+void Program::load(const vector<Quadruple> & quadruples, const vector<int> * lines) {
+    _begin();
+    code_storage.reserve(quadruples.size() + 1);
+    for (auto & q: quadruples)
+        _append(q);
+    if (lines) {
+        int l = std::min(lines -> size(), quadruples.size());
+        for (int i = 0; i < l; i ++)
+            _addLine(i, (* lines)[i]);
+    }
+    _finish();
+}
+
+
+/**
+ * @brief 边读中间代码文件边预解码，不保留四元式
+ */
+void Program::load(InterCodeReader & reader) {
+    _begin();
+    Quadruple q(INTER_CODE_OP_ENUM::HALT, "", "", "");
+    while (reader.next(q))
+        _append(q);
+
+    int pc, line;
+    while (reader.nextLineEntry(pc, line))
+        if (0 <= pc && pc < int(code_storage.size()))
+            _addLine(pc, line);
+    _finish();
+}
+
+
+void Program::_begin() {
+    release();
+    v_size = t_size = 0;
+    stack_size = PROGRAM_STACK_SIZE;
+}
+
+
+/**
+ * @brief 预解码一条四元式
+ */
+void Program::_append(const Quadruple & q) {
+    VALUE_TYPE_ENUM arg_type = _isFloat(q.op) ? VALUE_TYPE_ENUM::DOUBLE : VALUE_TYPE_ENUM::INT;
+    VALUE_TYPE_ENUM res_type = q.op == INTER_CODE_OP_ENUM::PUSH ? VALUE_TYPE_ENUM::RAW : VALUE_TYPE_ENUM::INT;
+
+    Instruction ins;
+    ins.op = q.op;
+    ins.arg1 = _decodeOperand(Quadruple::text(q.arg1), arg_type);
+    ins.arg2 = _decodeOperand(Quadruple::text(q.arg2), arg_type);
+    ins.res = _decodeOperand(Quadruple::text(q.res), res_type);
+    code_storage.emplace_back(ins);
+}
+
+
+/**
+ * @brief 行号表只在行号变化的地方记一项
+ */
+void Program::_addLine(int pc, int line) {
+    if (! line_storage.empty()) {
+        if (pc <= line_storage.back().pc)
+            return;
+        if (line_storage.back().line == line)
+            return;
+    }
+    LineEntry entry;
+    entry.pc = pc;
+    entry.line = line;
+    line_storage.emplace_back(entry);
+}
+
+
+/**
+ * @brief pc 对应的源代码行号
+ * @return 行号，不知道时返回 0
+ */
+int Program::lineOf(int pc) const {
+    const LineEntry * end = line_table + line_count;
+    const LineEntry * it = std::upper_bound(line_table, end, pc, [](int x, const LineEntry & e) {
+        return x < e.pc;
+    });
+    return it == line_table ? 0 : (it - 1) -> line;
+}
+
+
+/**
+ * @brief 第 i 个字符串常量，以 '\0' 结尾
+ */
+const char * Program::stringAt(int i) const {
+    return string_data + string_table[i].offset;
+}
+
+
+int Program::stringLength(int i) const {
+    return string_table[i].length;
+}
+
+
+/**
+ * @brief 加上哨兵，再校验
+ */
+void Program::_finish() {
+    // 只有 pc 0 的 ENTER 是全局变量，其他的是函数的栈帧
+    if (! code_storage.empty() && code_storage[0].op == INTER_CODE_OP_ENUM::ENTER)
+        v_size = std::max(v_size, int(code_storage[0].res.value.i));
+    // 没有 ENTER 的旧格式文件，数组的大小不可知，留些余量
+    else
+        v_size += INCREMENT;
+
+    // 哨兵，跳出代码范围都落到这里
+    Instruction halt;
+    halt.op = INTER_CODE_OP_ENUM::HALT;
+    halt.arg1 = halt.arg2 = halt.res = _decodeOperand("");
+    code_storage.emplace_back(halt);
+    _bindStorage();
+
+    // 校验通过后执行时不再检查跳转目标和静态操作数，内存也一次分配好
+    try {
+        Verifier verifier(* this);
+        stack_size = verifier.verify();
+    }
+    catch (Error & e) {
+        cout << "Bytecode verify errors :" << endl;
+        cout << e;
+        exit(0);
+    }
+
+    // pc+N 改写成绝对地址，执行时不再加 pc
+    for (int pc = 0; pc < code_size; pc ++) {
+        _resolvePc(code_storage[pc].arg1, pc);
+        _resolvePc(code_storage[pc].arg2, pc);
+        _resolvePc(code_storage[pc].res, pc);
+    }
+}
+
+
+/**
+ * @brief 把 pc+N 改写成立即数，连同嵌套的下标操作数
+ */
+void Program::_resolvePc(Operand & operand, int pc) {
+    if (operand.kind == OPERAND_KIND_ENUM::PC) {
+        operand.kind = OPERAND_KIND_ENUM::IMMEDIATE;
+        operand.value.i = pc + operand.slot;
+        operand.slot = 0;
+    }
+    else if (operand.kind == OPERAND_KIND_ENUM::VAR_INDEXED || operand.kind == OPERAND_KIND_ENUM::LOCAL_INDEXED)
+        _resolvePc(index_storage[operand.index], pc);
+}
+
+
+/**
+ * @brief FNV-1a 64
+ */
+void Program::_hash(uint64_t & hash, const void * data, size_t size) {
+    const uint8_t * bytes = (const uint8_t *) data;
+    for (size_t i = 0; i < size; i ++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+}
+
+
+/**
+ * @brief 只哈希字段，不管填充字节
+ */
+void Program::_hashOperand(uint64_t & hash, const Operand & operand) {
+    _hash(hash, &operand.kind, sizeof(operand.kind));
+    _hash(hash, &operand.slot, sizeof(operand.slot));
+    _hash(hash, &operand.index, sizeof(operand.index));
+    _hash(hash, &operand.value, sizeof(operand.value));
+}
+
+
+/**
+ * @brief 程序的指纹，代码、常量和内存布局一样的程序指纹相同，检查点靠它认程序
+ */
+uint64_t Program::fingerprint() const {
+    uint64_t hash = 14695981039346656037ULL;
+    for (int i = 0; i < code_size; i ++) {
+        _hash(hash, &code[i].op, sizeof(code[i].op));
+        _hashOperand(hash, code[i].arg1);
+        _hashOperand(hash, code[i].arg2);
+        _hashOperand(hash, code[i].res);
+    }
+    for (int i = 0; i < index_size; i ++)
+        _hashOperand(hash, index_pool[i]);
+    for (int i = 0; i < string_count; i ++)
+        _hash(hash, stringAt(i), stringLength(i) + 1);
+
+    _hash(hash, &v_size, sizeof(v_size));
+    _hash(hash, &t_size, sizeof(t_size));
+    _hash(hash, &stack_size, sizeof(stack_size));
+    return hash;
+}
+
+
+/**
+ * @brief 参数 (arg1, arg2) 是不是浮点数
+ */
+bool Program::_isFloat(INTER_CODE_OP_ENUM op) {
+    switch (op) {
+        case INTER_CODE_OP_ENUM::FADD:
+        case INTER_CODE_OP_ENUM::FSUB:
+        case INTER_CODE_OP_ENUM::FMUL:
+        case INTER_CODE_OP_ENUM::FDIV:
+        case INTER_CODE_OP_ENUM::FJE:
+        case INTER_CODE_OP_ENUM::FJNE:
+        case INTER_CODE_OP_ENUM::FJL:
+        case INTER_CODE_OP_ENUM::FJG:
+        case INTER_CODE_OP_ENUM::FMOV:
+        case INTER_CODE_OP_ENUM::FPRINT:
+        case INTER_CODE_OP_ENUM::FTOI:
+            return true;
+        default:
+            return false;
+    }
+}
+
+
+/**
+ * @brief 解码一个操作数
+ * @param value_str 操作数字符串，如 v12, t3, v0[t4], l-3, l0[l2], pc+3, 3.5, "hello"
+ * @param type 立即数解码成整数还是浮点数
+ */
+Operand Program::_decodeOperand(const string & value_str, VALUE_TYPE_ENUM type) {
+    Operand ret;
+    ret.kind = OPERAND_KIND_ENUM::NONE;
+    ret.slot = ret.index = 0;
+    ret.value.i = 0;
+
+    if (value_str.empty())
+        return ret;
+
+    char head = value_str[0];
+    // 字符串常量
+    if (head == '\"' || head == '\'') {
+        StringEntry entry;
+        entry.offset = text_storage.size();
+        entry.length = value_str.size() - 2;
+        ret.kind = OPERAND_KIND_ENUM::STRING;
+        ret.slot = string_storage.size();
+        string_storage.emplace_back(entry);
+        text_storage.append(value_str, 1, entry.length);
+        text_storage += '\0';
+    }
+    // pc+N
+    else if (head == 'p') {
+        ret.kind = OPERAND_KIND_ENUM::PC;
+        ret.slot = string2int(value_str.substr(3));
+    }
+    // 变量 或 变址寻址
+    else if (head == 'v') {
+        size_t bracket = value_str.find('[');
+        if (bracket == string::npos) {
+            ret.kind = OPERAND_KIND_ENUM::VAR;
+            ret.slot = string2int(value_str.substr(1));
+            v_size = std::max(v_size, ret.slot + 1);
+        }
+        else {
+            // 下标是整数，可能还是变址寻址 v0[v1[t2]]，先解码再入池
+            Operand offset = _decodeOperand(value_str.substr(bracket + 1, value_str.size() - bracket - 2));
+            ret.kind = OPERAND_KIND_ENUM::VAR_INDEXED;
+            ret.slot = string2int(value_str.substr(1, bracket - 1));
+            v_size = std::max(v_size, ret.slot + 1);
+            ret.index = index_storage.size();
+            index_storage.emplace_back(offset);
+        }
+    }
+    // 栈帧里的变量 或 变址寻址
+    else if (head == 'l') {
+        size_t bracket = value_str.find('[');
+        if (bracket == string::npos) {
+            ret.kind = OPERAND_KIND_ENUM::LOCAL;
+            ret.slot = string2int(value_str.substr(1));
+        }
+        else {
+            Operand offset = _decodeOperand(value_str.substr(bracket + 1, value_str.size() - bracket - 2));
+            ret.kind = OPERAND_KIND_ENUM::LOCAL_INDEXED;
+            ret.slot = string2int(value_str.substr(1, bracket - 1));
+            ret.index = index_storage.size();
+            index_storage.emplace_back(offset);
+        }
+    }
+    // 旧格式的临时变量，放到 0 号寄存器前面
+    else if (head == 't') {
+        int temp_index = string2int(value_str.substr(1));
+        ret.kind = OPERAND_KIND_ENUM::VAR;
+        ret.slot = -(temp_index + 1);
+        t_size = std::max(t_size, temp_index + 1);
+    }
+    // 立即数
+    else {
+        bool has_dot = value_str.find('.') != string::npos;
+        if (type == VALUE_TYPE_ENUM::RAW)
+            type = has_dot ? VALUE_TYPE_ENUM::DOUBLE : VALUE_TYPE_ENUM::INT;
+
+        ret.kind = OPERAND_KIND_ENUM::IMMEDIATE;
+        if (type == VALUE_TYPE_ENUM::DOUBLE)
+            ret.value.d = string2double(value_str);
+        else if (has_dot)
+            ret.value.i = int64_t(string2double(value_str));
+        else
+            ret.value.i = strtoll(value_str.c_str(), nullptr, 10);
+    }
+
+    return ret;
+}
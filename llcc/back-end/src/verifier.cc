@@ -0,0 +1,369 @@
+/**
+ * @file verifier.cc
+ * @brief 字节码校验具体实现
+ */
+
+#include "../include/verifier.h"
+
+#include <algorithm>
+#include <climits>
+
+// _stackNeed 的记忆化标记
+#define NEED_UNKNOWN (-1)   // 算不出来: 递归，或者 PUSH 和 CALL 对不上 (旧格式)
+#define NEED_VISITING (-2)  // 正在算，再次遇到就是递归
+#define NEED_NONE (-3)      // 还没算
+
+
+/**
+ * @brief 构造函数
+ * @param _program 解码完或者读进来的程序，校验时只读
+ * @param _from_file 程序来自字节码文件: 里面的东西都不可信，操作码、操作数种类、下标操作数和字符串的编号都要查，
+ *                   pc+N 写文件前已经改写成了绝对地址，再出现就是坏文件
+ */
+Verifier::Verifier(const Program & _program, bool _from_file): program(_program), from_file(_from_file) {}
+
+
+/**
+ * @brief 校验整个程序，出错抛 Error
+ * @return 栈需要多大 (Value 个数)，算不出来时是 PROGRAM_STACK_SIZE
+ */
+long long Verifier::verify() {
+    _checkEncoding();
+    _splitFrames();
+
+    // 末尾的哨兵 HALT 不用查
+    int code_len = program.getCodeSize() - 1;
+    for (int i = 0; i < code_len; i ++)
+        _checkInstruction(i);
+
+    need.assign(frames.size(), NEED_NONE);
+    long long global_need = _stackNeed(0);
+    return global_need == NEED_UNKNOWN ? PROGRAM_STACK_SIZE : global_need;
+}
+
+
+/**
+ * @brief 操作码和操作数的种类都是认识的，末尾是哨兵，pc 0 的 ENTER 不超过全局变量的个数
+ */
+void Verifier::_checkEncoding() {
+    if (program.getCodeSize() < 1 || program.getCode()[program.getCodeSize() - 1].op != INTER_CODE_OP_ENUM::HALT)
+        throw Error("code must end with the HALT sentinel");
+
+    for (int i = 0; i < program.getCodeSize(); i ++) {
+        const Instruction & ins = program.getCode()[i];
+        if (int(ins.op) < 0 || int(ins.op) > int(INTER_CODE_OP_ENUM::HALT))
+            throw Error(_where(i) + "unknown opcode " + int2string(int(ins.op)));
+        for (const Operand * operand: {&ins.arg1, &ins.arg2, &ins.res})
+            if (int(operand -> kind) < 0 || int(operand -> kind) > int(OPERAND_KIND_ENUM::STRING))
+                throw Error(_where(i) + "unknown operand kind " + int2string(int(operand -> kind)));
+    }
+    for (int i = 0; i < program.getIndexSize(); i ++) {
+        OPERAND_KIND_ENUM kind = program.getIndexPool()[i].kind;
+        if (int(kind) < 0 || int(kind) > int(OPERAND_KIND_ENUM::STRING))
+            throw Error("index operand " + int2string(i) + " has unknown kind " + int2string(int(kind)));
+    }
+
+    const Instruction & enter = program.getCode()[0];
+    if (enter.op == INTER_CODE_OP_ENUM::ENTER && enter.res.kind == OPERAND_KIND_ENUM::IMMEDIATE &&
+        enter.res.value.i > program.getVSize())
+        throw Error(_where(0) + "global frame is larger than the " + int2string(program.getVSize()) + " globals");
+}
+
+
+/**
+ * @brief 按 ENTER 把代码切成栈帧，顺便核对每个函数的 RET 弹出的参数个数一致
+ * 函数只能从 CALL 进入，前一段代码不能顺序执行到它的 ENTER 上
+ */
+void Verifier::_splitFrames() {
+    int code_len = program.getCodeSize() - 1;
+    frames.clear();
+    frame_of.assign(code_len, 0);
+
+    FrameInfo global;
+    global.start = 0;
+    global.frame_size = program.getVSize();
+    global.param_count = -1;
+    frames.emplace_back(global);
+
+    for (int i = 0; i < code_len; i ++) {
+        const Instruction & ins = program.getCode()[i];
+        if (ins.op == INTER_CODE_OP_ENUM::ENTER && i > 0) {
+            if (ins.res.kind != OPERAND_KIND_ENUM::IMMEDIATE || ins.res.value.i < 0 || ins.res.value.i > INT_MAX)
+                throw Error(_where(i) + "frame size must be a non-negative immediate");
+            INTER_CODE_OP_ENUM last = program.getCode()[i - 1].op;
+            if (last != INTER_CODE_OP_ENUM::J && last != INTER_CODE_OP_ENUM::RET && last != INTER_CODE_OP_ENUM::HALT)
+                throw Error(_where(i) + "the code before this function falls through into it");
+
+            frames.back().end = i;
+            FrameInfo frame;
+            frame.start = i;
+            frame.frame_size = int(ins.res.value.i);
+            frame.param_count = -1;
+            frames.emplace_back(frame);
+        }
+        frame_of[i] = int(frames.size()) - 1;
+
+        if (ins.op == INTER_CODE_OP_ENUM::RET) {
+            if (frames.size() == 1)
+                throw Error(_where(i) + "RET outside of a function");
+            if (ins.res.kind != OPERAND_KIND_ENUM::IMMEDIATE || ins.res.value.i < 0 || ins.res.value.i > INT_MAX)
+                throw Error(_where(i) + "argument count must be a non-negative immediate");
+
+            FrameInfo & frame = frames.back();
+            if (frame.param_count >= 0 && frame.param_count != ins.res.value.i)
+                throw Error(_where(i) + "RET pops " + int2string(int(ins.res.value.i)) +
+                            " arguments but another RET of this function pops " + int2string(frame.param_count));
+            frame.param_count = int(ins.res.value.i);
+        }
+    }
+    frames.back().end = code_len;
+}
+
+
+/**
+ * @brief 按指令检查操作数的种类
+ */
+void Verifier::_checkInstruction(int pc) {
+    const Instruction & ins = program.getCode()[pc];
+    int bound = program.getIndexSize();
+
+    switch (ins.op) {
+        case INTER_CODE_OP_ENUM::ADD:
+        case INTER_CODE_OP_ENUM::SUB:
+        case INTER_CODE_OP_ENUM::MUL:
+        case INTER_CODE_OP_ENUM::DIV:
+        case INTER_CODE_OP_ENUM::MOD:
+        case INTER_CODE_OP_ENUM::FADD:
+        case INTER_CODE_OP_ENUM::FSUB:
+        case INTER_CODE_OP_ENUM::FMUL:
+        case INTER_CODE_OP_ENUM::FDIV:
+            _checkValue(ins.arg1, pc, bound);
+            _checkValue(ins.arg2, pc, bound);
+            _checkMemory(ins.res, pc, bound);
+            break;
+        case INTER_CODE_OP_ENUM::MOV:
+        case INTER_CODE_OP_ENUM::FMOV:
+        case INTER_CODE_OP_ENUM::ITOF:
+        case INTER_CODE_OP_ENUM::FTOI:
+            _checkValue(ins.arg1, pc, bound);
+            _checkMemory(ins.res, pc, bound);
+            break;
+        case INTER_CODE_OP_ENUM::J:
+            _checkTarget(ins.res, pc);
+            break;
+        case INTER_CODE_OP_ENUM::JE:
+        case INTER_CODE_OP_ENUM::JNE:
+        case INTER_CODE_OP_ENUM::JL:
+        case INTER_CODE_OP_ENUM::JG:
+        case INTER_CODE_OP_ENUM::FJE:
+        case INTER_CODE_OP_ENUM::FJNE:
+        case INTER_CODE_OP_ENUM::FJL:
+        case INTER_CODE_OP_ENUM::FJG:
+            _checkValue(ins.arg1, pc, bound);
+            _checkValue(ins.arg2, pc, bound);
+            _checkTarget(ins.res, pc);
+            break;
+        case INTER_CODE_OP_ENUM::PRINT:
+        case INTER_CODE_OP_ENUM::FPRINT:
+            // 空操作数是换行
+            if (ins.arg1.kind != OPERAND_KIND_ENUM::STRING)
+                _checkValue(ins.arg1, pc, bound);
+            else if (ins.arg1.slot < 0 || ins.arg1.slot >= program.getStringCount())
+                throw Error(_where(pc) + "string constant " + int2string(ins.arg1.slot) + " out of range");
+            break;
+        case INTER_CODE_OP_ENUM::POP:
+            _checkMemory(ins.res, pc, bound);
+            break;
+        case INTER_CODE_OP_ENUM::PUSH:
+            _checkValue(ins.res, pc, bound);
+            break;
+        case INTER_CODE_OP_ENUM::CALL:
+            _checkTarget(ins.res, pc);
+            if (! _isStatic(ins.res) || _immediate(ins.res, pc) <= 0 ||
+                _immediate(ins.res, pc) >= int64_t(frame_of.size()) ||
+                program.getCode()[_immediate(ins.res, pc)].op != INTER_CODE_OP_ENUM::ENTER)
+                throw Error(_where(pc) + "CALL must target the ENTER of a function");
+            break;
+        case INTER_CODE_OP_ENUM::ENTER:
+            if (ins.res.kind != OPERAND_KIND_ENUM::IMMEDIATE || ins.res.value.i < 0 || ins.res.value.i > INT_MAX)
+                throw Error(_where(pc) + "frame size must be a non-negative immediate");
+            break;
+        default:
+            // RET 在 _splitFrames 里查过了
+            break;
+    }
+}
+
+
+/**
+ * @brief 读取的操作数: 立即数，pc+N，变量，空操作数读出 0
+ * @param index_bound 下标操作数的编号必须小于它，嵌套的下标只能往前指，不会成环
+ * @param depth 外面套了几层下标，不能超过 PROGRAM_INDEX_DEPTH
+ */
+void Verifier::_checkValue(const Operand & operand, int pc, int index_bound, int depth) {
+    switch (operand.kind) {
+        case OPERAND_KIND_ENUM::NONE:
+        case OPERAND_KIND_ENUM::IMMEDIATE:
+            break;
+        case OPERAND_KIND_ENUM::PC:
+            if (from_file)
+                throw Error(_where(pc) + "pc-relative operand in a bytecode file");
+            break;
+        case OPERAND_KIND_ENUM::STRING:
+            throw Error(_where(pc) + "string constant can only be printed");
+        default:
+            _checkMemory(operand, pc, index_bound, depth);
+            break;
+    }
+}
+
+
+/**
+ * @brief 写入的操作数必须是变量，常量下标的访问直接查范围
+ */
+void Verifier::_checkMemory(const Operand & operand, int pc, int index_bound, int depth) {
+    switch (operand.kind) {
+        case OPERAND_KIND_ENUM::VAR:
+        case OPERAND_KIND_ENUM::LOCAL:
+            _checkSlot(operand.kind, operand.slot, pc);
+            break;
+        case OPERAND_KIND_ENUM::VAR_INDEXED:
+        case OPERAND_KIND_ENUM::LOCAL_INDEXED: {
+            OPERAND_KIND_ENUM kind = operand.kind == OPERAND_KIND_ENUM::VAR_INDEXED ?
+                                     OPERAND_KIND_ENUM::VAR : OPERAND_KIND_ENUM::LOCAL;
+            _checkSlot(kind, operand.slot, pc);
+            if (operand.index < 0 || operand.index >= index_bound)
+                throw Error(_where(pc) + "index operand " + int2string(operand.index) + " out of range");
+            if (depth >= PROGRAM_INDEX_DEPTH)
+                throw Error(_where(pc) + "index operands nested deeper than " + int2string(PROGRAM_INDEX_DEPTH));
+
+            const Operand & offset = program.getIndexPool()[operand.index];
+            _checkValue(offset, pc, operand.index, depth + 1);
+            if (_isStatic(offset))
+                _checkSlot(kind, (long long) operand.slot + _immediate(offset, pc), pc);
+            break;
+        }
+        default:
+            throw Error(_where(pc) + "operand is not a variable");
+    }
+}
+
+
+/**
+ * @brief 全局变量在 [-t_size, v_size) 里，局部变量在帧里或者是参数
+ */
+void Verifier::_checkSlot(OPERAND_KIND_ENUM kind, long long slot, int pc) {
+    if (kind == OPERAND_KIND_ENUM::VAR) {
+        if (slot < -program.getTSize() || slot >= program.getVSize())
+            throw Error(_where(pc) + "global slot " + int2string(int(slot)) + " out of range");
+        return;
+    }
+
+    const FrameInfo & frame = frames[frame_of[pc]];
+    if (frame_of[pc] == 0)
+        throw Error(_where(pc) + "local slot outside of a function");
+
+    // 没有 RET 的函数不知道参数个数，链接字以下都算参数
+    bool is_local = 0 <= slot && slot < frame.frame_size;
+    bool is_param = slot < -FRAME_LINK_SIZE &&
+                    (frame.param_count < 0 || slot >= -FRAME_LINK_SIZE - frame.param_count);
+    if (! is_local && ! is_param)
+        throw Error(_where(pc) + "local slot " + int2string(int(slot)) + " out of range");
+}
+
+
+/**
+ * @brief 跳转目标: 静态目标必须在本函数里或者是末尾的哨兵；存在变量里的是动态目标，
+ * 动态目标可能落进任何函数，只有没有函数的旧格式程序能用
+ */
+void Verifier::_checkTarget(const Operand & operand, int pc) {
+    if (operand.kind == OPERAND_KIND_ENUM::NONE || operand.kind == OPERAND_KIND_ENUM::STRING)
+        throw Error(_where(pc) + "missing jump target");
+
+    _checkValue(operand, pc, program.getIndexSize());
+    if (! _isStatic(operand)) {
+        if (frames.size() > 1)
+            throw Error(_where(pc) + "computed jump target in a program with functions");
+        return;
+    }
+
+    int64_t target = _immediate(operand, pc);
+    int64_t halt_index = int64_t(frame_of.size());
+    if (target < 0 || target > halt_index)
+        throw Error(_where(pc) + "jump target " + int2string(int(target)) + " out of range");
+
+    // 只有 CALL 能跳进别的函数
+    if (program.getCode()[pc].op != INTER_CODE_OP_ENUM::CALL && target != halt_index &&
+        frame_of[target] != frame_of[pc])
+        throw Error(_where(pc) + "jump target " + int2string(int(target)) + " is in another function");
+}
+
+
+/**
+ * @brief 操作数的值在加载时就知道: 立即数或者 pc+N
+ */
+bool Verifier::_isStatic(const Operand & operand) {
+    return operand.kind == OPERAND_KIND_ENUM::IMMEDIATE || operand.kind == OPERAND_KIND_ENUM::PC;
+}
+
+
+/**
+ * @brief 静态操作数的值，pc+N 还没改写成绝对地址，在这里现算
+ */
+int64_t Verifier::_immediate(const Operand & operand, int pc) {
+    return operand.kind == OPERAND_KIND_ENUM::PC ? int64_t(pc) + operand.slot : operand.value.i;
+}
+
+
+/**
+ * @brief 从帧指针算起，这段栈帧连同它调用的函数最多用多少栈
+ *
+ * 实参紧挨着 CALL 压栈，一路扫下来数 PUSH 就是栈的高度。
+ * 递归，或者旧格式里 PUSH 的返回地址和 POP 的参数对不上时算不出来，返回 NEED_UNKNOWN
+ */
+long long Verifier::_stackNeed(int frame) {
+    if (need[frame] == NEED_VISITING)
+        return NEED_UNKNOWN;
+    if (need[frame] != NEED_NONE)
+        return need[frame];
+    need[frame] = NEED_VISITING;
+
+    // 全局变量不在栈上
+    long long base = frame == 0 ? 0 : frames[frame].frame_size;
+    long long pending = 0, ret = base;
+    for (int i = frames[frame].start; i < frames[frame].end && ret != NEED_UNKNOWN; i ++) {
+        const Instruction & ins = program.getCode()[i];
+        if (ins.op == INTER_CODE_OP_ENUM::PUSH) {
+            pending ++;
+            ret = std::max(ret, base + pending);
+        }
+        else if (ins.op == INTER_CODE_OP_ENUM::POP)
+            ret = NEED_UNKNOWN;
+        else if (ins.op == INTER_CODE_OP_ENUM::CALL) {
+            int callee = frame_of[_immediate(ins.res, i)];
+            long long sub = _stackNeed(callee);
+            if (sub == NEED_UNKNOWN || frames[callee].param_count != pending)
+                ret = NEED_UNKNOWN;
+            else
+                ret = std::max(ret, base + pending + FRAME_LINK_SIZE + sub);
+            pending = 0;
+        }
+    }
+    if (pending != 0)
+        ret = NEED_UNKNOWN;
+
+    need[frame] = ret;
+    return ret;
+}
+
+
+/**
+ * @brief 报错信息的前缀
+ */
+string Verifier::_where(int pc) {
+    int line = program.lineOf(pc);
+    int op = int(program.getCode()[pc].op);
+    bool known = 0 <= op && op <= int(INTER_CODE_OP_ENUM::HALT);
+    return "pc " + int2string(pc) + (line > 0 ? " (line " + int2string(line) + ")" : "") +
+           " `" + (known ? Quadruple::INTER_CODE_OP[op] : "?") + "`: ";
+}
@@ -0,0 +1,415 @@
+/**
+ * @file x86_assembler.cc
+ * @brief x86-64 汇编器具体实现
+ */
+
+#include "../include/x86_assembler.h"
+
+
+/**
+ * @brief 汇编器构造函数
+ */
+X86Assembler::X86Assembler() {
+    runtime.resize(int(X86_RUNTIME_ENUM::INDEX_OUT_OF_RANGE) + 1);
+    string_pool = nullptr;
+}
+
+
+/**
+ * @brief 设置运行时函数的地址
+ */
+void X86Assembler::setRuntime(X86_RUNTIME_ENUM func, void * address) {
+    runtime[int(func)] = address;
+}
+
+
+/**
+ * @brief 设置字符串常量池，生成的代码直接引用其中字符串的地址
+ */
+void X86Assembler::setStringPool(const vector<const char *> * _string_pool) {
+    string_pool = _string_pool;
+}
+
+
+void X86Assembler::_byte(int b) {
+    buffer.emplace_back(uint8_t(b));
+}
+
+
+void X86Assembler::_int32(int32_t x) {
+    for (int i = 0; i < 4; i ++)
+        _byte((uint32_t(x) >> (i * 8)) & 0xFF);
+}
+
+
+/**
+ * @brief 输出 REX 前缀，不需要的时候省略
+ * @param w 是否 64 位操作数
+ * @param reg ModRM.reg 的寄存器编号, -1 表示没有
+ * @param index SIB.index 的寄存器编号, -1 表示没有
+ * @param base ModRM.rm 或 SIB.base 的寄存器编号, -1 表示没有
+ */
+void X86Assembler::_rex(bool w, int reg, int index, int base, bool force) {
+    int rex = 0x40;
+    if (w)
+        rex |= 0x8;
+    if (reg >= 0 && (reg & 8))
+        rex |= 0x4;
+    if (index >= 0 && (index & 8))
+        rex |= 0x2;
+    if (base >= 0 && (base & 8))
+        rex |= 0x1;
+
+    if (rex != 0x40 || force)
+        _byte(rex);
+}
+
+
+/**
+ * @brief 输出 ModRM (+ SIB + disp) 内存寻址
+ */
+void X86Assembler::_modrm(int reg, const X86Mem & mem) {
+    int base = int(mem.base), index = int(mem.index);
+    bool need_sib = index >= 0 || (base & 7) == 4;
+
+    int mod;
+    if (mem.disp == 0 && (base & 7) != 5)
+        mod = 0;
+    else if (-128 <= mem.disp && mem.disp <= 127)
+        mod = 1;
+    else
+        mod = 2;
+
+    if (need_sib) {
+        int ss = mem.scale == 1 ? 0 : mem.scale == 2 ? 1 : mem.scale == 4 ? 2 : 3;
+        _byte((mod << 6) | ((reg & 7) << 3) | 4);
+        _byte((ss << 6) | (((index >= 0 ? index : 4) & 7) << 3) | (base & 7));
+    }
+    else
+        _byte((mod << 6) | ((reg & 7) << 3) | (base & 7));
+
+    if (mod == 1)
+        _byte(mem.disp & 0xFF);
+    else if (mod == 2)
+        _int32(mem.disp);
+}
+
+
+/**
+ * @brief 输出寄存器直接寻址的 ModRM
+ */
+void X86Assembler::_modrmReg(int reg, int rm) {
+    _byte(0xC0 | ((reg & 7) << 3) | (rm & 7));
+}
+
+
+void X86Assembler::_sse(int prefix, int opcode, int reg, const X86Mem & mem) {
+    _byte(prefix);
+    _rex(false, reg, int(mem.index), int(mem.base));
+    _byte(0x0F);
+    _byte(opcode);
+    _modrm(reg, mem);
+}
+
+
+void X86Assembler::_sseReg(int prefix, int opcode, int reg, int rm, bool w) {
+    _byte(prefix);
+    _rex(w, reg, -1, rm);
+    _byte(0x0F);
+    _byte(opcode);
+    _modrmReg(reg, rm);
+}
+
+
+/**
+ * @brief 输出一个待回填的 rel32
+ */
+void X86Assembler::_rel32(int label) {
+    fixup_pos.emplace_back(position());
+    fixup_label.emplace_back(label);
+    _int32(0);
+}
+
+
+/**
+ * @brief 申请一个新的 label
+ */
+int X86Assembler::newLabel() {
+    label_pos.emplace_back(-1);
+    return int(label_pos.size()) - 1;
+}
+
+
+/**
+ * @brief 把 label 绑定到当前位置
+ */
+void X86Assembler::bind(int label) {
+    label_pos[label] = position();
+}
+
+
+int X86Assembler::position() {
+    return int(buffer.size());
+}
+
+
+int X86Assembler::labelPosition(int label) {
+    return label_pos[label];
+}
+
+
+/**
+ * @brief 回填所有跳转，返回机器码
+ */
+const vector<uint8_t> & X86Assembler::finish() {
+    int l = fixup_pos.size();
+    for (int i = 0; i < l; i ++) {
+        int pos = fixup_pos[i];
+        int32_t rel = label_pos[fixup_label[i]] - (pos + 4);
+        for (int j = 0; j < 4; j ++)
+            buffer[pos + j] = uint8_t((uint32_t(rel) >> (j * 8)) & 0xFF);
+    }
+    fixup_pos.clear();
+    fixup_label.clear();
+
+    return buffer;
+}
+
+
+void X86Assembler::push(X86_REG_ENUM reg) {
+    _rex(false, -1, -1, int(reg));
+    _byte(0x50 + (int(reg) & 7));
+}
+
+
+void X86Assembler::pop(X86_REG_ENUM reg) {
+    _rex(false, -1, -1, int(reg));
+    _byte(0x58 + (int(reg) & 7));
+}
+
+
+void X86Assembler::ret() {
+    _byte(0xC3);
+}
+
+
+void X86Assembler::movImm64(X86_REG_ENUM dst, uint64_t imm) {
+    _rex(true, -1, -1, int(dst));
+    _byte(0xB8 + (int(dst) & 7));
+    _int32(int32_t(imm & 0xFFFFFFFFu));
+    _int32(int32_t(imm >> 32));
+}
+
+
+void X86Assembler::movImm32(X86_REG_ENUM dst, int32_t imm) {
+    _rex(false, -1, -1, int(dst));
+    _byte(0xB8 + (int(dst) & 7));
+    _int32(imm);
+}
+
+
+void X86Assembler::mov64(X86_REG_ENUM dst, X86_REG_ENUM src) {
+    _rex(true, int(src), -1, int(dst));
+    _byte(0x89);
+    _modrmReg(int(src), int(dst));
+}
+
+
+/**
+ * @brief mov r64, [mem]
+ */
+void X86Assembler::movLoad(X86_REG_ENUM dst, const X86Mem & mem) {
+    _rex(true, int(dst), int(mem.index), int(mem.base));
+    _byte(0x8B);
+    _modrm(int(dst), mem);
+}
+
+
+/**
+ * @brief mov [mem], r64
+ */
+void X86Assembler::movStore(const X86Mem & mem, X86_REG_ENUM src) {
+    _rex(true, int(src), int(mem.index), int(mem.base));
+    _byte(0x89);
+    _modrm(int(src), mem);
+}
+
+
+/**
+ * @brief lea r64, [mem]
+ */
+void X86Assembler::lea(X86_REG_ENUM dst, const X86Mem & mem) {
+    _rex(true, int(dst), int(mem.index), int(mem.base));
+    _byte(0x8D);
+    _modrm(int(dst), mem);
+}
+
+
+void X86Assembler::add64(X86_REG_ENUM dst, X86_REG_ENUM src) {
+    _rex(true, int(src), -1, int(dst));
+    _byte(0x01);
+    _modrmReg(int(src), int(dst));
+}
+
+
+void X86Assembler::sub64(X86_REG_ENUM dst, X86_REG_ENUM src) {
+    _rex(true, int(src), -1, int(dst));
+    _byte(0x29);
+    _modrmReg(int(src), int(dst));
+}
+
+
+void X86Assembler::imul64(X86_REG_ENUM dst, X86_REG_ENUM src) {
+    _rex(true, int(dst), -1, int(src));
+    _byte(0x0F);
+    _byte(0xAF);
+    _modrmReg(int(dst), int(src));
+}
+
+
+/**
+ * @brief rax 符号扩展到 rdx:rax
+ */
+void X86Assembler::cqo() {
+    _byte(0x48);
+    _byte(0x99);
+}
+
+
+void X86Assembler::idiv64(X86_REG_ENUM src) {
+    _rex(true, -1, -1, int(src));
+    _byte(0xF7);
+    _modrmReg(7, int(src));
+}
+
+
+void X86Assembler::addImm64(X86_REG_ENUM dst, int32_t imm) {
+    _rex(true, -1, -1, int(dst));
+    _byte(0x81);
+    _modrmReg(0, int(dst));
+    _int32(imm);
+}
+
+
+void X86Assembler::subImm64(X86_REG_ENUM dst, int32_t imm) {
+    _rex(true, -1, -1, int(dst));
+    _byte(0x81);
+    _modrmReg(5, int(dst));
+    _int32(imm);
+}
+
+
+/**
+ * @brief 比较 a - b (64 位)
+ */
+void X86Assembler::cmp64(X86_REG_ENUM a, X86_REG_ENUM b) {
+    _rex(true, int(b), -1, int(a));
+    _byte(0x39);
+    _modrmReg(int(b), int(a));
+}
+
+
+void X86Assembler::cmpImm64(X86_REG_ENUM a, int32_t imm) {
+    _rex(true, -1, -1, int(a));
+    _byte(0x81);
+    _modrmReg(7, int(a));
+    _int32(imm);
+}
+
+
+void X86Assembler::movsdLoad(int xmm, const X86Mem & mem) {
+    _sse(0xF2, 0x10, xmm, mem);
+}
+
+
+void X86Assembler::movsdStore(const X86Mem & mem, int xmm) {
+    _sse(0xF2, 0x11, xmm, mem);
+}
+
+
+void X86Assembler::movqToXmm(int xmm, X86_REG_ENUM src) {
+    _sseReg(0x66, 0x6E, xmm, int(src), true);
+}
+
+
+void X86Assembler::cvttsd2si64(X86_REG_ENUM dst, int xmm) {
+    _sseReg(0xF2, 0x2C, int(dst), xmm, true);
+}
+
+
+void X86Assembler::cvtsi2sd64(int xmm, X86_REG_ENUM src) {
+    _sseReg(0xF2, 0x2A, xmm, int(src), true);
+}
+
+
+void X86Assembler::addsd(int dst, int src) {
+    _sseReg(0xF2, 0x58, dst, src);
+}
+
+
+void X86Assembler::subsd(int dst, int src) {
+    _sseReg(0xF2, 0x5C, dst, src);
+}
+
+
+void X86Assembler::mulsd(int dst, int src) {
+    _sseReg(0xF2, 0x59, dst, src);
+}
+
+
+void X86Assembler::divsd(int dst, int src) {
+    _sseReg(0xF2, 0x5E, dst, src);
+}
+
+
+/**
+ * @brief 比较 xmm a 和 xmm b，结果和无符号比较一样放在 ZF/CF/PF
+ */
+void X86Assembler::ucomisd(int a, int b) {
+    _sseReg(0x66, 0x2E, a, b);
+}
+
+
+void X86Assembler::jmp(int label) {
+    _byte(0xE9);
+    _rel32(label);
+}
+
+
+void X86Assembler::jcc(X86_COND_ENUM cond, int label) {
+    _byte(0x0F);
+    _byte(0x80 | int(cond));
+    _rel32(label);
+}
+
+
+void X86Assembler::jmpMem(const X86Mem & mem) {
+    _rex(false, -1, int(mem.index), int(mem.base));
+    _byte(0xFF);
+    _modrm(4, mem);
+}
+
+
+void X86Assembler::jmpReg(X86_REG_ENUM reg) {
+    _rex(false, -1, -1, int(reg));
+    _byte(0xFF);
+    _modrmReg(4, int(reg));
+}
+
+
+void X86Assembler::callReg(X86_REG_ENUM reg) {
+    _rex(false, -1, -1, int(reg));
+    _byte(0xFF);
+    _modrmReg(2, int(reg));
+}
+
+
+void X86Assembler::callRuntime(X86_RUNTIME_ENUM func) {
+    movImm64(X86_REG_ENUM::RAX, uint64_t(runtime[int(func)]));
+    callReg(X86_REG_ENUM::RAX);
+}
+
+
+void X86Assembler::loadStringAddress(X86_REG_ENUM dst, int string_index) {
+    movImm64(dst, uint64_t((* string_pool)[string_index]));
+}
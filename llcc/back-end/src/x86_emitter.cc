@@ -0,0 +1,20 @@
+/**
+ * @file x86_emitter.cc
+ * @brief x86-64 指令输出接口
+ */
+
+#include "../include/x86_emitter.h"
+
+
+/**
+ * @brief 内存操作数构造函数
+ */
+X86Mem::X86Mem(X86_REG_ENUM _base, int _disp, X86_REG_ENUM _index, int _scale) {
+    base = _base;
+    disp = _disp;
+    index = _index;
+    scale = _scale;
+}
+
+
+X86Emitter::~X86Emitter() = default;
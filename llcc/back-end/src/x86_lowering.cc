@@ -0,0 +1,436 @@
+/**
+ * @file x86_lowering.cc
+ * @brief 指令翻译具体实现
+ *
+ * 生成代码的寄存器约定:
+ *      rbx 0 号全局变量的地址    rbp 帧指针
+ *      r12 栈顶                  r13 栈底
+ *      r14 栈的上限              r15 pc -> 机器码地址的跳转表
+ *      整数操作数放 rax / rcx，浮点操作数放 xmm0 / xmm1
+ *      r11 计算变址寻址的地址，r10 是它的下界，rax 兼做装入浮点立即数的临时寄存器
+ *      [rsp] 是序言里对齐用的空位，存放 context
+ */
+
+#include "../include/x86_lowering.h"
+
+#include <cstring>
+
+typedef X86_REG_ENUM R;
+
+static const R REG_BASE = R::RBX;
+static const R REG_FP = R::RBP;
+static const R REG_SP = R::R12;
+static const R REG_STACK_BOTTOM = R::R13;
+static const R REG_STACK_LIMIT = R::R14;
+static const R REG_TABLE = R::R15;
+static const R REG_INDEX = R::R11;
+static const R REG_LOW = R::R10;
+
+
+/**
+ * @brief 构造函数
+ * @param _program 预解码后的程序
+ * @param _as 指令输出到这里
+ */
+X86Lowering::X86Lowering(const Program & _program, X86Emitter & _as): program(_program), as(_as) {
+    exit_label = empty_label = overflow_label = index_label = -1;
+}
+
+
+/**
+ * @brief 翻译整个程序
+ */
+void X86Lowering::lower() {
+    int code_len = program.getCodeSize();
+    pc_labels.clear();
+    for (int i = 0; i < code_len; i ++)
+        pc_labels.emplace_back(as.newLabel());
+    exit_label = as.newLabel();
+    empty_label = as.newLabel();
+    overflow_label = as.newLabel();
+    index_label = as.newLabel();
+
+    // 序言，保存被调用者保存的寄存器，保持栈 16 字节对齐
+    as.push(R::RBP);
+    as.mov64(R::RBP, R::RSP);
+    as.push(R::RBX);
+    as.push(R::R12);
+    as.push(R::R13);
+    as.push(R::R14);
+    as.push(R::R15);
+    as.subImm64(R::RSP, 8);
+    as.movStore(X86Mem(R::RSP), R::R8);
+
+    as.mov64(REG_BASE, R::RDI);
+    as.mov64(REG_FP, R::RDI);
+    as.mov64(REG_SP, R::RSI);
+    as.mov64(REG_STACK_BOTTOM, R::RSI);
+    as.mov64(REG_STACK_LIMIT, R::RDX);
+    as.mov64(REG_TABLE, R::RCX);
+
+    for (int i = 0; i < code_len; i ++) {
+        as.bind(pc_labels[i]);
+        _lowerInstruction(i);
+    }
+
+    as.bind(empty_label);
+    _callRuntime(X86_RUNTIME_ENUM::STACK_EMPTY);
+    as.bind(overflow_label);
+    _callRuntime(X86_RUNTIME_ENUM::STACK_OVERFLOW);
+    as.bind(index_label);
+    _callRuntime(X86_RUNTIME_ENUM::INDEX_OUT_OF_RANGE);
+
+    // 尾声
+    as.bind(exit_label);
+    as.addImm64(R::RSP, 8);
+    as.pop(R::R15);
+    as.pop(R::R14);
+    as.pop(R::R13);
+    as.pop(R::R12);
+    as.pop(R::RBX);
+    as.pop(R::RBP);
+    as.ret();
+}
+
+
+/**
+ * @brief 翻译一条指令
+ */
+void X86Lowering::_lowerInstruction(int pc) {
+    const Instruction & ins = program.getCode()[pc];
+
+    switch (ins.op) {
+        case INTER_CODE_OP_ENUM::ADD:
+        case INTER_CODE_OP_ENUM::SUB:
+        case INTER_CODE_OP_ENUM::MUL:
+        case INTER_CODE_OP_ENUM::DIV:
+        case INTER_CODE_OP_ENUM::MOD:
+            _loadInt(R::RAX, ins.arg1, pc);
+            _loadInt(R::RCX, ins.arg2, pc);
+            if (ins.op == INTER_CODE_OP_ENUM::ADD)
+                as.add64(R::RAX, R::RCX);
+            else if (ins.op == INTER_CODE_OP_ENUM::SUB)
+                as.sub64(R::RAX, R::RCX);
+            else if (ins.op == INTER_CODE_OP_ENUM::MUL)
+                as.imul64(R::RAX, R::RCX);
+            else {
+                as.cqo();
+                as.idiv64(R::RCX);
+                if (ins.op == INTER_CODE_OP_ENUM::MOD)
+                    as.mov64(R::RAX, R::RDX);
+            }
+            as.movStore(_address(ins.res, pc), R::RAX);
+            break;
+        case INTER_CODE_OP_ENUM::FADD:
+        case INTER_CODE_OP_ENUM::FSUB:
+        case INTER_CODE_OP_ENUM::FMUL:
+        case INTER_CODE_OP_ENUM::FDIV:
+            _loadDouble(0, ins.arg1, pc);
+            _loadDouble(1, ins.arg2, pc);
+            if (ins.op == INTER_CODE_OP_ENUM::FADD)
+                as.addsd(0, 1);
+            else if (ins.op == INTER_CODE_OP_ENUM::FSUB)
+                as.subsd(0, 1);
+            else if (ins.op == INTER_CODE_OP_ENUM::FMUL)
+                as.mulsd(0, 1);
+            else
+                as.divsd(0, 1);
+            as.movsdStore(_address(ins.res, pc), 0);
+            break;
+        case INTER_CODE_OP_ENUM::MOV:
+        case INTER_CODE_OP_ENUM::FMOV:
+            // 按位复制
+            _loadInt(R::RAX, ins.arg1, pc);
+            as.movStore(_address(ins.res, pc), R::RAX);
+            break;
+        case INTER_CODE_OP_ENUM::ITOF:
+            _loadInt(R::RAX, ins.arg1, pc);
+            as.cvtsi2sd64(0, R::RAX);
+            as.movsdStore(_address(ins.res, pc), 0);
+            break;
+        case INTER_CODE_OP_ENUM::FTOI:
+            _loadDouble(0, ins.arg1, pc);
+            as.cvttsd2si64(R::RAX, 0);
+            as.movStore(_address(ins.res, pc), R::RAX);
+            break;
+        case INTER_CODE_OP_ENUM::J:
+            _jumpTo(ins.res, pc);
+            break;
+        case INTER_CODE_OP_ENUM::JE:
+        case INTER_CODE_OP_ENUM::JNE:
+        case INTER_CODE_OP_ENUM::JL:
+        case INTER_CODE_OP_ENUM::JG:
+        case INTER_CODE_OP_ENUM::FJE:
+        case INTER_CODE_OP_ENUM::FJNE:
+        case INTER_CODE_OP_ENUM::FJL:
+        case INTER_CODE_OP_ENUM::FJG:
+            _branch(ins, pc);
+            break;
+        case INTER_CODE_OP_ENUM::PRINT:
+        case INTER_CODE_OP_ENUM::FPRINT:
+            if (ins.arg1.kind == OPERAND_KIND_ENUM::NONE)
+                _callRuntime(X86_RUNTIME_ENUM::PRINT_NEWLINE);
+            else if (ins.arg1.kind == OPERAND_KIND_ENUM::STRING) {
+                as.loadStringAddress(R::RSI, ins.arg1.slot);
+                _callRuntime(X86_RUNTIME_ENUM::PRINT_STRING);
+            }
+            else if (ins.op == INTER_CODE_OP_ENUM::FPRINT) {
+                _loadDouble(0, ins.arg1, pc);
+                _callRuntime(X86_RUNTIME_ENUM::PRINT_DOUBLE);
+            }
+            else {
+                _loadInt(R::RSI, ins.arg1, pc);
+                _callRuntime(X86_RUNTIME_ENUM::PRINT_INT);
+            }
+            break;
+        case INTER_CODE_OP_ENUM::PUSH:
+            _loadInt(R::RAX, ins.res, pc);
+            as.cmp64(REG_SP, REG_STACK_LIMIT);
+            as.jcc(X86_COND_ENUM::AE, overflow_label);
+            as.movStore(X86Mem(REG_SP), R::RAX);
+            as.addImm64(REG_SP, 8);
+            break;
+        case INTER_CODE_OP_ENUM::POP:
+            as.cmp64(REG_SP, REG_STACK_BOTTOM);
+            as.jcc(X86_COND_ENUM::E, empty_label);
+            as.subImm64(REG_SP, 8);
+            as.movLoad(R::RAX, X86Mem(REG_SP));
+            as.movStore(_address(ins.res, pc), R::RAX);
+            break;
+        case INTER_CODE_OP_ENUM::CALL:
+            // 返回地址存 pc 而不是机器码地址，RET 时查跳转表
+            as.mov64(R::RAX, REG_SP);
+            as.addImm64(R::RAX, FRAME_LINK_SIZE * 8);
+            as.cmp64(R::RAX, REG_STACK_LIMIT);
+            as.jcc(X86_COND_ENUM::A, overflow_label);
+            as.movImm32(R::RAX, pc + 1);
+            as.movStore(X86Mem(REG_SP), R::RAX);
+            as.movStore(X86Mem(REG_SP, 8), REG_FP);
+            as.mov64(REG_FP, REG_SP);
+            as.addImm64(REG_FP, FRAME_LINK_SIZE * 8);
+            as.mov64(REG_SP, REG_FP);
+            _jumpTo(ins.res, pc);
+            break;
+        case INTER_CODE_OP_ENUM::RET:
+            as.movLoad(R::RAX, X86Mem(REG_FP, -16));
+            as.mov64(REG_SP, REG_FP);
+            as.subImm64(REG_SP, int32_t((FRAME_LINK_SIZE + ins.res.value.i) * 8));
+            as.movLoad(REG_FP, X86Mem(REG_FP, -8));
+            _dispatch();
+            break;
+        case INTER_CODE_OP_ENUM::ENTER:
+            as.mov64(R::RAX, REG_FP);
+            as.addImm64(R::RAX, int32_t(ins.res.value.i * 8));
+            as.cmp64(R::RAX, REG_STACK_LIMIT);
+            as.jcc(X86_COND_ENUM::A, overflow_label);
+            as.mov64(REG_SP, R::RAX);
+            break;
+        case INTER_CODE_OP_ENUM::HALT:
+            as.jmp(exit_label);
+            break;
+        default:
+            break;
+    }
+}
+
+
+/**
+ * @brief 把操作数按位读进通用寄存器，变址寻址会用到 r11
+ */
+void X86Lowering::_loadInt(X86_REG_ENUM reg, const Operand & operand, int pc) {
+    switch (operand.kind) {
+        case OPERAND_KIND_ENUM::VAR:
+        case OPERAND_KIND_ENUM::VAR_INDEXED:
+        case OPERAND_KIND_ENUM::LOCAL:
+        case OPERAND_KIND_ENUM::LOCAL_INDEXED:
+            as.movLoad(reg, _address(operand, pc));
+            break;
+        case OPERAND_KIND_ENUM::PC:
+            as.movImm64(reg, uint64_t(pc + operand.slot));
+            break;
+        default:
+            as.movImm64(reg, uint64_t(operand.value.i));
+            break;
+    }
+}
+
+
+/**
+ * @brief 把浮点操作数读进 xmm，立即数经过 rax
+ */
+void X86Lowering::_loadDouble(int xmm, const Operand & operand, int pc) {
+    if (_isMemory(operand)) {
+        as.movsdLoad(xmm, _address(operand, pc));
+        return;
+    }
+
+    _loadInt(R::RAX, operand, pc);
+    as.movqToXmm(xmm, R::RAX);
+}
+
+
+/**
+ * @brief 操作数在不在内存里
+ */
+bool X86Lowering::_isMemory(const Operand & operand) {
+    return operand.kind == OPERAND_KIND_ENUM::VAR || operand.kind == OPERAND_KIND_ENUM::VAR_INDEXED ||
+           operand.kind == OPERAND_KIND_ENUM::LOCAL || operand.kind == OPERAND_KIND_ENUM::LOCAL_INDEXED;
+}
+
+
+/**
+ * @brief 寄存器的内存地址，全局变量相对 rbx，局部变量相对 rbp
+ * 变址寻址把地址算到 r11 里，全局变量越出 [旧格式临时变量, 栈底)、局部变量越出 [rbp, 栈顶) 就报错
+ */
+X86Mem X86Lowering::_address(const Operand & operand, int pc) {
+    bool local = operand.kind == OPERAND_KIND_ENUM::LOCAL || operand.kind == OPERAND_KIND_ENUM::LOCAL_INDEXED;
+    R reg = local ? REG_FP : REG_BASE;
+
+    if (operand.kind == OPERAND_KIND_ENUM::LOCAL_INDEXED) {
+        _loadInt(REG_INDEX, program.getIndexPool()[operand.index], pc);
+        as.lea(REG_INDEX, X86Mem(reg, operand.slot * 8, REG_INDEX, 8));
+        as.cmp64(REG_INDEX, REG_SP);
+        as.jcc(X86_COND_ENUM::AE, index_label);
+        as.cmp64(REG_INDEX, REG_FP);
+        as.jcc(X86_COND_ENUM::B, index_label);
+        return X86Mem(REG_INDEX);
+    }
+
+    if (operand.kind == OPERAND_KIND_ENUM::VAR_INDEXED) {
+        _loadInt(REG_INDEX, program.getIndexPool()[operand.index], pc);
+        as.lea(REG_INDEX, X86Mem(reg, operand.slot * 8, REG_INDEX, 8));
+        as.cmp64(REG_INDEX, REG_STACK_BOTTOM);
+        as.jcc(X86_COND_ENUM::AE, index_label);
+        if (program.getTSize() > 0) {
+            as.lea(REG_LOW, X86Mem(REG_BASE, -program.getTSize() * 8));
+            as.cmp64(REG_INDEX, REG_LOW);
+        }
+        else
+            as.cmp64(REG_INDEX, REG_BASE);
+        as.jcc(X86_COND_ENUM::B, index_label);
+        return X86Mem(REG_INDEX);
+    }
+
+    return X86Mem(reg, operand.slot * 8);
+}
+
+
+/**
+ * @brief 跳转目标能否在编译时确定
+ * @param target 确定的话写入目标 pc，越界的落到哨兵上
+ */
+bool X86Lowering::_staticTarget(const Operand & operand, int pc, int & target) {
+    if (_isMemory(operand))
+        return false;
+
+    int64_t halt_index = int64_t(program.getCodeSize()) - 1;
+    int64_t t = operand.kind == OPERAND_KIND_ENUM::PC ? pc + operand.slot : operand.value.i;
+    target = int((t < 0 || t > halt_index) ? halt_index : t);
+
+    return true;
+}
+
+
+/**
+ * @brief 无条件跳转，目标在寄存器里的查跳转表
+ */
+void X86Lowering::_jumpTo(const Operand & operand, int pc) {
+    int target;
+    if (_staticTarget(operand, pc, target)) {
+        as.jmp(pc_labels[target]);
+        return;
+    }
+
+    _loadInt(R::RAX, operand, pc);
+    _dispatch();
+}
+
+
+/**
+ * @brief 跳到 rax 里的 pc，越界的落到哨兵上
+ */
+void X86Lowering::_dispatch() {
+    int halt_index = program.getCodeSize() - 1;
+    int in_range = as.newLabel();
+
+    // 无符号比较，负数也算越界
+    as.cmpImm64(R::RAX, halt_index);
+    as.jcc(X86_COND_ENUM::BE, in_range);
+    as.movImm32(R::RAX, halt_index);
+    as.bind(in_range);
+    as.jmpMem(X86Mem(REG_TABLE, 0, R::RAX, 8));
+}
+
+
+/**
+ * @brief 条件跳转
+ */
+void X86Lowering::_branch(const Instruction & ins, int pc) {
+    int target, dest;
+    bool is_static = _staticTarget(ins.res, pc, target);
+    dest = is_static ? pc_labels[target] : as.newLabel();
+
+    switch (ins.op) {
+        case INTER_CODE_OP_ENUM::JE:
+        case INTER_CODE_OP_ENUM::JNE:
+        case INTER_CODE_OP_ENUM::JL:
+        case INTER_CODE_OP_ENUM::JG:
+            _loadInt(R::RAX, ins.arg1, pc);
+            _loadInt(R::RCX, ins.arg2, pc);
+            as.cmp64(R::RAX, R::RCX);
+            if (ins.op == INTER_CODE_OP_ENUM::JE)
+                as.jcc(X86_COND_ENUM::E, dest);
+            else if (ins.op == INTER_CODE_OP_ENUM::JNE)
+                as.jcc(X86_COND_ENUM::NE, dest);
+            else if (ins.op == INTER_CODE_OP_ENUM::JL)
+                as.jcc(X86_COND_ENUM::L, dest);
+            else
+                as.jcc(X86_COND_ENUM::G, dest);
+            break;
+        case INTER_CODE_OP_ENUM::FJE: {
+            // 无序 (NaN) 不相等
+            int skip = as.newLabel();
+            _loadDouble(0, ins.arg1, pc);
+            _loadDouble(1, ins.arg2, pc);
+            as.ucomisd(0, 1);
+            as.jcc(X86_COND_ENUM::P, skip);
+            as.jcc(X86_COND_ENUM::E, dest);
+            as.bind(skip);
+            break;
+        }
+        case INTER_CODE_OP_ENUM::FJNE:
+            _loadDouble(0, ins.arg1, pc);
+            _loadDouble(1, ins.arg2, pc);
+            as.ucomisd(0, 1);
+            as.jcc(X86_COND_ENUM::P, dest);
+            as.jcc(X86_COND_ENUM::NE, dest);
+            break;
+        case INTER_CODE_OP_ENUM::FJL:
+            _loadDouble(0, ins.arg1, pc);
+            _loadDouble(1, ins.arg2, pc);
+            as.ucomisd(1, 0);
+            as.jcc(X86_COND_ENUM::A, dest);
+            break;
+        default:
+            _loadDouble(0, ins.arg1, pc);
+            _loadDouble(1, ins.arg2, pc);
+            as.ucomisd(0, 1);
+            as.jcc(X86_COND_ENUM::A, dest);
+            break;
+    }
+
+    if (! is_static) {
+        as.jmp(pc_labels[pc + 1]);
+        as.bind(dest);
+        _jumpTo(ins.res, pc);
+    }
+}
+
+
+/**
+ * @brief 调用运行时函数，第一个参数是序言里存下的 context，其余参数调用前已经放好
+ */
+void X86Lowering::_callRuntime(X86_RUNTIME_ENUM func) {
+    as.movLoad(R::RDI, X86Mem(R::RSP));
+    as.callRuntime(func);
+}
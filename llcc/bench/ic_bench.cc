@@ -0,0 +1,182 @@
+/**
+ * @file ic_bench.cc
+ * @brief 文本中间代码 (.ic) 读取的性能测试，输出 MB/s、每秒行数和最大常驻内存
+ *
+ * 用法:
+ *      ic_bench generate <文件> <行数>   生成这么多行的中间代码文件，1.35 亿行大约 2GB
+ *      ic_bench parse <文件> [遍数]      只用 InterCodeReader 解析，内存和文件大小无关
+ *      ic_bench decode <文件> [遍数]     解析并预解码、校验成 Program，指令都留在内存里，别用太大的文件
+ */
+
+#include "../lib/include/inter_code_reader.h"
+#include "../lib/include/quadruple.h"
+#include "../back-end/include/program.h"
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+using std::string;
+
+// 生成的程序用的全局变量个数
+#define BENCH_GLOBALS 64
+// 跳转目标取这个数的整数倍，驻留表里的操作数个数不随文件变大
+#define BENCH_TARGET_STEP 4096
+
+
+/**
+ * @brief 最大常驻内存 (MB)，不支持时是 0
+ */
+static double maxResidentMB() {
+#if defined(__unix__) || defined(__APPLE__)
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+#ifdef __APPLE__
+    return double(usage.ru_maxrss) / (1024 * 1024);
+#else
+    return double(usage.ru_maxrss) / 1024;
+#endif
+#else
+    return 0;
+#endif
+}
+
+
+/**
+ * @brief 生成的第 i 行，模仿编译器的输出: 算术、变址寻址、浮点、条件和无条件跳转、带转义逗号的字符串
+ */
+static int generateLine(char * line, size_t size, long long i, long long lines) {
+    // 只往后跳，生成的程序一定能跑完
+    long long target = (i / BENCH_TARGET_STEP + 1) * BENCH_TARGET_STEP;
+    // v0 ~ v7 只当下标用，从不写，一直是 0；其余的随便算
+    int x = int(i % 8), a = 8 + int(i % (BENCH_GLOBALS - 8)), b = 8 + int((i * 7) % (BENCH_GLOBALS - 11));
+    int c = 8 + int((i * 13) % (BENCH_GLOBALS - 8));
+
+    switch (i % 8) {
+        case 0:
+            return snprintf(line, size, "ADD,v%d,%lld,v%d\n", a, i % 1000, c);
+        case 1:
+            return snprintf(line, size, "MOV,v%d,,v8[v%d]\n", b, x);
+        case 2:
+            return snprintf(line, size, "MUL,v%d,v%d,v%d\n", a, b, c);
+        case 3:
+            return snprintf(line, size, "FADD,v%d,2.5,v%d\n", a, b);
+        case 4:
+            return snprintf(line, size, "JL,v%d,v%d,%lld\n", a, b, target < lines ? target : lines);
+        case 5:
+            return snprintf(line, size, "SUB,v%d[3],1,v%d\n", b, c);
+        case 6:
+            return snprintf(line, size, "PRINT,\"a\\, b\",,\n");
+        default:
+            return snprintf(line, size, "J,,,%lld\n", target < lines ? target : lines);
+    }
+}
+
+
+/**
+ * @brief 生成中间代码文件，pc 0 是 ENTER，跳转目标都在代码里，可以通过校验，也能用 llcc -i 跑
+ */
+static int generate(const char * path, long long lines) {
+    FILE * f = fopen(path, "wb");
+    if (! f) {
+        printf("cannot open `%s` for writing\n", path);
+        return 1;
+    }
+
+    // 先攒满一块再写，不逐行 fwrite
+    string chunk;
+    chunk.reserve(1 << 20);
+    chunk += "ENTER,,," + std::to_string(BENCH_GLOBALS) + "\n";
+
+    char line[64];
+    for (long long i = 1; i < lines; i ++) {
+        chunk.append(line, generateLine(line, sizeof(line), i, lines));
+        if (chunk.size() >= (1 << 20) - sizeof(line)) {
+            fwrite(chunk.data(), 1, chunk.size(), f);
+            chunk.clear();
+        }
+    }
+    chunk += "\n";
+    fwrite(chunk.data(), 1, chunk.size(), f);
+
+    bool ok = ! ferror(f);
+    if (fclose(f) != 0 || ! ok) {
+        printf("cannot write `%s`\n", path);
+        return 1;
+    }
+
+    printf("%s, %lld lines\n", path, lines);
+    return 0;
+}
+
+
+/**
+ * @brief 解析 (decode 时还预解码、校验) 一遍，返回读到的四元式个数
+ */
+static long long readOnce(const char * path, bool decode) {
+    // 每遍的操作数文本随 scope 一起放掉，不会越积越多
+    OperandScope operands;
+    InterCodeReader reader;
+    if (! reader.open(path))
+        return -1;
+
+    if (decode) {
+        Program program;
+        program.load(reader);
+        return program.getCodeSize() - 1;
+    }
+
+    long long count = 0;
+    Quadruple q(INTER_CODE_OP_ENUM::HALT, "", "", "");
+    while (reader.next(q))
+        count ++;
+    return count;
+}
+
+
+int main(int argc, char * argv[]) {
+    if (argc >= 4 && strcmp(argv[1], "generate") == 0)
+        return generate(argv[2], std::max(1LL, atoll(argv[3])));
+
+    bool decode = argc >= 3 && strcmp(argv[1], "decode") == 0;
+    if (argc < 3 || (! decode && strcmp(argv[1], "parse") != 0)) {
+        printf("usage: %s generate <file> <lines>\n", argv[0]);
+        printf("       %s parse|decode <file> [rounds]\n", argv[0]);
+        return 1;
+    }
+
+    FILE * f = fopen(argv[2], "rb");
+    if (! f) {
+        printf("no file named `%s`\n", argv[2]);
+        return 1;
+    }
+    fseek(f, 0, SEEK_END);
+    double mb = double(ftell(f)) / (1024 * 1024);
+    fclose(f);
+    int rounds = argc > 3 ? std::max(1, atoi(argv[3])) : 3;
+
+    printf("%s, %.2f MB, %s, best of %d\n", argv[2], mb, argv[1], rounds);
+
+    double fastest = 0;
+    long long count = 0;
+    for (int i = 0; i < rounds; i ++) {
+        auto start = std::chrono::steady_clock::now();
+        count = readOnce(argv[2], decode);
+        std::chrono::duration<double> used = std::chrono::steady_clock::now() - start;
+
+        if (i == 0 || used.count() < fastest)
+            fastest = used.count();
+    }
+
+    printf("%10.3f s %10.1f MB/s %10.2f M lines/s %12lld quadruples %8.1f MB max RSS\n",
+           fastest, mb / fastest, double(count) / fastest / 1e6, count, maxResidentMB());
+    return 0;
+}
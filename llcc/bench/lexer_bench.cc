@@ -0,0 +1,56 @@
+/**
+ * @file lexer_bench.cc
+ * @brief 词法分析的性能测试，每种扫描实现各跑几遍，输出 MB/s
+ *
+ * 用法: lexer_bench <源文件> [遍数]
+ */
+
+#include "../front-end/include/lexical_analyzer.h"
+#include "../front-end/include/char_scanner.h"
+#include "../lib/include/source_file.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+
+int main(int argc, char * argv[]) {
+    if (argc < 2) {
+        printf("usage: %s <source file> [rounds]\n", argv[0]);
+        return 1;
+    }
+
+    SourceFile source;
+    if (! source.open(argv[1])) {
+        printf("no file named `%s`\n", argv[1]);
+        return 1;
+    }
+    int rounds = argc > 2 ? std::max(1, atoi(argv[2])) : 5;
+    double mb = double(source.size()) / (1024 * 1024);
+
+    printf("%s, %.2f MB, best of %d\n", argv[1], mb, rounds);
+
+    SCAN_LEVEL_ENUM best = CharScanner::detect();
+    for (SCAN_LEVEL_ENUM level: {SCAN_LEVEL_ENUM::SCALAR, SCAN_LEVEL_ENUM::SSE2, SCAN_LEVEL_ENUM::AVX2}) {
+        if (level > best)
+            break;
+        CharScanner::setLevel(level);
+
+        double fastest = 0;
+        size_t tokens = 0;
+        for (int i = 0; i < rounds; i ++) {
+            LexicalAnalyzer lexer;
+            auto start = std::chrono::steady_clock::now();
+            lexer.analyze(source.data(), source.size(), false);
+            std::chrono::duration<double> used = std::chrono::steady_clock::now() - start;
+
+            tokens = lexer.getAllTokens().size();
+            if (i == 0 || used.count() < fastest)
+                fastest = used.count();
+        }
+
+        printf("%-8s %10.1f MB/s %12zu tokens\n", CharScanner::levelName(level), mb / fastest, tokens);
+    }
+
+    return 0;
+}
@@ -0,0 +1,34 @@
+# 算出 llcc 源代码的哈希，写进 build_id.h，编译缓存的键里用它:
+# 改了任何一个源文件，旧的缓存就对不上，不用记着手动改版本号
+#
+# 用法: cmake -DSOURCE_DIR=<llcc 目录> -DOUTPUT=<build_id.h> -P build_id.cmake
+# 哈希没变时不碰 build_id.h，免得每次构建都重新编译 main.cc
+
+file(GLOB_RECURSE SOURCES
+        ${SOURCE_DIR}/*.h
+        ${SOURCE_DIR}/front-end/*.cc
+        ${SOURCE_DIR}/back-end/*.cc
+        ${SOURCE_DIR}/lib/*.cc
+        ${SOURCE_DIR}/main.cc
+)
+list(SORT SOURCES)
+
+set(DIGESTS "")
+foreach (SOURCE ${SOURCES})
+    file(RELATIVE_PATH NAME ${SOURCE_DIR} ${SOURCE})
+    # 构建目录放在源代码目录里时，里面的文件不算
+    if (NOT NAME MATCHES "^(front-end|back-end|lib)/" AND NAME MATCHES "/")
+        continue()
+    endif ()
+    file(SHA1 ${SOURCE} DIGEST)
+    set(DIGESTS "${DIGESTS}${NAME} ${DIGEST}\n")
+endforeach ()
+string(SHA1 BUILD_ID "${DIGESTS}")
+
+set(CONTENT "// 由 build_id.cmake 生成，不要手动修改\n#define LLCC_BUILD_ID \"${BUILD_ID}\"\n")
+if (EXISTS ${OUTPUT})
+    file(READ ${OUTPUT} OLD_CONTENT)
+endif ()
+if (NOT "${OLD_CONTENT}" STREQUAL "${CONTENT}")
+    file(WRITE ${OUTPUT} "${CONTENT}")
+endif ()
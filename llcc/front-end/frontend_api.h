@@ -17,10 +17,11 @@
  * @param path 代码文件路径
  */
 inline void lexer(string path) {
-    vector<string> source_file = readSourceFile(path);
+    SourceFile source_file;
+    openSourceFile(source_file, path);
 
     LexicalAnalyzer la;
-    la.analyze(source_file, true);
+    la.analyze(source_file.data(), source_file.size(), true);
 }
 
 
@@ -29,27 +30,68 @@ inline void lexer(string path) {
  * @param path 代码文件路径
  */
 inline void parser(string path) {
-    vector<string> source_file = readSourceFile(path);
+    SourceFile source_file;
+    openSourceFile(source_file, path);
 
-    SyntaxAnalyzer sa;
-    sa.analyze(source_file, true);
+    SyntaxTreeArena arena;
+    SyntaxAnalyzer sa(& arena);
+    sa.analyze(source_file.data(), source_file.size(), true);
 }
 
 
 /**
  * @brief 语义分析 & 中间代码生成，输出好看的中间代码，并生成.ic（inter code）文件
  * @param path 代码文件路径
+ * @param lines 不是空的时候，带回每条四元式的源代码行号
+ * @return 生成的四元式，操作数驻留在调用者的 OperandScope 里
  */
-inline void code_generator(string path, bool save = true) {
-    vector<string> source_file = readSourceFile(path);
+inline vector<Quadruple> code_generator(string path, bool save = true, vector<int> * lines = nullptr) {
+    SourceFile source_file;
+    openSourceFile(source_file, path);
 
-    SyntaxAnalyzer sa;
-    sa.analyze(source_file, false);
+    SyntaxTreeArena arena;
+    SyntaxAnalyzer sa(& arena);
+    sa.analyze(source_file.data(), source_file.size(), false);
 
+    // 生成完中间代码语法树就没用了，节点一起释放
     InterCodeGenerator icg;
     icg.analyze(sa.getSyntaxTree(), false);
+    arena.release();
     if (save)
         icg.saveToFile(path + ".ic");
+    if (lines)
+        * lines = icg.getLines();
+
+    return icg.getInterCode();
+}
+
+
+/**
+ * @brief 单独编译一个源文件，生成可重定位目标文件 (.ico)，用 --link 和别的目标文件链接
+ * @param path 代码文件路径
+ * @param output 目标文件路径，默认是 path + ".ico"
+ */
+inline void object_generator(string path, string output = "") {
+    SourceFile source_file;
+    openSourceFile(source_file, path);
+    if (output.empty())
+        output = path + ".ico";
+
+    OperandScope operands;
+    SyntaxTreeArena arena;
+    SyntaxAnalyzer sa(& arena);
+    sa.analyze(source_file.data(), source_file.size(), false);
+
+    InterCodeGenerator icg;
+    icg.analyze(sa.getSyntaxTree(), false, true);
+    arena.release();
+    if (! icg.saveObject(output)) {
+        cout << "File error" << endl;
+        cout << "cannot open `" << output << "` for writing" << endl;
+        exit(0);
+    }
+
+    cout << "object saved to " << output << endl;
 }
 
 
@@ -0,0 +1,73 @@
+/**
+ * @file char_scanner.h
+ * @brief 词法分析用的批量扫描: 一次判断 16 (SSE2) / 32 (AVX2) 个字符，跳过空白、注释、标识符、数字和字符串
+ *
+ * 按 CPU 支持的指令集选实现，不支持的平台用逐个字符的版本，结果完全一样
+ * AVX2 的实现单独用 -mavx2 编译，这个头文件不要引入标准库，免得它的内联函数带上 AVX2 指令被别处链接到
+ */
+
+#ifndef LLCC_CHAR_SCANNER_H
+#define LLCC_CHAR_SCANNER_H
+
+
+enum class SCAN_LEVEL_ENUM {
+    SCALAR, // 逐个字符
+    SSE2,   // 16 字节一组
+    AVX2    // 32 字节一组
+};
+
+
+/**
+ * @brief 一套扫描函数，每个返回第一个不属于这一段的字符的位置，没有就返回 end
+ */
+struct ScanKernels {
+    // 空白，newlines 加上跳过的换行数，last_newline 指向最后一个跳过的换行符
+    const char * (* skip_blank)(const char * p, const char * end, int & newlines, const char * & last_newline);
+    // 字母、数字和 _
+    const char * (* skip_identifier)(const char * p, const char * end);
+    // 数字和 .
+    const char * (* skip_number)(const char * p, const char * end);
+    // 注释的内容，停在 */ 的 * 上，newlines 和 last_newline 同上
+    const char * (* skip_comment)(const char * p, const char * end, int & newlines, const char * & last_newline);
+    // 字符串常量的内容，停在 quote 或者换行上
+    const char * (* skip_string)(const char * p, const char * end, char quote);
+};
+
+
+class CharScanner {
+private:
+    static SCAN_LEVEL_ENUM level;
+    static ScanKernels kernels;
+
+public:
+    static SCAN_LEVEL_ENUM detect();
+    static SCAN_LEVEL_ENUM getLevel();
+    static void setLevel(SCAN_LEVEL_ENUM _level);
+    static const char * levelName(SCAN_LEVEL_ENUM _level);
+
+    static const char * skipBlank(const char * p, const char * end, int & newlines, const char * & last_newline) {
+        return kernels.skip_blank(p, end, newlines, last_newline);
+    }
+    static const char * skipIdentifier(const char * p, const char * end) {
+        return kernels.skip_identifier(p, end);
+    }
+    static const char * skipNumber(const char * p, const char * end) {
+        return kernels.skip_number(p, end);
+    }
+    static const char * skipComment(const char * p, const char * end, int & newlines, const char * & last_newline) {
+        return kernels.skip_comment(p, end, newlines, last_newline);
+    }
+    static const char * skipString(const char * p, const char * end, char quote) {
+        return kernels.skip_string(p, end, quote);
+    }
+};
+
+
+// 各个指令集的实现，在 char_scanner*.cc 里
+extern const ScanKernels SCALAR_SCAN_KERNELS;
+extern const ScanKernels SSE2_SCAN_KERNELS;
+extern const ScanKernels AVX2_SCAN_KERNELS;
+extern const bool AVX2_SCAN_BUILT;
+
+
+#endif //LLCC_CHAR_SCANNER_H
@@ -10,28 +10,29 @@
 #include "../../lib/include/error.h"
 #include "../../lib/include/str_tools.h"
 #include "../../lib/include/quadruple.h"
+#include "../../lib/include/inter_code_writer.h"
 #include "../../lib/include/syntax_tree.h"
 
 #include <map>
+#include <deque>
+#include <algorithm>
 #include <stack>
-#include <regex>
 #include <string>
 #include <iomanip>
 #include <fstream>
 #include <iostream>
 
 using std::map;
+using std::deque;
 using std::cout;
 using std::move;
 using std::setw;
 using std::endl;
 using std::stack;
-using std::regex;
 using std::string;
 using std::setfill;
 using std::ostream;
 using std::ofstream;
-using std::regex_replace;
 
 
 enum class VARIABLE_INFO_ENUM {
@@ -57,10 +58,11 @@ public:
 class VarInfo: public Info {
 public:
     VARIABLE_INFO_ENUM type;
+    VARIABLE_INFO_ENUM item_type;   // 数组元素的类型
     int place;
 
     VarInfo();
-    VarInfo(VARIABLE_INFO_ENUM _type, int _place);
+    VarInfo(string _name, VARIABLE_INFO_ENUM _type, int _place, VARIABLE_INFO_ENUM _item_type = VARIABLE_INFO_ENUM::NONE);
 };
 
 
@@ -71,10 +73,22 @@ class FuncInfo: public Info {
 public:
     string name;
     VARIABLE_INFO_ENUM ret_type;
+    vector<VARIABLE_INFO_ENUM> param_types;
     int start_place, end_place;
 
     FuncInfo();
-    FuncInfo(string _name, VARIABLE_INFO_ENUM _ret_type, int _start_place, int _end_place);
+    FuncInfo(string _name, VARIABLE_INFO_ENUM _ret_type, int _start_place, int _end_place,
+             vector<VARIABLE_INFO_ENUM> _param_types = vector<VARIABLE_INFO_ENUM>());
+};
+
+
+/**
+ * @brief 语法树节点上翻译时才有的信息，按节点 id 存在生成器里
+ */
+class NodeInfo {
+public:
+    vector<int> true_list, false_list, next_list;   // 回填链
+    VARIABLE_INFO_ENUM type = VARIABLE_INFO_ENUM::INT; // 表达式的类型，_expression 之后才有
 };
 
 
@@ -84,8 +98,10 @@ public:
 class InterCodeGenerator {
 private:
     SyntaxTree * tree;                        // 语法树
-    int temp_var_index;                       // 临时变量栈顶
-    int var_index;                            // 用户的变量栈顶
+    const SyntaxTreeArena * arena;            // 语法树节点的文本存在这里
+    int var_index;                            // 变量栈顶，临时变量也从这里分配
+    int frame_size;                           // 变量栈用到的最大高度
+    int param_count;                          // 正在翻译的函数的参数个数，-1 表示在全局 / main 里
     int context_index;                        // 局部变量区分
 
 
@@ -93,11 +109,33 @@ private:
     map<string, FuncInfo> func_table;         // 函数表
     map<string, vector<int> > func_backpatch; // 函数表
     vector<Quadruple> inter_code;             // 生成的四元式
+    vector<int> lines;                        // 每条四元式来自源代码的哪一行，0 表示不知道
+    int cur_line;                             // 正在翻译的语句的行号
+
+    bool relocatable;                         // 生成可重定位目标文件: 可以没有 main，可以调用别的文件里的函数
+    bool has_main;                            // 有没有 main 函数
+    int global_end;                           // 全局代码 (全局变量初始化 + main) 的结尾，后面都是函数
+    vector<string> symbols;                   // 全局变量的符号表记录
+    vector<string> relocations;               // 外部函数调用的重定位记录
+    deque<NodeInfo> node_info;                // 下标是节点 id，deque 变长时已经拿到的引用不会失效
 
     void _analyze(SyntaxTreeNode * cur);
 
+    int _allocate(int size);
+    string _place(int index);
+    string _newTemp();
+
     string _lookUpVar(string name, SyntaxTreeNode * cur);
     string _lookUpVar(SyntaxTreeNode * arr_pointer);
+    VARIABLE_INFO_ENUM _lookUpType(SyntaxTreeNode * cur);
+
+    NodeInfo & _info(SyntaxTreeNode * cur);
+    VARIABLE_INFO_ENUM _typeOf(SyntaxTreeNode * cur);
+    void _setType(SyntaxTreeNode * cur, VARIABLE_INFO_ENUM type);
+    vector<VARIABLE_INFO_ENUM> _paramTypes(SyntaxTreeNode * param_tree);
+    static string _typeNames(const vector<VARIABLE_INFO_ENUM> & types);
+    void _globalSymbols(SyntaxTreeNode * cur);
+    string _convert(string place, VARIABLE_INFO_ENUM from, VARIABLE_INFO_ENUM to);
 
     void _emit(INTER_CODE_OP_ENUM op, string arg1, string arg2, string res);
 
@@ -117,8 +155,11 @@ private:
 
 public:
     InterCodeGenerator();
-    void analyze(SyntaxTree * _tree, bool verbose = false);
+    void analyze(SyntaxTree * _tree, bool verbose = false, bool _relocatable = false);
     void saveToFile(string path);
+    bool saveObject(string path);
+    const vector<Quadruple> & getInterCode();
+    const vector<int> & getLines();
 };
 
 
@@ -9,11 +9,17 @@
 #include "../../lib/include/token.h"
 #include "../../lib/include/error.h"
 #include "../../lib/include/str_tools.h"
+#include "char_scanner.h"
 
 #include <string>
 #include <vector>
 #include <iostream>
 #include <iomanip>
+#include <cstddef>
+#include <algorithm>
+#include <utility>
+#include <cstdint>
+#include <cstring>
 
 using std::string;
 using std::cout;
@@ -23,29 +29,28 @@ using std::vector;
 
 class LexicalAnalyzer {
 private:
-    vector<Token> tokens;                                        // 当前句子的token列表
-    vector<Token> all_tokens;                                    // 所有token
-    string sentence;                                             // 目前分析的句子
-    int len;                                                     // 目前在分析的句子的长度
-    bool in_comment;                                             // 现在是否在注释中的标识
-    int cur_pos;                                                 // 目前的位置
+    vector<Token> all_tokens;                                    // 所有token，用 next 取的时候只有还没取走的
+    size_t next_token;                                           // next 下一个取 all_tokens 里的哪个
+    const char * source;                                         // 整个源文件，不按行拷贝
+    size_t len;                                                  // 源文件的长度
+    size_t cur_pos;                                              // 目前的位置
+    size_t line_start;                                           // 目前这一行开头的位置
     int cur_line_number;                                         // 目前的行号
 
-    bool _isBlank();                                             // 判断是不是空白字符
     bool _isCommentStart();                                      // 判断是不是评论开始
-    bool _isCommentEnd();                                        // 判断是不是评论结束
-    bool _isKeyword(string word);                                // 判断是不是关键字
-    bool _isSeparator(char ch);                                  // 判断是不是分隔符
-    bool _isOperator(char ch);                                   // 判断是不是预算符
+    int _column(size_t at);                                      // 位置在这一行里是第几个字符
 
+    void _newLines(int newlines, const char * last_newline);     // 记下跳过的换行
     void _skipBlank();                                           // 跳过空白和注释
-    void _init(string _sentence);                                // 设置分析的句子
-    void _analyze();                                             // 进行词法分析
+    bool _scan();                                                // 读一个词
+    void _report(Error & e);                                     // 报告错误并退出
 
 public:
     LexicalAnalyzer();
-    vector<Token> getAllTokens();                                // 获得所有all_token
-    void analyze(vector<string> _sentences,bool verbose = true); // 词法分析
+    const vector<Token> & getAllTokens();                        // 获得所有all_token
+    void analyze(const char * _source, size_t length, bool verbose = true); // 词法分析
+    void start(const char * _source, size_t length);             // 开始按需取 token
+    bool next(Token & token);                                    // 取下一个 token
 };
 
 
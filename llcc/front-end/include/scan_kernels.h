@@ -0,0 +1,181 @@
+/**
+ * @file scan_kernels.h
+ * @brief CharScanner 各个实现共用的扫描循环，只给 char_scanner*.cc 用
+ *
+ * 循环写成模板，参数 B 是一种指令集上的块操作:
+ *      WIDTH                   一块的字节数
+ *      blank(p, newline)       空白字符的位掩码，newline 是换行符的位掩码
+ *      identifier(p)           字母、数字、_ 的位掩码
+ *      number(p)               数字、. 的位掩码
+ *      equal(p, ch)            等于 ch 的位掩码
+ *
+ * 每个 .cc 用自己的编译选项实例化，所以这里的东西都放在匿名命名空间里，不会在链接时混到一起
+ */
+
+#ifndef LLCC_SCAN_KERNELS_H
+#define LLCC_SCAN_KERNELS_H
+
+#include <cstdint>
+
+
+namespace {
+
+inline bool scanIsBlank(char ch) {
+    return ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n';
+}
+
+
+inline bool scanIsIdentifier(char ch) {
+    return ('a' <= ch && ch <= 'z') || ('A' <= ch && ch <= 'Z') || ('0' <= ch && ch <= '9') || ch == '_';
+}
+
+
+inline bool scanIsNumber(char ch) {
+    return ('0' <= ch && ch <= '9') || ch == '.';
+}
+
+
+/* 逐个字符的版本，也用来扫不满一块的结尾 */
+
+inline const char * scalarSkipBlank(const char * p, const char * end, int & newlines, const char * & last_newline) {
+    for (; p < end && scanIsBlank(* p); p ++)
+        if (* p == '\n') {
+            newlines ++;
+            last_newline = p;
+        }
+    return p;
+}
+
+
+inline const char * scalarSkipIdentifier(const char * p, const char * end) {
+    while (p < end && scanIsIdentifier(* p))
+        p ++;
+    return p;
+}
+
+
+inline const char * scalarSkipNumber(const char * p, const char * end) {
+    while (p < end && scanIsNumber(* p))
+        p ++;
+    return p;
+}
+
+
+inline const char * scalarSkipComment(const char * p, const char * end, int & newlines, const char * & last_newline) {
+    for (; p < end; p ++) {
+        if (* p == '*' && p + 1 < end && p[1] == '/')
+            return p;
+        if (* p == '\n') {
+            newlines ++;
+            last_newline = p;
+        }
+    }
+    return end;
+}
+
+
+inline const char * scalarSkipString(const char * p, const char * end, char quote) {
+    while (p < end && * p != quote && * p != '\n')
+        p ++;
+    return p;
+}
+
+
+#if defined(__GNUC__)
+
+/**
+ * @brief 记下块里 mask 标出的换行
+ */
+inline void scanNewlines(const char * p, uint32_t mask, int & newlines, const char * & last_newline) {
+    if (mask) {
+        newlines += __builtin_popcount(mask);
+        last_newline = p + 31 - __builtin_clz(mask);
+    }
+}
+
+
+/**
+ * @brief 第一个 stop 之前的位
+ */
+inline uint32_t scanBefore(uint32_t stop) {
+    return stop ? (stop & (0u - stop)) - 1 : 0xFFFFFFFFu;
+}
+
+
+template <class B>
+const char * blockSkipBlank(const char * p, const char * end, int & newlines, const char * & last_newline) {
+    while (end - p >= B::WIDTH) {
+        uint32_t newline;
+        uint32_t stop = ~B::blank(p, newline) & B::MASK;
+        scanNewlines(p, newline & scanBefore(stop), newlines, last_newline);
+        if (stop)
+            return p + __builtin_ctz(stop);
+        p += B::WIDTH;
+    }
+    return scalarSkipBlank(p, end, newlines, last_newline);
+}
+
+
+template <class B>
+const char * blockSkipIdentifier(const char * p, const char * end) {
+    while (end - p >= B::WIDTH) {
+        uint32_t stop = ~B::identifier(p) & B::MASK;
+        if (stop)
+            return p + __builtin_ctz(stop);
+        p += B::WIDTH;
+    }
+    return scalarSkipIdentifier(p, end);
+}
+
+
+template <class B>
+const char * blockSkipNumber(const char * p, const char * end) {
+    while (end - p >= B::WIDTH) {
+        uint32_t stop = ~B::number(p) & B::MASK;
+        if (stop)
+            return p + __builtin_ctz(stop);
+        p += B::WIDTH;
+    }
+    return scalarSkipNumber(p, end);
+}
+
+
+template <class B>
+const char * blockSkipComment(const char * p, const char * end, int & newlines, const char * & last_newline) {
+    while (end - p >= B::WIDTH) {
+        uint32_t star = B::equal(p, '*');
+        uint32_t newline = B::equal(p, '\n');
+        if (! star) {
+            scanNewlines(p, newline, newlines, last_newline);
+            p += B::WIDTH;
+            continue;
+        }
+
+        // 只是个 *，从它后面接着找
+        int at = __builtin_ctz(star);
+        scanNewlines(p, newline & scanBefore(star), newlines, last_newline);
+        if (p + at + 1 < end && p[at + 1] == '/')
+            return p + at;
+        p += at + 1;
+    }
+    return scalarSkipComment(p, end, newlines, last_newline);
+}
+
+
+template <class B>
+const char * blockSkipString(const char * p, const char * end, char quote) {
+    while (end - p >= B::WIDTH) {
+        uint32_t stop = B::equal(p, quote) | B::equal(p, '\n');
+        if (stop)
+            return p + __builtin_ctz(stop);
+        p += B::WIDTH;
+    }
+    return scalarSkipString(p, end, quote);
+}
+
+#endif
+
+}
+
+
+#endif //LLCC_SCAN_KERNELS_H
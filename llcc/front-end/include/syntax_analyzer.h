@@ -9,6 +9,7 @@
 #include "../../lib/include/error.h"
 #include "../../lib/include/syntax_tree.h"
 #include "../include/lexical_analyzer.h"
+#include "../include/token_window.h"
 
 #include <stack>
 #include <iostream>
@@ -33,10 +34,13 @@ enum class SENTENCE_PATTERN_ENUM {
 
 class SyntaxAnalyzer {
 private:
-    int index, len;
-    vector<Token> tokens;
+    int index;
+    TokenWindow tokens;                            // 按需从词法分析器取的 token
+    const char * text;                             // 源文件，Token 的值从这里取
     SyntaxTree * tree;
+    SyntaxTreeArena * arena;                       // 语法树的节点从这里分配
 
+    string _value(int i);                          // 第 i 个 Token 的值
     SENTENCE_PATTERN_ENUM _judgeSentencePattern(); // 判断句子种类
 
     void _analyze();
@@ -57,8 +61,8 @@ private:
     void _else_if(SyntaxTreeNode * father_node);
 
 public:
-    SyntaxAnalyzer();
-    void analyze(vector<string> sentences, bool verbose = true);
+    explicit SyntaxAnalyzer(SyntaxTreeArena * _arena);
+    void analyze(const char * source, size_t length, bool verbose = true);
     SyntaxTree * getSyntaxTree();
 };
 
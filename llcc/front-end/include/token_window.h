@@ -0,0 +1,39 @@
+/**
+ * @file token_window.h
+ * @brief 语法分析看的 token 窗口，按需从词法分析器里取，看过的语句放掉，不用把整个文件的 token 都存下来
+ */
+
+#ifndef LLCC_TOKEN_WINDOW_H
+#define LLCC_TOKEN_WINDOW_H
+
+#include "../../lib/include/token.h"
+#include "../../lib/include/error.h"
+#include "lexical_analyzer.h"
+
+#include <deque>
+#include <cstddef>
+
+using std::deque;
+
+
+class TokenWindow {
+private:
+    LexicalAnalyzer * lexer;
+    deque<Token> window;     // 还留着的 token
+    int base;                // window 里第一个 token 的下标
+    bool finished;           // 词法分析器已经没有 token 了
+    Token end_token;         // 超出结尾的时候给的 token，类别是 NONE
+
+    bool _fill(int i);
+
+public:
+    TokenWindow();
+
+    void reset(LexicalAnalyzer * _lexer);
+    bool has(int i);                          // 下标 i 的 token 存不存在
+    const Token & operator [] (int i);        // 下标 i 的 token，超出结尾给类别是 NONE 的
+    void release(int before);                 // 放掉下标 before 之前的 token
+};
+
+
+#endif //LLCC_TOKEN_WINDOW_H
@@ -0,0 +1,141 @@
+/**
+ * @file char_scanner.cc
+ * @brief 批量扫描: 逐个字符和 SSE2 的实现，按 CPU 选实现
+ */
+
+#include "../include/char_scanner.h"
+#include "../include/scan_kernels.h"
+
+#include <algorithm>
+
+#if defined(__SSE2__) && defined(__GNUC__)
+#include <emmintrin.h>
+#define CHAR_SCANNER_SSE2
+#endif
+
+
+const ScanKernels SCALAR_SCAN_KERNELS = {
+        scalarSkipBlank,
+        scalarSkipIdentifier,
+        scalarSkipNumber,
+        scalarSkipComment,
+        scalarSkipString
+};
+
+
+#ifdef CHAR_SCANNER_SSE2
+
+/**
+ * @brief SSE2 上的块操作，见 scan_kernels.h
+ */
+struct Sse2Block {
+    static const int WIDTH = 16;
+    static const uint32_t MASK = 0xFFFF;
+
+    static __m128i load(const char * p) {
+        return _mm_loadu_si128((const __m128i *) p);
+    }
+
+    static uint32_t equal(const char * p, char ch) {
+        return uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(load(p), _mm_set1_epi8(ch))));
+    }
+
+    static uint32_t blank(const char * p, uint32_t & newline) {
+        __m128i v = load(p);
+        __m128i nl = _mm_cmpeq_epi8(v, _mm_set1_epi8('\n'));
+        __m128i other = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')),
+                                                  _mm_cmpeq_epi8(v, _mm_set1_epi8('\t'))),
+                                     _mm_cmpeq_epi8(v, _mm_set1_epi8('\r')));
+        newline = uint32_t(_mm_movemask_epi8(nl));
+        return uint32_t(_mm_movemask_epi8(_mm_or_si128(nl, other)));
+    }
+
+    // 只有有符号比较，平移到 -128 开始比较: c - lo + (-128) < -128 + 个数
+    static __m128i digit(__m128i v) {
+        return _mm_cmplt_epi8(_mm_add_epi8(v, _mm_set1_epi8(char(128 - '0'))), _mm_set1_epi8(char(-128 + 10)));
+    }
+
+    static uint32_t identifier(const char * p) {
+        __m128i v = load(p);
+        __m128i lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+        __m128i alpha = _mm_cmplt_epi8(_mm_add_epi8(lower, _mm_set1_epi8(char(128 - 'a'))),
+                                       _mm_set1_epi8(char(-128 + 26)));
+        __m128i under = _mm_cmpeq_epi8(v, _mm_set1_epi8('_'));
+        return uint32_t(_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(alpha, digit(v)), under)));
+    }
+
+    static uint32_t number(const char * p) {
+        __m128i v = load(p);
+        return uint32_t(_mm_movemask_epi8(_mm_or_si128(digit(v), _mm_cmpeq_epi8(v, _mm_set1_epi8('.')))));
+    }
+};
+
+
+const ScanKernels SSE2_SCAN_KERNELS = {
+        blockSkipBlank<Sse2Block>,
+        blockSkipIdentifier<Sse2Block>,
+        blockSkipNumber<Sse2Block>,
+        blockSkipComment<Sse2Block>,
+        blockSkipString<Sse2Block>
+};
+
+#else
+
+const ScanKernels SSE2_SCAN_KERNELS = SCALAR_SCAN_KERNELS;
+
+#endif
+
+
+SCAN_LEVEL_ENUM CharScanner::level = CharScanner::detect();
+ScanKernels CharScanner::kernels = CharScanner::detect() == SCAN_LEVEL_ENUM::AVX2 ? AVX2_SCAN_KERNELS :
+                                   CharScanner::detect() == SCAN_LEVEL_ENUM::SSE2 ? SSE2_SCAN_KERNELS :
+                                   SCALAR_SCAN_KERNELS;
+
+
+/**
+ * @brief 这台机器上最快的实现
+ */
+SCAN_LEVEL_ENUM CharScanner::detect() {
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    // 静态初始化的时候就会调用，要先初始化 CPU 信息
+    __builtin_cpu_init();
+    if (AVX2_SCAN_BUILT && __builtin_cpu_supports("avx2"))
+        return SCAN_LEVEL_ENUM::AVX2;
+#endif
+#ifdef CHAR_SCANNER_SSE2
+    return SCAN_LEVEL_ENUM::SSE2;
+#else
+    return SCAN_LEVEL_ENUM::SCALAR;
+#endif
+}
+
+
+SCAN_LEVEL_ENUM CharScanner::getLevel() {
+    return level;
+}
+
+
+/**
+ * @brief 换一种实现，比较性能的时候用，超过这台机器支持的按支持的算
+ */
+void CharScanner::setLevel(SCAN_LEVEL_ENUM _level) {
+    level = std::min(_level, detect());
+    if (level == SCAN_LEVEL_ENUM::AVX2)
+        kernels = AVX2_SCAN_KERNELS;
+    else if (level == SCAN_LEVEL_ENUM::SSE2)
+        kernels = SSE2_SCAN_KERNELS;
+    else
+        kernels = SCALAR_SCAN_KERNELS;
+}
+
+
+const char * CharScanner::levelName(SCAN_LEVEL_ENUM _level) {
+    switch (_level) {
+        case SCAN_LEVEL_ENUM::AVX2:
+            return "avx2";
+        case SCAN_LEVEL_ENUM::SSE2:
+            return "sse2";
+        default:
+            return "scalar";
+    }
+}
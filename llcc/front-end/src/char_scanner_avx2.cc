@@ -0,0 +1,84 @@
+/**
+ * @file char_scanner_avx2.cc
+ * @brief 批量扫描的 AVX2 实现，只有这个文件用 -mavx2 编译，运行时 CPU 支持才会选它
+ */
+
+#include "../include/char_scanner.h"
+#include "../include/scan_kernels.h"
+
+#if defined(__AVX2__) && defined(__GNUC__)
+
+#include <immintrin.h>
+
+
+/**
+ * @brief AVX2 上的块操作，见 scan_kernels.h
+ */
+struct Avx2Block {
+    static const int WIDTH = 32;
+    static const uint32_t MASK = 0xFFFFFFFFu;
+
+    static __m256i load(const char * p) {
+        return _mm256_loadu_si256((const __m256i *) p);
+    }
+
+    static uint32_t equal(const char * p, char ch) {
+        return uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(load(p), _mm256_set1_epi8(ch))));
+    }
+
+    static uint32_t blank(const char * p, uint32_t & newline) {
+        __m256i v = load(p);
+        __m256i nl = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n'));
+        __m256i other = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')),
+                                                        _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\t'))),
+                                        _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\r')));
+        newline = uint32_t(_mm256_movemask_epi8(nl));
+        return uint32_t(_mm256_movemask_epi8(_mm256_or_si256(nl, other)));
+    }
+
+    // 只有有符号比较 (大于)，平移到 -128 开始比较: -128 + 个数 > c - lo + (-128)
+    static __m256i digit(__m256i v) {
+        return _mm256_cmpgt_epi8(_mm256_set1_epi8(char(-128 + 10)),
+                                 _mm256_add_epi8(v, _mm256_set1_epi8(char(128 - '0'))));
+    }
+
+    static uint32_t identifier(const char * p) {
+        __m256i v = load(p);
+        __m256i lower = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+        __m256i alpha = _mm256_cmpgt_epi8(_mm256_set1_epi8(char(-128 + 26)),
+                                          _mm256_add_epi8(lower, _mm256_set1_epi8(char(128 - 'a'))));
+        __m256i under = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('_'));
+        return uint32_t(_mm256_movemask_epi8(_mm256_or_si256(_mm256_or_si256(alpha, digit(v)), under)));
+    }
+
+    static uint32_t number(const char * p) {
+        __m256i v = load(p);
+        return uint32_t(_mm256_movemask_epi8(_mm256_or_si256(digit(v), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('.')))));
+    }
+};
+
+
+const ScanKernels AVX2_SCAN_KERNELS = {
+        blockSkipBlank<Avx2Block>,
+        blockSkipIdentifier<Avx2Block>,
+        blockSkipNumber<Avx2Block>,
+        blockSkipComment<Avx2Block>,
+        blockSkipString<Avx2Block>
+};
+
+const bool AVX2_SCAN_BUILT = true;
+
+#else
+
+// 编译器不支持 AVX2，detect() 不会选它
+const ScanKernels AVX2_SCAN_KERNELS = {
+        scalarSkipBlank,
+        scalarSkipIdentifier,
+        scalarSkipNumber,
+        scalarSkipComment,
+        scalarSkipString
+};
+
+const bool AVX2_SCAN_BUILT = false;
+
+#endif
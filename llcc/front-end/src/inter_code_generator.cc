@@ -4,6 +4,9 @@
  */
 
 #include "../include/inter_code_generator.h"
+
+#include <cctype>
+
 #define POS(cur) cur->line_number, cur->pos
 
 
@@ -24,22 +27,27 @@ VarInfo::VarInfo() = default;
 
 /**
  * @brief VarInfo构造函数
- * @param _name 变量名字
+ * @param _name 变量在中间代码里的名字
  * @param _type 种类
+ * @param _place 在栈帧里的位置
+ * @param _item_type 数组元素的种类
  */
-VarInfo::VarInfo(VARIABLE_INFO_ENUM _type, int _place) {
-    name = "v" + int2string(_place);
+VarInfo::VarInfo(string _name, VARIABLE_INFO_ENUM _type, int _place, VARIABLE_INFO_ENUM _item_type) {
+    name = move(_name);
     place = _place;
     type = _type;
+    item_type = _item_type;
 }
 
 
 FuncInfo::FuncInfo() = default;
 
 
-FuncInfo::FuncInfo(string _name, VARIABLE_INFO_ENUM _ret_type, int _start_place, int _end_place) {
+FuncInfo::FuncInfo(string _name, VARIABLE_INFO_ENUM _ret_type, int _start_place, int _end_place,
+                   vector<VARIABLE_INFO_ENUM> _param_types) {
     name = move(_name);
     ret_type = _ret_type;
+    param_types = move(_param_types);
     start_place = _start_place;
     end_place = _end_place;
 }
@@ -54,15 +62,29 @@ InterCodeGenerator::InterCodeGenerator() = default;
 /**
  * @brief 中间代码生成
  * @param _tree SyntaxTree *
+ * @param _relocatable 生成可重定位目标文件，见 saveObject
  */
-void InterCodeGenerator::analyze(SyntaxTree * _tree, bool verbose) {
+void InterCodeGenerator::analyze(SyntaxTree * _tree, bool verbose, bool _relocatable) {
     inter_code.clear();
+    lines.clear();
+    cur_line = 0;
     var_index = 0;
-    temp_var_index = 0;
+    frame_size = 0;
+    param_count = -1;
     context_index = 0;
     func_backpatch.clear();
+    relocatable = _relocatable;
+    has_main = false;
+    global_end = 0;
+    symbols.clear();
+    relocations.clear();
+    node_info.clear();
 
     tree = _tree;
+    arena = tree -> arena;
+
+    // 第一条指令声明全局变量的个数，生成结束后回填
+    _emit(INTER_CODE_OP_ENUM::ENTER, "", "", "");
 
     try {
         _analyze(tree -> root -> first_son);
@@ -73,6 +95,8 @@ void InterCodeGenerator::analyze(SyntaxTree * _tree, bool verbose) {
         exit(0);
     }
 
+    inter_code[0].res = Quadruple::intern(int2string(frame_size));
+
     if (verbose) {
         int l = inter_code.size();
         cout << "Generated " << l << " inter codes" << endl;
@@ -85,51 +109,66 @@ void InterCodeGenerator::analyze(SyntaxTree * _tree, bool verbose) {
 
 
 void InterCodeGenerator::_analyze(SyntaxTreeNode * cur) {
-    SyntaxTreeNode * name_tree, * main_block;
+    SyntaxTreeNode * name_tree, * main_block = nullptr, * main_tree = nullptr;
     vector<SyntaxTreeNode *> funcs;
     string name, type;
 
     while (cur) {
-        temp_var_index = 0;
-        if (cur -> value == "FunctionStatement") {
-            name_tree = cur -> first_son -> right;
-            name = name_tree -> first_son -> value;
-
-            if (name == "main")
-                main_block = name_tree -> right -> right;
-            else {
-                type = cur -> first_son -> value;
+        switch (cur -> kind) {
+            case SYNTAX_NODE_ENUM::FUNCTION_STATEMENT:
+                name_tree = cur -> first_son -> right;
+                name = arena -> text(name_tree -> first_son -> value);
+
+                if (name == "main") {
+                    main_tree = cur;
+                    main_block = name_tree -> right -> right;
+                }
+                else {
+                    type = arena -> text(cur -> first_son -> value);
 
 
-                func_table[name] = FuncInfo(name, Info::VAR_INFO_MAP[type], 0, 0);
-                funcs.emplace_back(cur);
-            }
-        }
-        else if (cur -> value == "Statement") {
-            _statement(cur);
+                    func_table[name] = FuncInfo(name, Info::VAR_INFO_MAP[type], 0, 0, _paramTypes(name_tree -> right));
+                    funcs.emplace_back(cur);
+                }
+                break;
+            case SYNTAX_NODE_ENUM::STATEMENT:
+                cur_line = std::max(cur -> line_number, 0);
+                _statement(cur);
+                if (relocatable)
+                    _globalSymbols(cur);
+                break;
+            default:
+                throw Error("`" + arena -> name(cur) + "` is not allowed in a root of a class", POS(cur));
         }
-        else
-            throw Error("`" + cur -> value + "` is not allowed in a root of a class", POS(cur));
 
         cur = cur -> right;
     }
 
-    // main 函数直接执行
-    _block(main_block, false);
+    // main 函数直接执行，可重定位目标文件可以没有 main，全局代码执行完接着执行下一个文件的
+    int main_end = -1;
+    if (main_tree) {
+        has_main = true;
+        cur_line = std::max(main_tree -> line_number, 0);
+        _block(main_block, false);
 
-    int main_end = inter_code.size();
-    _emit(INTER_CODE_OP_ENUM::J, "", "", "");
+        main_end = inter_code.size();
+        _emit(INTER_CODE_OP_ENUM::J, "", "", "");
+    }
+    else if (! relocatable)
+        throw Error("function `main` is not defined");
+    global_end = inter_code.size();
 
     // 翻译别的函数
     for (auto func: funcs)
         _functionStatement(func);
 
     // main 结束就直接结束
-    inter_code[main_end].res = int2string(inter_code.size());
+    if (main_end >= 0)
+        inter_code[main_end].res = Quadruple::intern(int2string(inter_code.size()));
 
     for (auto it: func_backpatch)
         if (! it.second.empty()) {
-            string dest = int2string(func_table[it.first].start_place);
+            uint32_t dest = Quadruple::intern(int2string(func_table[it.first].start_place));
             for (auto i: it.second)
                 inter_code[i].res = dest;
         }
@@ -143,31 +182,48 @@ void InterCodeGenerator::_functionStatement(SyntaxTreeNode * cur) {
     param_tree = name_tree -> right;
     block_tree = param_tree -> right;
 
-    string func_name = name_tree -> first_son -> value;
+    string func_name = arena -> text(name_tree -> first_son -> value);
 
     int func_start = int(inter_code.size());
+    cur_line = std::max(cur -> line_number, 0);
 
-    // start
-    SyntaxTreeNode * ps = param_tree -> first_son;
-    while (ps) {
-        _statement(ps);
-        _emit(INTER_CODE_OP_ENUM::POP, "", "", table[ps -> first_son -> value].name);
-        ps = ps -> right;
+    // 函数有自己的栈帧，局部变量和临时变量从帧指针开始重新分配
+    int _pre_var_index = var_index, _pre_frame_size = frame_size, _pre_param_count = param_count;
+    map<string, VarInfo> pre_table = table;
+
+    vector<VARIABLE_INFO_ENUM> param_types = _paramTypes(param_tree);
+    var_index = 0;
+    frame_size = 0;
+    param_count = param_types.size();
+
+    // 帧大小翻译完函数体再回填
+    _emit(INTER_CODE_OP_ENUM::ENTER, "", "", "");
+
+    // 实参由调用者按顺序压栈，在两个链接字下面
+    int param_index = 0;
+    for (SyntaxTreeNode * ps = param_tree -> first_son; ps; ps = ps -> right) {
+        int place = param_index - param_count - FRAME_LINK_SIZE;
+        table[arena -> text(ps -> first_son -> value)] = VarInfo(_place(place), param_types[param_index], place);
+        param_index ++;
     }
+
     _block(block_tree);
 
-    string temp_place = "t" + int2string(temp_var_index ++);
     // 自动return
-    _emit(INTER_CODE_OP_ENUM::POP, "", "", temp_place);
-    _emit(INTER_CODE_OP_ENUM::J, "", "", temp_place);
+    _emit(INTER_CODE_OP_ENUM::RET, "", "", int2string(param_count));
 
-    // end
+    inter_code[func_start].res = Quadruple::intern(int2string(frame_size));
 
     int func_end = inter_code.size() - 1;
 
-    func_table[func_name] = FuncInfo(name_tree -> first_son -> value,
-                                              Info::VAR_INFO_MAP[type_tree -> first_son -> value],
-                                              func_start, func_end);
+    func_table[func_name] = FuncInfo(arena -> text(name_tree -> first_son -> value),
+                                              Info::VAR_INFO_MAP[arena -> text(type_tree -> first_son -> value)],
+                                              func_start, func_end, param_types);
+
+    var_index = _pre_var_index;
+    frame_size = _pre_frame_size;
+    param_count = _pre_param_count;
+    table = pre_table;
 }
 
 
@@ -175,46 +231,63 @@ void InterCodeGenerator::_functionStatement(SyntaxTreeNode * cur) {
  * @brief 翻译block
  */
 void InterCodeGenerator::_block(SyntaxTreeNode * cur, bool restore) {
-    int _pre_var_index = var_index;
+    int _pre_var_index = var_index, _pre_line = cur_line;
     map<string, VarInfo> pre_table = table;
 
     context_index ++;
 
     SyntaxTreeNode * cs = cur -> first_son;
-    cur ->  next_list = cs -> next_list;
+    NodeInfo & info = _info(cur);
+    info.next_list = _info(cs).next_list;
     while (cs) {
-        if (cs -> value == "Statement")
-            _statement(cs);
-        else if (cs -> value == "Assignment")
-            _assignment(cs);
-        else if (cs -> value == "Print")
-            _print(cs);
-        else if (cs -> value == "Control-If")
-            _if(cs);
-        else if (cs -> value == "Control-While")
-            _while(cs);
-        else if (cs -> value == "Block") {
-            _block(cs);
-            cur -> next_list = cs -> next_list;
+        // 语句里生成的四元式都算在语句开头那一行
+        if (cs -> line_number > 0)
+            cur_line = cs -> line_number;
+
+        switch (cs -> kind) {
+            case SYNTAX_NODE_ENUM::STATEMENT:
+                _statement(cs);
+                break;
+            case SYNTAX_NODE_ENUM::ASSIGNMENT:
+                _assignment(cs);
+                break;
+            case SYNTAX_NODE_ENUM::PRINT:
+                _print(cs);
+                break;
+            case SYNTAX_NODE_ENUM::CONTROL_IF:
+                _if(cs);
+                break;
+            case SYNTAX_NODE_ENUM::CONTROL_WHILE:
+                _while(cs);
+                break;
+            case SYNTAX_NODE_ENUM::BLOCK:
+                _block(cs);
+                info.next_list = _info(cs).next_list;
+                break;
+            case SYNTAX_NODE_ENUM::FUNCTION_CALL:
+                _functionCall(cs);
+                break;
+            case SYNTAX_NODE_ENUM::VOID_RETURN:
+                _voidReturn(cs);
+                break;
+            // TODO 其他
+            default:
+                cout << "Debug <<<" << arena -> name(cs) << endl;
         }
-        else if (cs -> value == "FunctionCall")
-            _functionCall(cs);
-        else if (cs -> value == "VoidReturn")
-            _voidReturn(cs);
-        // TODO 其他
-        else
-            cout << "Debug <<<" << cs -> value << endl;
 
         // 回填
-        _backpatch(cs -> next_list, inter_code.size());
+        _backpatch(_info(cs).next_list, inter_code.size());
 
         cs = cs -> right;
 
         // 回填
         if (cs)
-            cur -> next_list = cs -> next_list;
+            info.next_list = _info(cs).next_list;
     }
 
+    // 块后面的跳转之类算在外层语句上
+    cur_line = _pre_line;
+
     if (restore) {
         var_index = _pre_var_index;
         table = pre_table;
@@ -227,10 +300,11 @@ void InterCodeGenerator::_block(SyntaxTreeNode * cur, bool restore) {
  */
 void InterCodeGenerator::_if(SyntaxTreeNode * cur) {
     SyntaxTreeNode * cs = cur -> first_son, * pre = nullptr;
+    vector<int> & next_list = _info(cur).next_list;
     int m1_inst, m2_inst;
 
     while (cs) {
-        if (cs -> value == "Control-Condition") {
+        if (cs -> kind == SYNTAX_NODE_ENUM::CONTROL_CONDITION) {
             // 读取条件语句
             _expression(cs -> first_son);
             pre = cs -> first_son;
@@ -244,15 +318,15 @@ void InterCodeGenerator::_if(SyntaxTreeNode * cur) {
 
             // 只有if
             if (! cs -> right) {
-                _backpatch(pre -> true_list, m1_inst);
-                cur -> next_list.insert(cur -> next_list.end(), V(cs -> left -> first_son -> false_list));
-                cur -> next_list.insert(cur -> next_list.end(), V(cs -> next_list));
+                _backpatch(_info(pre).true_list, m1_inst);
+                next_list.insert(next_list.end(), V(_info(cs -> left -> first_son).false_list));
+                next_list.insert(next_list.end(), V(_info(cs).next_list));
             }
             else {
-                cur -> next_list.emplace_back(inter_code.size());
+                next_list.emplace_back(inter_code.size());
                 _emit(INTER_CODE_OP_ENUM::J, "", "", "");
 
-                cur -> next_list.insert(cur -> next_list.end(), V(cs -> next_list));
+                next_list.insert(next_list.end(), V(_info(cs).next_list));
             }
         }
         else {
@@ -260,10 +334,10 @@ void InterCodeGenerator::_if(SyntaxTreeNode * cur) {
             m2_inst = inter_code.size();
             _block(cs);
 
-            _backpatch(pre -> true_list, m1_inst);
-            _backpatch(pre -> false_list, m2_inst);
+            _backpatch(_info(pre).true_list, m1_inst);
+            _backpatch(_info(pre).false_list, m2_inst);
 
-            cur -> next_list.insert(cur -> next_list.end(), V(cs -> next_list));
+            next_list.insert(next_list.end(), V(_info(cs).next_list));
         }
 
         cs = cs -> right;
@@ -279,7 +353,10 @@ void InterCodeGenerator::_print(SyntaxTreeNode * cur) {
     string print_place;
     while (ps) {
         print_place = _expression(ps);
-        _emit(INTER_CODE_OP_ENUM::PRINT, print_place, "", "");
+        if (_typeOf(ps) == VARIABLE_INFO_ENUM::DOUBLE)
+            _emit(INTER_CODE_OP_ENUM::FPRINT, print_place, "", "");
+        else
+            _emit(INTER_CODE_OP_ENUM::PRINT, print_place, "", "");
 
         ps = ps -> right;
     }
@@ -296,12 +373,19 @@ void InterCodeGenerator::_assignment(SyntaxTreeNode * cur) {
     string r_value_place = _expression(cs -> right);
 
     string store_place;
-    if (cs -> value == "Expression-ArrayItem")
+    if (cs -> kind == SYNTAX_NODE_ENUM::EXPRESSION_ARRAY_ITEM)
         store_place = _lookUpVar(cs);
     else
-        store_place = _lookUpVar(cur -> first_son -> value, cur);
+        store_place = _lookUpVar(arena -> text(cur -> first_son -> value), cur);
 
-    _emit(INTER_CODE_OP_ENUM::MOV, r_value_place, "", store_place);
+    // 右值转换成左值的类型
+    VARIABLE_INFO_ENUM store_type = _lookUpType(cs);
+    r_value_place = _convert(r_value_place, _typeOf(cs -> right), store_type);
+
+    if (store_type == VARIABLE_INFO_ENUM::DOUBLE)
+        _emit(INTER_CODE_OP_ENUM::FMOV, r_value_place, "", store_place);
+    else
+        _emit(INTER_CODE_OP_ENUM::MOV, r_value_place, "", store_place);
 }
 
 
@@ -311,95 +395,126 @@ void InterCodeGenerator::_assignment(SyntaxTreeNode * cur) {
  * @return place, string
  */
 string InterCodeGenerator::_expression(SyntaxTreeNode * cur) {
-    // 双目运算符
-    if (cur -> value == "Expression-DoubleOp" || cur -> value == "Expression-Bool-DoubleOp") {
-        SyntaxTreeNode * a = cur -> first_son;
-        SyntaxTreeNode * op = a -> right;
-        SyntaxTreeNode * b = op -> right;
-        string a_place, b_place;
-
-
-        // 如果是数字运算的话
-        if (cur -> value == "Expression-DoubleOp") {
-            a_place = _expression(a);
-            b_place = _expression(b);
-
-            string temp_var_place = "t" + int2string(temp_var_index ++);
-            _emit(Quadruple::INTER_CODE_MAP[op -> first_son -> value], a_place, b_place, temp_var_place);
+    switch (cur -> kind) {
+        // 双目运算符，如果是数字运算的话
+        case SYNTAX_NODE_ENUM::EXPRESSION_DOUBLE_OP: {
+            SyntaxTreeNode * a = cur -> first_son;
+            SyntaxTreeNode * op = a -> right;
+            SyntaxTreeNode * b = op -> right;
+
+            string a_place = _expression(a);
+            string b_place = _expression(b);
+
+            // 有一边是浮点数就做浮点运算，取模只有整数的
+            INTER_CODE_OP_ENUM code_op = Quadruple::INTER_CODE_MAP[arena -> text(op -> first_son -> value)];
+            VARIABLE_INFO_ENUM type = VARIABLE_INFO_ENUM::INT;
+            if (code_op != INTER_CODE_OP_ENUM::MOD &&
+                (_typeOf(a) == VARIABLE_INFO_ENUM::DOUBLE || _typeOf(b) == VARIABLE_INFO_ENUM::DOUBLE))
+                type = VARIABLE_INFO_ENUM::DOUBLE;
+
+            a_place = _convert(a_place, _typeOf(a), type);
+            b_place = _convert(b_place, _typeOf(b), type);
+            if (type == VARIABLE_INFO_ENUM::DOUBLE)
+                code_op = Quadruple::FLOAT_INTER_CODE_MAP[code_op];
+
+            string temp_var_place = _newTemp();
+            _emit(code_op, a_place, b_place, temp_var_place);
+            _setType(cur, type);
 
             return temp_var_place;
         }
         // bool运算要考虑回填
-        else {
+        case SYNTAX_NODE_ENUM::EXPRESSION_BOOL_DOUBLE_OP: {
+            SyntaxTreeNode * a = cur -> first_son;
+            SyntaxTreeNode * op = a -> right;
+            SyntaxTreeNode * b = op -> right;
+            const string & op_text = arena -> text(op -> first_son -> value);
             string a_place, b_place;
-            if (op -> first_son -> value == "||") {
+
+            if (op_text == "||") {
                 a_place = _expression(a);
                 int m_inst = inter_code.size();
                 b_place = _expression(b);
 
-                _backpatch(a -> false_list, m_inst);
+                NodeInfo & info = _info(cur), & a_info = _info(a), & b_info = _info(b);
+                _backpatch(a_info.false_list, m_inst);
                 // update true_list
-                cur -> true_list.insert(cur -> true_list.end(), V(a -> true_list));
-                cur -> true_list.insert(cur -> true_list.end(), V(b -> true_list));
+                info.true_list.insert(info.true_list.end(), V(a_info.true_list));
+                info.true_list.insert(info.true_list.end(), V(b_info.true_list));
                 // update false_list
-                cur -> false_list = b -> false_list;
+                info.false_list = b_info.false_list;
             }
-            else if  (op -> first_son -> value == "&&") {
+            else if  (op_text == "&&") {
                 a_place = _expression(a);
                 int m_inst = inter_code.size();
                 b_place = _expression(b);
 
-                _backpatch(a -> true_list, m_inst);
+                NodeInfo & info = _info(cur), & a_info = _info(a), & b_info = _info(b);
+                _backpatch(a_info.true_list, m_inst);
                 // update true_list
-                cur -> true_list = b -> true_list;
+                info.true_list = b_info.true_list;
                 // update false_list
-                cur -> false_list.insert(cur -> false_list.end(), a -> false_list.begin(), a -> false_list.end());
-                cur -> false_list.insert(cur -> false_list.end(), b -> false_list.begin(), b -> false_list.end());
+                info.false_list.insert(info.false_list.end(), V(a_info.false_list));
+                info.false_list.insert(info.false_list.end(), V(b_info.false_list));
             }
             else {
                 a_place = _expression(a);
                 b_place = _expression(b);
 
-                cur -> true_list.emplace_back(inter_code.size());
-                _emit(Quadruple::INTER_CODE_MAP[op -> first_son -> value], a_place, b_place, "");
+                // 有一边是浮点数就按浮点数比较
+                INTER_CODE_OP_ENUM code_op = Quadruple::INTER_CODE_MAP[op_text];
+                if (_typeOf(a) == VARIABLE_INFO_ENUM::DOUBLE || _typeOf(b) == VARIABLE_INFO_ENUM::DOUBLE) {
+                    a_place = _convert(a_place, _typeOf(a), VARIABLE_INFO_ENUM::DOUBLE);
+                    b_place = _convert(b_place, _typeOf(b), VARIABLE_INFO_ENUM::DOUBLE);
+                    code_op = Quadruple::FLOAT_INTER_CODE_MAP[code_op];
+                }
+
+                NodeInfo & info = _info(cur);
+                info.true_list.emplace_back(inter_code.size());
+                _emit(code_op, a_place, b_place, "");
 
-                cur -> false_list.emplace_back(inter_code.size());
+                info.false_list.emplace_back(inter_code.size());
                 _emit(INTER_CODE_OP_ENUM::J, "", "", "");
             }
 
             return "";
         }
-    }
         // 单目运算符
-    else if (cur -> value == "Expression-UniOp") {
-        // TODO
-    }
-    else if (cur -> value == "Expression-Bool-UniOp") {
-        // TODO
-    }
+        case SYNTAX_NODE_ENUM::EXPRESSION_UNI_OP:
+        case SYNTAX_NODE_ENUM::EXPRESSION_BOOL_UNI_OP:
+            // TODO
+            break;
         // 常量
-    else if (cur -> value == "Expression-Constant"){
-        return cur -> first_son -> value;
-    }
+        case SYNTAX_NODE_ENUM::EXPRESSION_CONSTANT: {
+            const string & value = arena -> text(cur -> first_son -> value);
+            if (value.find('.') == string::npos)
+                _setType(cur, VARIABLE_INFO_ENUM::INT);
+            else
+                _setType(cur, VARIABLE_INFO_ENUM::DOUBLE);
+
+            return value;
+        }
         // 字符串常量
-    else if (cur -> value == "Expression-String") {
-        string temp = cur -> first_son -> value;
-        // 转义
-        temp = regex_replace(temp, regex(","), string("\\,"));
-        temp = regex_replace(temp, regex("\\\\"), string("\\\\"));
-
-        return temp;
-    }
+        case SYNTAX_NODE_ENUM::EXPRESSION_STRING:
+            // 逗号在保存成文本时才转义
+            return arena -> text(cur -> first_son -> value);
         // 变量
-    else if (cur -> value == "Expression-Variable") {
-        return _lookUpVar(cur -> first_son -> value, cur);
-    }
+        case SYNTAX_NODE_ENUM::EXPRESSION_VARIABLE: {
+            string place = _lookUpVar(arena -> text(cur -> first_son -> value), cur);
+            _setType(cur, _lookUpType(cur));
+            return place;
+        }
         // 数组项
-    else if (cur -> value == "Expression-ArrayItem") {
-        return _lookUpVar(cur);
+        case SYNTAX_NODE_ENUM::EXPRESSION_ARRAY_ITEM: {
+            string place = _lookUpVar(cur);
+            _setType(cur, _lookUpType(cur));
+            return place;
+        }
+        default:
+            break;
     }
 
-    cout << "debug >> " << cur -> value << endl;
+    cout << "debug >> " << arena -> name(cur) << endl;
     throw Error("How can you step into this place???", POS(cur));
 }
 
@@ -416,10 +531,10 @@ void InterCodeGenerator::_while(SyntaxTreeNode * cur) {
     SyntaxTreeNode * block_tree = cur -> first_son -> right;
     _block(block_tree);
 
-    _backpatch(block_tree -> next_list, m_inst1);
-    _backpatch(condition_tree -> true_list, m_inst2);
+    _backpatch(_info(block_tree).next_list, m_inst1);
+    _backpatch(_info(condition_tree).true_list, m_inst2);
 
-    cur -> next_list = condition_tree -> false_list;
+    _info(cur).next_list = _info(condition_tree).false_list;
     _emit(INTER_CODE_OP_ENUM::J, "", "", int2string(m_inst1));
 }
 
@@ -430,20 +545,22 @@ void InterCodeGenerator::_while(SyntaxTreeNode * cur) {
 void InterCodeGenerator::_statement(SyntaxTreeNode * cur) {
     SyntaxTreeNode * cs = cur -> first_son;
     while (cs) {
-        string type = cs -> type;
+        const string & type = arena -> text(cs -> type);
         if (type == "double" || type == "float") {
-            VarInfo info(VARIABLE_INFO_ENUM::DOUBLE, var_index ++);
-            table[cs -> value] = info;
+            int place = _allocate(1);
+            table[arena -> text(cs -> value)] = VarInfo(_place(place), VARIABLE_INFO_ENUM::DOUBLE, place);
         }
         else if (type == "int") {
-            VarInfo info(VARIABLE_INFO_ENUM::INT, var_index ++);
-            table[cs -> value] = info;
+            int place = _allocate(1);
+            table[arena -> text(cs -> value)] = VarInfo(_place(place), VARIABLE_INFO_ENUM::INT, place);
         }
         else if (type.size() > 6 && type.substr(0, 6) == "array-") {
-            VarInfo info(VARIABLE_INFO_ENUM::ARRAY, var_index ++);
-            table[cs -> value] = info;
+            VARIABLE_INFO_ENUM item_type = Info::VAR_INFO_MAP[type.substr(6)];
+            int place = _allocate(1);
+            VarInfo info(_place(place), VARIABLE_INFO_ENUM::ARRAY, place, item_type);
+            table[arena -> text(cs -> value)] = info;
 
-            string extra_info = cs -> extra_info;
+            const string & extra_info = arena -> text(cs -> extra_info);
             int extra_info_len = extra_info.size();
 
             int cur_i = 0;
@@ -453,7 +570,7 @@ void InterCodeGenerator::_statement(SyntaxTreeNode * cur) {
                 while (cur_i + len < extra_info_len && extra_info[cur_i + len] != '&')
                     len ++;
 
-                var_index += string2int(extra_info.substr(cur_i, len));
+                _allocate(string2int(extra_info.substr(cur_i, len)));
                 cur_i += len;
             }
             if (cur_i < extra_info_len && extra_info.substr(cur_i, 3) == "&v=") {
@@ -465,7 +582,8 @@ void InterCodeGenerator::_statement(SyntaxTreeNode * cur) {
                     while (cur_i + len < extra_info_len && extra_info[cur_i + len] != ',')
                         len ++;
 
-                    _emit(INTER_CODE_OP_ENUM::MOV,
+                    // 立即数在解码时按指令类型转换
+                    _emit(item_type == VARIABLE_INFO_ENUM::DOUBLE ? INTER_CODE_OP_ENUM::FMOV : INTER_CODE_OP_ENUM::MOV,
                           extra_info.substr(cur_i, len),
                           "",
                           info.name + "[" + int2string(arr_i) + "]");
@@ -493,34 +611,50 @@ void InterCodeGenerator::_functionCall(SyntaxTreeNode * cur) {
     map<string, VarInfo> pre_table = table;
 
 
-    string func_name = cur -> first_son -> first_son -> value;
-    if (func_table.find(func_name) == func_table.end())
-        throw Error("function `" + func_name + "` is not defined before use", POS(cur));
-
-    // TODO 返回地址
-    int temp_place = inter_code.size();
-    _emit(INTER_CODE_OP_ENUM::PUSH, "", "", "");
-
+    string func_name = arena -> text(cur -> first_son -> first_son -> value);
     SyntaxTreeNode * param = cur -> first_son -> right;
-    SyntaxTreeNode * ps = param -> first_son;
-    while (ps -> right) ps = ps -> right;
-
-    string param_place;
-    while (ps) {
-        param_place = _expression(ps -> first_son);
-        _emit(INTER_CODE_OP_ENUM::PUSH, "", "", param_place);
+    if (func_table.find(func_name) == func_table.end()) {
+        if (! relocatable)
+            throw Error("function `" + func_name + "` is not defined before use", POS(cur));
+
+        // 别的文件里的函数，不知道形参类型，实参原样压栈，链接时核对类型再回填地址
+        vector<VARIABLE_INFO_ENUM> arg_types;
+        for (SyntaxTreeNode * ps = param -> first_son; ps; ps = ps -> right) {
+            _emit(INTER_CODE_OP_ENUM::PUSH, "", "", _expression(ps -> first_son));
+            arg_types.emplace_back(_typeOf(ps -> first_son));
+        }
+        relocations.emplace_back("RELOC," + int2string(inter_code.size()) + ",CALL," + func_name + "," +
+                                 _typeNames(arg_types));
+        _emit(INTER_CODE_OP_ENUM::CALL, "", "", "");
 
-        ps = ps -> left;
+        var_index = _pre_var_index;
+        table = pre_table;
+        return;
     }
 
-    inter_code[temp_place].res = "pc+" + int2string(inter_code.size() - temp_place + 1);
+    const vector<VARIABLE_INFO_ENUM> & param_types = func_table[func_name].param_types;
+    int param_index = 0;
+    for (SyntaxTreeNode * ps = param -> first_son; ps; ps = ps -> right)
+        param_index ++;
+    if (param_index != int(param_types.size()))
+        throw Error("function `" + func_name + "` expects " + int2string(param_types.size()) +
+                    " arguments but " + int2string(param_index) + " were given", POS(cur));
+
+    // 实参按顺序压栈，转换成形参的类型，返回地址由 CALL 保存
+    param_index = 0;
+    for (SyntaxTreeNode * ps = param -> first_son; ps; ps = ps -> right) {
+        string param_place = _expression(ps -> first_son);
+        param_place = _convert(param_place, _typeOf(ps -> first_son), param_types[param_index]);
+        _emit(INTER_CODE_OP_ENUM::PUSH, "", "", param_place);
+        param_index ++;
+    }
 
     if (func_backpatch.find(func_name) == func_backpatch.end()) {
         vector<int> t;
         func_backpatch[func_name] = t;
     }
     func_backpatch[func_name].emplace_back(inter_code.size());
-    _emit(INTER_CODE_OP_ENUM::J, "", "", "");
+    _emit(INTER_CODE_OP_ENUM::CALL, "", "", "");
 
     // restore
     var_index = _pre_var_index;
@@ -547,13 +681,160 @@ string InterCodeGenerator::_lookUpVar(string name, SyntaxTreeNode * cur) {
  * @return code var
  */
 string InterCodeGenerator::_lookUpVar(SyntaxTreeNode * arr_pointer) {
-    string base = arr_pointer -> first_son -> value;
-    string index_place = _expression(arr_pointer -> first_son -> right -> first_son);
+    string base = arena -> text(arr_pointer -> first_son -> value);
+    SyntaxTreeNode * index_tree = arr_pointer -> first_son -> right -> first_son;
+    string index_place = _expression(index_tree);
+    // 下标只能是整数
+    index_place = _convert(index_place, _typeOf(index_tree), VARIABLE_INFO_ENUM::INT);
 
     return _lookUpVar(base, arr_pointer) + "[" + index_place + "]";
 }
 
 
+/**
+ * @brief 变量或数组项的类型
+ * @param cur Expression-Variable 或 Expression-ArrayItem 节点，也可以是赋值语句的左值
+ */
+VARIABLE_INFO_ENUM InterCodeGenerator::_lookUpType(SyntaxTreeNode * cur) {
+    const string & name = arena -> text(cur -> first_son ? cur -> first_son -> value : cur -> value);
+    if (table.find(name) == table.end())
+        throw Error("variable `" + name + "` is not defined before use", POS(cur));
+
+    VarInfo & info = table[name];
+    if (cur -> kind == SYNTAX_NODE_ENUM::EXPRESSION_ARRAY_ITEM)
+        return info.item_type;
+    if (info.type == VARIABLE_INFO_ENUM::DOUBLE)
+        return VARIABLE_INFO_ENUM::DOUBLE;
+
+    return VARIABLE_INFO_ENUM::INT;
+}
+
+
+/**
+ * @brief 表达式的类型，_expression 之后才有
+ */
+VARIABLE_INFO_ENUM InterCodeGenerator::_typeOf(SyntaxTreeNode * cur) {
+    return _info(cur).type;
+}
+
+
+/**
+ * @brief 记录表达式的类型
+ */
+void InterCodeGenerator::_setType(SyntaxTreeNode * cur, VARIABLE_INFO_ENUM type) {
+    _info(cur).type = type == VARIABLE_INFO_ENUM::DOUBLE ? VARIABLE_INFO_ENUM::DOUBLE : VARIABLE_INFO_ENUM::INT;
+}
+
+
+/**
+ * @brief 节点的回填链和类型，第一次用到时按 id 补出来
+ */
+NodeInfo & InterCodeGenerator::_info(SyntaxTreeNode * cur) {
+    if (cur -> id >= node_info.size())
+        node_info.resize(cur -> id + 1);
+    return node_info[cur -> id];
+}
+
+
+/**
+ * @brief 函数的形参类型
+ * @param param_tree ParameterList 节点
+ */
+vector<VARIABLE_INFO_ENUM> InterCodeGenerator::_paramTypes(SyntaxTreeNode * param_tree) {
+    vector<VARIABLE_INFO_ENUM> ret;
+    for (SyntaxTreeNode * ps = param_tree -> first_son; ps; ps = ps -> right)
+        ret.emplace_back(Info::VAR_INFO_MAP[arena -> text(ps -> first_son -> type)]);
+
+    return ret;
+}
+
+
+/**
+ * @brief 参数类型写进目标文件的样子: int;double，没有参数是空的
+ */
+string InterCodeGenerator::_typeNames(const vector<VARIABLE_INFO_ENUM> & types) {
+    string ret;
+    for (auto type: types) {
+        if (! ret.empty())
+            ret += ";";
+        ret += type == VARIABLE_INFO_ENUM::DOUBLE ? "double" : "int";
+    }
+    return ret;
+}
+
+
+/**
+ * @brief 记下全局变量声明的符号: 位置，占几个位置 (数组连同元素)，类型，有没有初值
+ */
+void InterCodeGenerator::_globalSymbols(SyntaxTreeNode * cur) {
+    for (SyntaxTreeNode * cs = cur -> first_son; cs; cs = cs -> right) {
+        int place = table[arena -> text(cs -> value)].place;
+        int next = cs -> right ? table[arena -> text(cs -> right -> value)].place : var_index;
+        bool initialized = arena -> text(cs -> extra_info).find("&v=") != string::npos;
+        symbols.emplace_back("DATA," + arena -> text(cs -> value) + "," + int2string(place) + "," +
+                             int2string(next - place) + "," + arena -> text(cs -> type) + "," +
+                             (initialized ? "1" : "0"));
+    }
+}
+
+
+/**
+ * @brief 类型转换，常量直接改写，其他的生成 ITOF / FTOI
+ * @return 转换后的 place
+ */
+string InterCodeGenerator::_convert(string place, VARIABLE_INFO_ENUM from, VARIABLE_INFO_ENUM to) {
+    if (from == to || place.empty() || place[0] == '\"')
+        return place;
+
+    // 常量
+    if (place[0] != 'v' && place[0] != 'l') {
+        if (to == VARIABLE_INFO_ENUM::DOUBLE)
+            return place.find('.') == string::npos ? place + ".0" : place;
+        // 和运行时的 FTOI 一样向零取整到 64 位
+        return std::to_string((long long) string2double(place));
+    }
+
+    string temp_var_place = _newTemp();
+    if (to == VARIABLE_INFO_ENUM::DOUBLE)
+        _emit(INTER_CODE_OP_ENUM::ITOF, place, "", temp_var_place);
+    else
+        _emit(INTER_CODE_OP_ENUM::FTOI, place, "", temp_var_place);
+
+    return temp_var_place;
+}
+
+
+/**
+ * @brief 在变量栈上分配连续的 size 个位置
+ * @return 第一个位置
+ */
+int InterCodeGenerator::_allocate(int size) {
+    int ret = var_index;
+    var_index += size;
+    if (var_index > frame_size)
+        frame_size = var_index;
+
+    return ret;
+}
+
+
+/**
+ * @brief 栈帧里第 index 个位置的名字，全局的是 v，函数里相对帧指针的是 l
+ */
+string InterCodeGenerator::_place(int index) {
+    return (param_count < 0 ? "v" : "l") + int2string(index);
+}
+
+
+/**
+ * @brief 分配一个临时变量，和普通变量共用一个栈帧
+ * @return place, string
+ */
+string InterCodeGenerator::_newTemp() {
+    return _place(_allocate(1));
+}
+
+
 /**
  * @brief 生成一个四元式
  * @param op 操作符
@@ -562,37 +843,100 @@ string InterCodeGenerator::_lookUpVar(SyntaxTreeNode * arr_pointer) {
  * @param res 结果
  */
 void InterCodeGenerator::_emit(INTER_CODE_OP_ENUM op, string arg1, string arg2, string res) {
-    inter_code.emplace_back(Quadruple(op, move(arg1), move(arg2), move(res)));
+    inter_code.emplace_back(Quadruple(op, arg1, arg2, res));
+    lines.emplace_back(cur_line);
+}
+
+
+/**
+ * @brief 返回生成的四元式
+ */
+const vector<Quadruple> & InterCodeGenerator::getInterCode() {
+    return inter_code;
 }
 
 
 /**
- * @brief 保存到文件
+ * @brief 返回每条四元式对应的源代码行号
+ */
+const vector<int> & InterCodeGenerator::getLines() {
+    return lines;
+}
+
+
+/**
+ * @brief 保存到文件，四元式后面空一行是行号表，每段连续同一行的代码记一条 LINE,pc,行号
  * @param 路径
  */
 void InterCodeGenerator::saveToFile(string path) {
-    ofstream out_file;
-    out_file.open(path, ofstream::out | ofstream::trunc);
-    for (auto ic: inter_code)
-        out_file << Quadruple::INTER_CODE_OP[int(ic.op)] << "," << ic.arg1 << "," << ic.arg2 << "," << ic.res << endl;
+    InterCodeWriter::save(path, inter_code, lines);
+}
 
-    out_file.close();
+
+/**
+ * @brief 保存成可重定位目标文件 (.ico)，用 llcc --link 链接成完整的程序
+ *
+ * 四元式和行号表和 .ic 一样，全局变量的 v 都是本文件数据区里的位置，跳转目标都是本文件里的 pc，
+ * 链接时重新排布。后面的记录:
+ *      OBJECT,版本
+ *      UNIT,全局代码结尾,有没有 main        pc 0 的 ENTER 之后到全局代码结尾是全局变量初始化和 main
+ *      FUNC,函数名,pc,参数类型;...          定义的函数
+ *      DATA,变量名,位置,大小,类型,有没有初值  全局变量，几个文件里同名同类型的是同一个变量
+ *      RELOC,pc,CODE                       res 是本文件里的 pc
+ *      RELOC,pc,CALL,函数名,实参类型;...     调用别的文件里的函数
+ * @return 能不能写
+ */
+bool InterCodeGenerator::saveObject(string path) {
+    vector<string> records;
+    records.emplace_back("OBJECT," + int2string(INTER_CODE_OBJECT_VERSION));
+    records.emplace_back("UNIT," + int2string(global_end) + "," + (has_main ? "1" : "0"));
+
+    for (auto & it: func_table)
+        records.emplace_back("FUNC," + it.first + "," + int2string(it.second.start_place) + "," +
+                             _typeNames(it.second.param_types));
+    records.insert(records.end(), V(symbols));
+
+    int l = inter_code.size();
+    for (int i = 0; i < l; i ++) {
+        switch (inter_code[i].op) {
+            case INTER_CODE_OP_ENUM::J:
+            case INTER_CODE_OP_ENUM::JE:
+            case INTER_CODE_OP_ENUM::JNE:
+            case INTER_CODE_OP_ENUM::JL:
+            case INTER_CODE_OP_ENUM::JG:
+            case INTER_CODE_OP_ENUM::FJE:
+            case INTER_CODE_OP_ENUM::FJNE:
+            case INTER_CODE_OP_ENUM::FJL:
+            case INTER_CODE_OP_ENUM::FJG:
+            case INTER_CODE_OP_ENUM::CALL: {
+                // 外部函数调用的 res 是空的，记在 relocations 里
+                const string & res = Quadruple::text(inter_code[i].res);
+                if (! res.empty() && isdigit(res[0]))
+                    records.emplace_back("RELOC," + int2string(i) + ",CODE");
+                break;
+            }
+            default:
+                break;
+        }
+    }
+    records.insert(records.end(), V(relocations));
+
+    return InterCodeWriter::save(path, inter_code, lines, records);
 }
 
 
 void InterCodeGenerator::_backpatch(vector<int> v, int dest_index) {
     for (auto i: v)
-        inter_code[i].res = int2string(dest_index);
+        inter_code[i].res = Quadruple::intern(int2string(dest_index));
 }
 
 
 void InterCodeGenerator::_voidReturn(SyntaxTreeNode * cur) {
-    SyntaxTreeNode * cf = cur;
-    while (cf && cf -> value != "FunctionStatement")
-        cf = cf -> father;
+    (void) cur;
 
-    string temp_place = "t" + int2string(temp_var_index ++);
-    // 自动return
-    _emit(INTER_CODE_OP_ENUM::POP, "", "", temp_place);
-    _emit(INTER_CODE_OP_ENUM::J, "", "", temp_place);
+    // main 里的 return 直接停机
+    if (param_count < 0)
+        _emit(INTER_CODE_OP_ENUM::HALT, "", "", "");
+    else
+        _emit(INTER_CODE_OP_ENUM::RET, "", "", int2string(param_count));
 }
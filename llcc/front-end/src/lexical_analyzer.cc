@@ -11,25 +11,12 @@
  * @brief LexicalAnalyzer类构造函数
  */
 LexicalAnalyzer::LexicalAnalyzer() {
-    in_comment = false;
+    source = "";
+    len = cur_pos = line_start = next_token = 0;
+    cur_line_number = 0;
 };
 
 
-/**
- * @brief 判断curPos处是否为空字符
- * @return
- *      -<em>true</em> 是空字符
- *      -<em>false</em> 不是空字符
- */
-bool LexicalAnalyzer::_isBlank() {
-    char cur_char = sentence[cur_pos];
-    return (cur_char == '\t' ||
-            cur_char == '\n' ||
-            cur_char == '\r' ||
-            cur_char == ' ');
-}
-
-
 /**
  * @brief 判断curPos处是是不是备注开始
  * @return
@@ -37,267 +24,243 @@ bool LexicalAnalyzer::_isBlank() {
  *      -<em>false</em> 不是
  */
 bool LexicalAnalyzer::_isCommentStart() {
-    return (sentence[cur_pos] == '/' &&
-            cur_pos + 1 < len &&
-            sentence[cur_pos + 1] == '*');
-}
-
-
-/**
- * @brief 判断curPos处是是不是备注结束
- * @return
- *      -<em>true</em> 是备注结束
- *      -<em>false</em> 不是
- */
-bool LexicalAnalyzer::_isCommentEnd() {
-    return (sentence[cur_pos] == '*' &&
+    return (source[cur_pos] == '/' &&
             cur_pos + 1 < len &&
-            sentence[cur_pos + 1] == '/');
+            source[cur_pos + 1] == '*');
 }
 
 
 /**
- * @brief 自增curPos直到不为空且不为注释中
+ * @brief 记下批量扫描跳过的换行
+ * @param newlines 跳过了几个换行
+ * @param last_newline 最后一个换行符，没有跳过换行是 nullptr
  */
-void LexicalAnalyzer::_skipBlank() {
-    while (cur_pos < len &&
-          (_isBlank() ||                      // 是空字符
-          (in_comment && ! _isCommentEnd()))) // 或者在评论里
-        cur_pos ++;
-
-    if (cur_pos < len && _isCommentEnd()) {   // 判断是不是评论的结束
-        in_comment = false;                   // 读取 `*/`
-        cur_pos += 2;
-
-        if (cur_pos < len)
-            _skipBlank(); // 读完注释后继续跳过
+void LexicalAnalyzer::_newLines(int newlines, const char * last_newline) {
+    if (last_newline) {
+        cur_line_number += newlines;
+        line_start = size_t(last_newline - source) + 1;
     }
 }
 
 
 /**
- * @brief 设置等待分析的句子，初始化
- * @param _sentence string, 等待分析的句子
+ * @brief 位置在所在行里的下标，报错和 Token 里用
  */
-void LexicalAnalyzer::_init(string _sentence) {
-    len = int(_sentence.length());
-    sentence = _sentence;
-
-    tokens.clear();
-    cur_pos = 0;
+int LexicalAnalyzer::_column(size_t at) {
+    return int(at - line_start);
 }
 
 
 /**
- * @brief 判断是否是关键词
- * @param word string, 等待分析的词
- * @return
- *      -<em>true</em> 是关键词
- *      -<em>false</em> 不是关键词
+ * @brief 自增curPos直到不为空且不在注释中，注释可以跨行
  */
-bool LexicalAnalyzer::_isKeyword(string word) {
-    for (string kw: Token::KEYWORDS)
-        if (kw == word)
-            return true;
+void LexicalAnalyzer::_skipBlank() {
+    const char * end = source + len;
 
-    return false;
+    while (cur_pos < len) {
+        int newlines = 0;
+        const char * last_newline = nullptr;
+        cur_pos = size_t(CharScanner::skipBlank(source + cur_pos, end, newlines, last_newline) - source);
+        _newLines(newlines, last_newline);
+
+        if (cur_pos >= len || ! _isCommentStart())
+            break;
+
+        // 读取 `/*`，没有结尾的注释一直到文件末尾
+        newlines = 0;
+        last_newline = nullptr;
+        cur_pos = size_t(CharScanner::skipComment(source + cur_pos + 2, end, newlines, last_newline) - source);
+        _newLines(newlines, last_newline);
+        cur_pos = std::min(cur_pos + 2, len);
+    }
 }
 
 
 /**
- * @brief 判断是否是分隔符
- * @param ch char, 等待分析的字符
- * @return
- *      -<em>true</em> 是分隔符
- *      -<em>false</em> 不是分隔符
+ * @brief 读下一个词，得到的 token 加在 all_tokens 后面，字符串常量一次是三个，不认识的字符跳过不产生 token
+ * @return 是否读到了东西，到文件结尾返回 false
  */
-bool LexicalAnalyzer::_isSeparator(char ch) {
-    for (char sp: Token::SEPARATORS)
-        if (sp == ch)
-            return true;
+bool LexicalAnalyzer::_scan() {
+    char cur_char;
 
-    return false;
-}
+    _skipBlank();
+    if (cur_pos >= len)
+        return false;
 
+    cur_char = source[cur_pos];
 
-/**
- * @brief 判断是否是运算符
- * @param ch char, 等待分析的字符
- * @return
- *      -<em>true</em> 是运算符
- *      -<em>false</em> 不是运算符
- */
-bool LexicalAnalyzer::_isOperator(char ch) {
-    for (auto o: Token::OPERATORS)
-        if (ch == o[0])
-            return true;
-
-    return false;
-}
+    // 关键字 和 标识符
+    if (isalpha(cur_char) || cur_char == '_') {
+        // 找结尾: 字母、数字、_
+        size_t temp_len = size_t(CharScanner::skipIdentifier(source + cur_pos, source + len) - source) - cur_pos;
 
+        // 截取 并 加入token列表
+        all_tokens.emplace_back(source, cur_pos, temp_len,
+                                Token::isKeyword(source + cur_pos, temp_len) ?
+                                TOKEN_TYPE_ENUM::KEYWORD : TOKEN_TYPE_ENUM::IDENTIFIER,
+                                _column(cur_pos), cur_line_number);
 
-/**
- * @brief 分析当前句子
- */
-void LexicalAnalyzer::_analyze() {
-    char cur_char;
+        cur_pos += temp_len;
+        return true;
+    }
+    // 数字常量
+    else if (isdigit(cur_char) || cur_char == '.') {
+        // 找结尾: 数字、.
+        size_t temp_len = size_t(CharScanner::skipNumber(source + cur_pos, source + len) - source) - cur_pos;
+
+        const char * dot = (const char *) memchr(source + cur_pos, '.', temp_len);
+        if (dot && memchr(dot + 1, '.', source + cur_pos + temp_len - dot - 1))
+            throw Error("in digit constant, too many dots in one number",
+                        cur_line_number, _column(cur_pos));
+
+        // 截取 并 加入token列表
+        all_tokens.emplace_back(source, cur_pos, temp_len, TOKEN_TYPE_ENUM::DIGIT_CONSTANT,
+                                _column(cur_pos), cur_line_number);
+
+        cur_pos += temp_len;
+        return true;
+    }
+    // 分隔符 和 字符串常量
+    else if (Token::isSeparator(cur_char)) {
+        // 先加入token列表
+        all_tokens.emplace_back(source, cur_pos, 1, TOKEN_TYPE_ENUM::SEPARATOR,
+                                _column(cur_pos), cur_line_number);
+
+        // 如果是 `'`或者`"` 需要考虑一下匹配，字符串常量不能跨行
+        size_t temp_len = 0;
+        if (cur_char == '\"' || cur_char == '\'') {
+            cur_pos ++;
 
-    while (cur_pos < len) {
-        _skipBlank();
+            temp_len = size_t(CharScanner::skipString(source + cur_pos, source + len, cur_char) - source) - cur_pos;
 
-        cur_char = sentence[cur_pos];
+            // 匹配不上
+            if (cur_pos + temp_len >= len || source[cur_pos + temp_len] != cur_char)
+                throw Error("in string constant, lack of " + char2string(cur_char),
+                            cur_line_number, _column(cur_pos));
 
-        // 处理注释
-        if (_isCommentStart()) {
-            in_comment = true;
-            cur_pos += 2;
-            continue;
-        }
-        // 关键字 和 标识符
-        else if (isalpha(cur_char) || cur_char == '_') {
-            // 找结尾
-            int temp_len = 0;
-            while (cur_pos + temp_len <= len &&
-                  (isalpha(sentence[cur_pos + temp_len]) || // 字母
-                   sentence[cur_pos + temp_len] == '_' ||   // _
-                   isdigit(sentence[cur_pos + temp_len])))  // 数字
-                temp_len ++;
-
-            // 截取 并 加入token列表
-            string temp_str = sentence.substr(cur_pos, temp_len);
-            tokens.emplace_back(Token(temp_str,
-                                      _isKeyword(temp_str) ? TOKEN_TYPE_ENUM::KEYWORD : TOKEN_TYPE_ENUM::IDENTIFIER,
-                                      cur_pos, cur_line_number));
+            all_tokens.emplace_back(source, cur_pos, temp_len, TOKEN_TYPE_ENUM::STRING_CONSTANT,
+                                    _column(cur_pos) + 1, cur_line_number);
 
             cur_pos += temp_len;
-            continue;
+            all_tokens.emplace_back(source, cur_pos, 1, TOKEN_TYPE_ENUM::SEPARATOR,
+                                    _column(cur_pos) + 1, cur_line_number);
         }
-        // 数字常量
-        else if (isdigit(cur_char) || cur_char == '.') {
-            // 找结尾
-            int temp_len = 0;
-            bool hasDot = false;
-            while (cur_pos + temp_len <= len &&
-                  (isdigit(sentence[cur_pos + temp_len]) || sentence[cur_pos + temp_len] == '.')) {
-
-                if (sentence[cur_pos + temp_len] == '.') {
-                    if (not hasDot)
-                        hasDot = true;
-                    else
-                        throw Error("in digit constant, too many dots in one number",
-                                    cur_line_number, cur_pos);
-                }
-
-                temp_len ++;
-            }
-
-            // 截取 并 加入token列表
-            tokens.emplace_back(Token(sentence.substr(cur_pos, temp_len),
-                                      TOKEN_TYPE_ENUM::DIGIT_CONSTANT,
-                                      cur_pos, cur_line_number));
 
-            cur_pos += temp_len;
-            continue;
+        cur_pos ++;
+        return true;
+    }
+    // 运算符
+    else if (Token::isOperator(cur_char)) {
+        // ++ -- << >> && || ==
+        if ((cur_char == '+' || cur_char == '-' || cur_char == '<' || cur_char == '>' ||
+             cur_char == '&' || cur_char == '|' || cur_char == '=') &&
+            cur_pos + 1 < len && source[cur_pos + 1] == cur_char) {
+
+            all_tokens.emplace_back(source, cur_pos, 2, TOKEN_TYPE_ENUM::OPERATOR,
+                                    _column(cur_pos), cur_line_number);
+            cur_pos += 2;
         }
-        // 分隔符 和 字符串常量
-        else if (_isSeparator(cur_char)) {
-            // 先加入token列表
-            string temp_str = sentence.substr(cur_pos, 1);
-            tokens.emplace_back(Token(temp_str, TOKEN_TYPE_ENUM::SEPARATOR,
-                                      cur_pos, cur_line_number));
-
-            // 如果是 `'`或者`"` 需要考虑一下匹配
-            int temp_len = 0;
-            if (cur_char == '\"' || cur_char == '\'') {
-                cur_pos ++;
-
-                while (cur_pos + temp_len < len &&
-                       sentence[cur_pos + temp_len] != cur_char)
-                    temp_len ++;
-
-                // 匹配不上
-                if (cur_pos + temp_len >= len || sentence[cur_pos + temp_len] != cur_char)
-                    throw Error("in string constant, lack of " + char2string(cur_char),
-                                cur_line_number, cur_pos);
-
-                tokens.emplace_back(Token(sentence.substr(cur_pos, temp_len),
-                                          TOKEN_TYPE_ENUM::STRING_CONSTANT,
-                                          cur_pos + 1, cur_line_number));
-
-                cur_pos += temp_len;
-                tokens.emplace_back(Token(temp_str, TOKEN_TYPE_ENUM::SEPARATOR,
-                                          cur_pos + 1, cur_line_number));
-            }
-
-            cur_pos ++;
-            continue;
+        // <= >= !=
+        else if ((cur_char == '<' || cur_char == '>' || cur_char == '!') &&
+                 cur_pos + 1 < len &&
+                 source[cur_pos + 1] == '=') {
+            all_tokens.emplace_back(source, cur_pos, 2, TOKEN_TYPE_ENUM::OPERATOR,
+                                    _column(cur_pos), cur_line_number);
+            cur_pos += 2;
         }
-        // 运算符
-        else if (_isOperator(cur_char)) {
-            // ++ -- << >> && || ==
-            if ((cur_char == '+' || cur_char == '-' || cur_char == '<' || cur_char == '>' ||
-                 cur_char == '&' || cur_char == '|' || cur_char == '=') &&
-                cur_pos + 1 < len && sentence[cur_pos + 1] == cur_char) {
-
-                tokens.emplace_back(Token(sentence.substr(cur_pos, 2), TOKEN_TYPE_ENUM::OPERATOR,
-                                          cur_pos, cur_line_number));
-                cur_pos += 2;
-            }
-            // <= >= !=
-            else if ((cur_char == '<' || cur_char == '>' || cur_char == '!') &&
-                     cur_pos + 1 < len &&
-                     sentence[cur_pos + 1] == '=') {
-                tokens.emplace_back(Token(sentence.substr(cur_pos, 2), TOKEN_TYPE_ENUM::OPERATOR,
-                                          cur_pos, cur_line_number));
-                cur_pos += 2;
-            }
-            // 一位的运算符
-            else {
-                tokens.emplace_back(Token(sentence.substr(cur_pos, 1), TOKEN_TYPE_ENUM::OPERATOR,
-                                    cur_pos, cur_line_number));
-                cur_pos ++;
-            }
-
-            continue;
+        // 一位的运算符
+        else {
+            all_tokens.emplace_back(source, cur_pos, 1, TOKEN_TYPE_ENUM::OPERATOR,
+                                    _column(cur_pos), cur_line_number);
+            cur_pos ++;
         }
 
-        cur_pos ++;
+        return true;
     }
+
+    cur_pos ++;
+    return true;
 }
 
 
 /**
- * @brief 分析一个程序（很多句子），如果正确生成Token列表，如果错误生成错误列表
- * @param _sentences vector string, 等待分析的程序
- * @param verbose bool, 是否就地输出tokens
+ * @brief 开始分析一个源文件，之后用 next 一个一个取 token
+ * @param _source 整个源文件的内容，不用以 '\0' 结尾，要比取出来的 token 活得久
+ * @param length 内容的长度
  */
-void LexicalAnalyzer::analyze(vector<string> _sentences, bool verbose) {
-    cur_line_number = 0;
-    in_comment = false;
+void LexicalAnalyzer::start(const char * _source, size_t length) {
+    source = _source;
+    len = length;
+    cur_pos = line_start = 0;
+    cur_line_number = 1;
+    next_token = 0;
     all_tokens.clear();
 
-    try {
-        for (auto _s: _sentences) {
-            cur_line_number ++;
+    // Token 只记 32 位的位置
+    if (length > UINT32_MAX) {
+        Error e("source file is larger than 4GB");
+        _report(e);
+    }
+}
 
-            _init(_s);
-            _analyze();
 
-            for (auto t: tokens)
-                all_tokens.emplace_back(t);
+/**
+ * @brief 取下一个 token，要多少读多少，只在 all_tokens 里留一个词的 token
+ * @param token 取到的 token
+ * @return 是否取到，到文件结尾返回 false
+ */
+bool LexicalAnalyzer::next(Token & token) {
+    try {
+        while (next_token == all_tokens.size()) {
+            all_tokens.clear();
+            next_token = 0;
+            if (! _scan())
+                return false;
         }
+    }
+    catch (Error & e) {
+        _report(e);
+    }
+
+    token = all_tokens[next_token ++];
+    return true;
+}
+
+
+/**
+ * @brief 报告词法错误并退出
+ */
+void LexicalAnalyzer::_report(Error & e) {
+    cout << "Lexical analyze errors" << endl;
+    cout << e;
+
+    exit(0);
+}
+
+
+/**
+ * @brief 分析一个程序，如果正确生成Token列表，如果错误生成错误列表
+ * @param _source 整个源文件的内容，不用以 '\0' 结尾
+ * @param length 内容的长度
+ * @param verbose bool, 是否就地输出tokens
+ */
+void LexicalAnalyzer::analyze(const char * _source, size_t length, bool verbose) {
+    start(_source, length);
+
+    try {
+        // 一般几个字符一个 token，先留够，整个文件只分配一两次
+        all_tokens.reserve(length / 4 + 16);
+        while (_scan());
+        next_token = all_tokens.size();
 
         if (verbose) {
             cout << "Tokens\n";
-            for (auto t: all_tokens)
-                cout << t;
+            for (auto & t: all_tokens)
+                t.display(cout, source);
         }
     }
     catch (Error & e) {
-        cout << "Lexical analyze errors" << endl;
-        cout << e;
-
-        exit(0);
+        _report(e);
     }
 }
 
@@ -306,6 +269,6 @@ void LexicalAnalyzer::analyze(vector<string> _sentences, bool verbose) {
  * @brief 得到Token列表
  * @return vector<Token>
  */
-vector<Token> LexicalAnalyzer::getAllTokens() {
+const vector<Token> & LexicalAnalyzer::getAllTokens() {
     return all_tokens;
 }
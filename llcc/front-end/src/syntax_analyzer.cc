@@ -10,23 +10,30 @@
 
 /**
  * @brief 语法分析器构造函数
+ * @param _arena 语法树的节点从这里分配，要比语法树活得久
  */
-SyntaxAnalyzer::SyntaxAnalyzer() = default;
+SyntaxAnalyzer::SyntaxAnalyzer(SyntaxTreeArena * _arena) {
+    arena = _arena;
+    tree = nullptr;
+    index = 0;
+    text = "";
+}
 
 
 /**
  * @brief 进行语法分析
- * @param sentences string vector, 等待分析的句子们
+ * @param source 整个源文件的内容
+ * @param length 内容的长度
  * @param verbose bool, 是否输出语法树
  */
-void SyntaxAnalyzer::analyze(vector<string> sentences, bool verbose) {
+void SyntaxAnalyzer::analyze(const char * source, size_t length, bool verbose) {
     LexicalAnalyzer la;
-    // 如果能通过词法分析
-    la.analyze(sentences, false);
 
     index = 0;
-    tokens = la.getAllTokens();
-    len = tokens.size();
+    text = source;
+    // 语法分析要多少 token 词法分析器读多少
+    la.start(source, length);
+    tokens.reset(& la);
 
     try {
         _analyze();
@@ -42,14 +49,23 @@ void SyntaxAnalyzer::analyze(vector<string> sentences, bool verbose) {
 }
 
 
+/**
+ * @brief 第 i 个 Token 的值，Token 只记位置，值从源文件里取，超出范围是空的
+ */
+string SyntaxAnalyzer::_value(int i) {
+    return tokens.has(i) ? tokens[i].value(text) : "";
+}
+
+
 /**
  * @brief 进行语法分析
  */
 void SyntaxAnalyzer::_analyze() {
-    tree = new SyntaxTree(new SyntaxTreeNode("Class-" + tokens[1].value, POS(tokens[index])));
+    tree = arena -> newTree(arena -> newNode(SYNTAX_NODE_ENUM::CLASS, _value(1), POS(tokens[index])));
 
-    // 对语句们分开处理
-    while (index < len) {
+    // 对语句们分开处理，前面语句的 token 不会再看了
+    while (tokens.has(index)) {
+        tokens.release(index);
         int sentence_pattern = int(_judgeSentencePattern());
 
         switch (sentence_pattern) {
@@ -78,7 +94,7 @@ void SyntaxAnalyzer::_analyze() {
  */
 SENTENCE_PATTERN_ENUM SyntaxAnalyzer::_judgeSentencePattern() {
     int token_type = int(tokens[index].type);
-    string token_value = tokens[index].value;
+    string token_value = _value(index);
 
     switch (token_type) {
         // print 语句
@@ -86,7 +102,7 @@ SENTENCE_PATTERN_ENUM SyntaxAnalyzer::_judgeSentencePattern() {
             return SENTENCE_PATTERN_ENUM::PRINT;
             // include 语句
         case int(TOKEN_TYPE_ENUM::SHARP):
-            if (index + 1 < len && tokens[index + 1].type == TOKEN_TYPE_ENUM::INCLUDE)
+            if (tokens.has(index + 1) && tokens[index + 1].type == TOKEN_TYPE_ENUM::INCLUDE)
                 return SENTENCE_PATTERN_ENUM::INCLUDE;
             // 控制语句
         case int(TOKEN_TYPE_ENUM::IF):
@@ -101,7 +117,7 @@ SENTENCE_PATTERN_ENUM SyntaxAnalyzer::_judgeSentencePattern() {
         case int(TOKEN_TYPE_ENUM::DOUBLE):
         case int(TOKEN_TYPE_ENUM::CHAR):
         case int(TOKEN_TYPE_ENUM::VOID):
-            if (index + 2 < len && tokens[index + 1].type == TOKEN_TYPE_ENUM::IDENTIFIER) {
+            if (tokens.has(index + 2) && tokens[index + 1].type == TOKEN_TYPE_ENUM::IDENTIFIER) {
                 TOKEN_TYPE_ENUM nn_type = tokens[index + 2].type;
                 if (nn_type == TOKEN_TYPE_ENUM::SEMICOLON ||  // int a;
                     nn_type == TOKEN_TYPE_ENUM::LM_BRACKET || // int a[10];
@@ -112,7 +128,7 @@ SENTENCE_PATTERN_ENUM SyntaxAnalyzer::_judgeSentencePattern() {
             }
             // 函数调用 或者 赋值语句
         case int(TOKEN_TYPE_ENUM::IDENTIFIER):
-            if (index + 1 < len) {
+            if (tokens.has(index + 1)) {
                 TOKEN_TYPE_ENUM n_type = tokens[index + 1].type;
                 if (n_type == TOKEN_TYPE_ENUM::ASSIGN || n_type == TOKEN_TYPE_ENUM::LM_BRACKET)        // sum = 10
                     return SENTENCE_PATTERN_ENUM::ASSIGNMENT;
@@ -135,7 +151,7 @@ SENTENCE_PATTERN_ENUM SyntaxAnalyzer::_judgeSentencePattern() {
  * @brief 处理print语句
  */
 void SyntaxAnalyzer::_print(SyntaxTreeNode * father_node) {
-    SyntaxTree * print_tree = new SyntaxTree(new SyntaxTreeNode("Print", POS(tokens[index])));
+    SyntaxTree * print_tree = arena -> newTree(arena -> newNode(SYNTAX_NODE_ENUM::PRINT, POS(tokens[index])));
     tree -> addNode(print_tree -> root, father_node);
 
     // 读取 print
@@ -148,9 +164,9 @@ void SyntaxAnalyzer::_print(SyntaxTreeNode * father_node) {
 
     // 找 ）
     int temp_end;
-    while (index < len && tokens[index].type != TOKEN_TYPE_ENUM::RL_BRACKET) {
+    while (tokens.has(index) && tokens[index].type != TOKEN_TYPE_ENUM::RL_BRACKET) {
         temp_end = index;
-        while (temp_end < len &&
+        while (tokens.has(temp_end) &&
                tokens[temp_end].type != TOKEN_TYPE_ENUM::RL_BRACKET &&
                tokens[temp_end].type != TOKEN_TYPE_ENUM::COMMA)
             temp_end ++;
@@ -161,9 +177,9 @@ void SyntaxAnalyzer::_print(SyntaxTreeNode * father_node) {
             index ++;
 
             // 存值
-            print_tree -> addNode(new SyntaxTreeNode("Expression-String", POS(tokens[index])),
+            print_tree -> addNode(arena -> newNode(SYNTAX_NODE_ENUM::EXPRESSION_STRING, POS(tokens[index])),
                                                      print_tree -> root);
-            print_tree -> addNode(new SyntaxTreeNode("\"" + tokens[index].value + "\"", POS(tokens[index])),
+            print_tree -> addNode(arena -> newNode("\"" + _value(index) + "\"", POS(tokens[index])),
                                                      print_tree -> cur_node);
 
             // 读取 "
@@ -192,18 +208,18 @@ void SyntaxAnalyzer::_print(SyntaxTreeNode * father_node) {
  * @brief 处理申明语句
  */
 void SyntaxAnalyzer::_statement(SyntaxTreeNode * father_node) {
-    SyntaxTree * state_tree = new SyntaxTree(new SyntaxTreeNode("Statement", POS(tokens[index])));
+    SyntaxTree * state_tree = arena -> newTree(arena -> newNode(SYNTAX_NODE_ENUM::STATEMENT, POS(tokens[index])));
     tree -> addNode(state_tree -> root, father_node);
 
     // 读取变量类型
-    string variable_type = tokens[index].value;
+    string variable_type = _value(index);
     index ++;
 
     // 找结尾
     string cur_value;
     int cur_type;
-    while (index < len && tokens[index].type!= TOKEN_TYPE_ENUM::SEMICOLON) {
-        cur_value = tokens[index].value, cur_type = int(tokens[index].type);
+    while (tokens.has(index) && tokens[index].type!= TOKEN_TYPE_ENUM::SEMICOLON) {
+        cur_value = _value(index), cur_type = int(tokens[index].type);
 
         switch (cur_type) {
             // 是个标识符
@@ -213,7 +229,7 @@ void SyntaxAnalyzer::_statement(SyntaxTreeNode * father_node) {
                 TOKEN_TYPE_ENUM n_type = tokens[index].type;
                 // 如果是，或者；就直接读取
                 if (n_type == TOKEN_TYPE_ENUM::COMMA || n_type == TOKEN_TYPE_ENUM::SEMICOLON) {
-                    state_tree -> addNode(new SyntaxTreeNode(cur_value, variable_type, "", POS(tokens[index])),
+                    state_tree -> addNode(arena -> newNode(cur_value, variable_type, "", POS(tokens[index])),
                                           state_tree -> root);
                     index ++;
 
@@ -228,7 +244,7 @@ void SyntaxAnalyzer::_statement(SyntaxTreeNode * father_node) {
                     index ++;
 
                     // 读取数组大小
-                    string size = "size=" + tokens[index].value;
+                    string size = "size=" + _value(index);
                     index ++;
 
                     // 读取 ]
@@ -239,7 +255,7 @@ void SyntaxAnalyzer::_statement(SyntaxTreeNode * father_node) {
 
                         // 如果是，或者；就直接读取
                         if (n_type == TOKEN_TYPE_ENUM::COMMA || n_type == TOKEN_TYPE_ENUM::SEMICOLON) {
-                            state_tree -> addNode(new SyntaxTreeNode(cur_value, "array-" + variable_type, size, POS(tokens[index])),
+                            state_tree -> addNode(arena -> newNode(cur_value, "array-" + variable_type, size, POS(tokens[index])),
                                                   state_tree -> root);
 
                             if (tokens[index ++].type == TOKEN_TYPE_ENUM::COMMA)
@@ -261,7 +277,7 @@ void SyntaxAnalyzer::_statement(SyntaxTreeNode * father_node) {
                                 string init_v = "&v=";
                                 do {
                                     if (tokens[index].type == TOKEN_TYPE_ENUM::DIGIT_CONSTANT)
-                                        init_v += tokens[index].value;
+                                        init_v += _value(index);
 
                                     index ++;
                                     if (tokens[index].type == TOKEN_TYPE_ENUM::RB_BRACKET)
@@ -273,12 +289,12 @@ void SyntaxAnalyzer::_statement(SyntaxTreeNode * father_node) {
                                     else
                                         throw Error( "in array initialization, expected `,` or `}` after a digital constant",
                                                      POS(tokens[index]));
-                                } while (index < len && tokens[index].type != TOKEN_TYPE_ENUM::RB_BRACKET);
+                                } while (tokens.has(index) && tokens[index].type != TOKEN_TYPE_ENUM::RB_BRACKET);
 
                                 index ++;
                                 n_type = tokens[index].type;
                                 if (n_type == TOKEN_TYPE_ENUM::COMMA || n_type == TOKEN_TYPE_ENUM::SEMICOLON) {
-                                    state_tree -> addNode(new SyntaxTreeNode(cur_value, "array-" + variable_type, size + init_v, POS(tokens[index])),
+                                    state_tree -> addNode(arena -> newNode(cur_value, "array-" + variable_type, size + init_v, POS(tokens[index])),
                                                           state_tree -> root);
                                     if (tokens[index ++].type == TOKEN_TYPE_ENUM::COMMA)
                                         break;
@@ -290,7 +306,7 @@ void SyntaxAnalyzer::_statement(SyntaxTreeNode * father_node) {
                                 throw Error("in array initialization, expected `{}`", POS(tokens[index]));
                         }
                         else
-                            throw Error("in statement, unrecognized symbol `" + tokens[index].value + "`", POS(tokens[index]));
+                            throw Error("in statement, unrecognized symbol `" + _value(index) + "`", POS(tokens[index]));
                     }
                     else
                         throw Error("in statement, expected `]` after a statement of an array", POS(tokens[index]));
@@ -298,7 +314,7 @@ void SyntaxAnalyzer::_statement(SyntaxTreeNode * father_node) {
                 throw Error("in statement, Unrecognized symbol in statement", POS(tokens[index]));
             }
             default:
-                throw Error("in statement, unrecognized symbol `" +  tokens[index].value + "`", POS(tokens[index]));
+                throw Error("in statement, unrecognized symbol `" +  _value(index) + "`", POS(tokens[index]));
         }
     }
 }
@@ -312,13 +328,13 @@ void SyntaxAnalyzer::_expression(SyntaxTreeNode * father_node, TOKEN_TYPE_ENUM s
     vector<SyntaxTree *> reverse_polish_exp;
 
     TOKEN_TYPE_ENUM cur_type;
-    while (index < len && tokens[index].type != stop_sign) {
+    while (tokens.has(index) && tokens[index].type != stop_sign) {
         cur_type = tokens[index].type;
 
         // 常量
         if (cur_type == TOKEN_TYPE_ENUM::DIGIT_CONSTANT) {
-            SyntaxTree * new_tree = new SyntaxTree(new SyntaxTreeNode("Expression-Constant", POS(tokens[index])));
-            new_tree -> addNode(new SyntaxTreeNode(tokens[index].value,
+            SyntaxTree * new_tree = arena -> newTree(arena -> newNode(SYNTAX_NODE_ENUM::EXPRESSION_CONSTANT, POS(tokens[index])));
+            new_tree -> addNode(arena -> newNode(_value(index),
                                                    POS(tokens[index])),
                                 new_tree -> root);
 
@@ -328,18 +344,18 @@ void SyntaxAnalyzer::_expression(SyntaxTreeNode * father_node, TOKEN_TYPE_ENUM s
         // 变量
         else if (cur_type == TOKEN_TYPE_ENUM::IDENTIFIER) {
             // 数组下标
-            if (index + 3 < len && tokens[index + 1].type == TOKEN_TYPE_ENUM::LM_BRACKET) {
-                SyntaxTree * new_tree = new SyntaxTree(new SyntaxTreeNode("Expression-ArrayItem", POS(tokens[index])));
+            if (tokens.has(index + 3) && tokens[index + 1].type == TOKEN_TYPE_ENUM::LM_BRACKET) {
+                SyntaxTree * new_tree = arena -> newTree(arena -> newNode(SYNTAX_NODE_ENUM::EXPRESSION_ARRAY_ITEM, POS(tokens[index])));
 
                 // 数组名字
-                new_tree -> addNode(new SyntaxTreeNode(tokens[index].value, POS(tokens[index])),
+                new_tree -> addNode(arena -> newNode(_value(index), POS(tokens[index])),
                                     new_tree -> cur_node);
 
                 // 读取 名字 和 [
                 index += 2;
 
                 // 数组下标
-                SyntaxTreeNode * index_node = new SyntaxTreeNode("Array-Index", POS(tokens[index]));
+                SyntaxTreeNode * index_node = arena -> newNode(SYNTAX_NODE_ENUM::ARRAY_INDEX, POS(tokens[index]));
                 new_tree -> addNode(index_node, new_tree -> root);
                 _expression(index_node, TOKEN_TYPE_ENUM::RM_BRACKET);
 
@@ -347,8 +363,8 @@ void SyntaxAnalyzer::_expression(SyntaxTreeNode * father_node, TOKEN_TYPE_ENUM s
             }
             // 一般的变量
             else {
-                SyntaxTree * new_tree = new SyntaxTree(new SyntaxTreeNode("Expression-Variable", POS(tokens[index])));
-                new_tree -> addNode(new SyntaxTreeNode(tokens[index].value,
+                SyntaxTree * new_tree = arena -> newTree(arena -> newNode(SYNTAX_NODE_ENUM::EXPRESSION_VARIABLE, POS(tokens[index])));
+                new_tree -> addNode(arena -> newNode(_value(index),
                                                        POS(tokens[index])),
                                     new_tree -> root);
 
@@ -358,8 +374,8 @@ void SyntaxAnalyzer::_expression(SyntaxTreeNode * father_node, TOKEN_TYPE_ENUM s
         }
         // 运算符
         else if (Token::isExpressionOperator(cur_type)) {
-            SyntaxTree * new_tree = new SyntaxTree(new SyntaxTreeNode("Expression-Operator", POS(tokens[index])));
-            new_tree -> addNode(new SyntaxTreeNode(tokens[index].value,
+            SyntaxTree * new_tree = arena -> newTree(arena -> newNode(SYNTAX_NODE_ENUM::EXPRESSION_OPERATOR, POS(tokens[index])));
+            new_tree -> addNode(arena -> newNode(_value(index),
                                                    POS(tokens[index])), new_tree -> root);
 
             // 如果是 (
@@ -374,7 +390,7 @@ void SyntaxAnalyzer::_expression(SyntaxTreeNode * father_node, TOKEN_TYPE_ENUM s
                     temp_t = op_stack.top();
                     op_stack.pop();
 
-                    if (temp_t -> root -> first_son -> value == token2string(TOKEN_TYPE_ENUM::LL_BRACKET)) {
+                    if (arena -> text(temp_t -> root -> first_son -> value) == token2string(TOKEN_TYPE_ENUM::LL_BRACKET)) {
                         flag = true;
                         break;
                     }
@@ -391,8 +407,8 @@ void SyntaxAnalyzer::_expression(SyntaxTreeNode * father_node, TOKEN_TYPE_ENUM s
                 int cur_pio = int(tokens[index].type), t_pio;
                 while (! op_stack.empty()) {
                     temp_t = op_stack.top();
-                    t_pio = temp_t -> root -> first_son -> value == "(" ? -1 :
-                            int(Token::DETAIL_TOKEN_TYPE[temp_t -> root -> first_son -> value]);
+                    t_pio = arena -> text(temp_t -> root -> first_son -> value) == "(" ? -1 :
+                            int(Token::detailType(arena -> text(temp_t -> root -> first_son -> value)));
 
                     if (t_pio <= cur_pio)
                         break;
@@ -407,10 +423,10 @@ void SyntaxAnalyzer::_expression(SyntaxTreeNode * father_node, TOKEN_TYPE_ENUM s
             index ++;
         }
         else
-            throw Error("in expression, unrecognized symbols `" + tokens[index].value + "`" , POS(tokens[index]));
+            throw Error("in expression, unrecognized symbols `" + _value(index) + "`" , POS(tokens[index]));
     }
 
-    if (!(len < index || tokens[index].type == stop_sign))
+    if (!(! tokens.has(index - 1) || tokens[index].type == stop_sign))
         throw Error("in expression, expected token `" + token2string(stop_sign) + "` at the end", POS(tokens[index]));
 
     // 读取stop sign
@@ -419,7 +435,7 @@ void SyntaxAnalyzer::_expression(SyntaxTreeNode * father_node, TOKEN_TYPE_ENUM s
     SyntaxTree * temp_t;
     while (! op_stack.empty()) {
         temp_t = op_stack.top();
-        if (temp_t -> root -> first_son -> value == "(")
+        if (arena -> text(temp_t -> root -> first_son -> value) == "(")
             throw Error("in expression, expected `)` after `(`", POS(tokens[index]));
         reverse_polish_exp.emplace_back(temp_t);
         op_stack.pop();
@@ -432,18 +448,18 @@ void SyntaxAnalyzer::_expression(SyntaxTreeNode * father_node, TOKEN_TYPE_ENUM s
         temp_t = reverse_polish_exp[i];
 
         // 如果是运算符
-        if (temp_t -> root -> value == "Expression-Operator") {
+        if (temp_t -> root -> kind == SYNTAX_NODE_ENUM::EXPRESSION_OPERATOR) {
             // 如果是单目运算符
-            if (Token::isUniOperator(Token::DETAIL_TOKEN_TYPE[temp_t -> root -> first_son -> value])) {
+            if (Token::isUniOperator(Token::detailType(arena -> text(temp_t -> root -> first_son -> value)))) {
                 a = op_stack.top();
                 op_stack.pop();
 
                 SyntaxTree * new_tree;
-                if (Token::isBoolOperator(Token::DETAIL_TOKEN_TYPE[temp_t -> root -> first_son -> value])) {
-                    new_tree = new SyntaxTree(new SyntaxTreeNode( "Expression-Bool-UniOp", POS(tokens[index])));
+                if (Token::isBoolOperator(Token::detailType(arena -> text(temp_t -> root -> first_son -> value)))) {
+                    new_tree = arena -> newTree(arena -> newNode(SYNTAX_NODE_ENUM::EXPRESSION_BOOL_UNI_OP, POS(tokens[index])));
                 }
                 else {
-                    new_tree = new SyntaxTree(new SyntaxTreeNode( "Expression-UniOp", POS(tokens[index])));
+                    new_tree = arena -> newTree(arena -> newNode(SYNTAX_NODE_ENUM::EXPRESSION_UNI_OP, POS(tokens[index])));
                 }
 
                 // 添加操作符
@@ -462,21 +478,21 @@ void SyntaxAnalyzer::_expression(SyntaxTreeNode * father_node, TOKEN_TYPE_ENUM s
                 op_stack.pop();
 
                 SyntaxTree * new_tree;
-                if (Token::isBoolOperator(Token::DETAIL_TOKEN_TYPE[temp_t -> root -> first_son -> value])) {
-                    new_tree = new SyntaxTree(new SyntaxTreeNode( "Expression-Bool-DoubleOp", POS(tokens[index])));
+                if (Token::isBoolOperator(Token::detailType(arena -> text(temp_t -> root -> first_son -> value)))) {
+                    new_tree = arena -> newTree(arena -> newNode(SYNTAX_NODE_ENUM::EXPRESSION_BOOL_DOUBLE_OP, POS(tokens[index])));
                 }
                 else {
-                    new_tree = new SyntaxTree(new SyntaxTreeNode( "Expression-DoubleOp", POS(tokens[index])));
+                    new_tree = arena -> newTree(arena -> newNode(SYNTAX_NODE_ENUM::EXPRESSION_DOUBLE_OP, POS(tokens[index])));
                 }
 
-                if (Token::isBoolOperator(Token::DETAIL_TOKEN_TYPE[temp_t -> root -> first_son -> value])) {
-                    string temp_op = temp_t -> root -> first_son -> value;
+                if (Token::isBoolOperator(Token::detailType(arena -> text(temp_t -> root -> first_son -> value)))) {
+                    string temp_op = arena -> text(temp_t -> root -> first_son -> value);
                     if (temp_op == ">=") {
-                        temp_t -> root -> first_son -> value = "<";
+                        temp_t -> root -> first_son -> value = arena -> intern("<");
                         swap(a, b);
                     }
                     else if (temp_op == "<=") {
-                        temp_t -> root -> first_son -> value = ">";
+                        temp_t -> root -> first_son -> value = arena -> intern(">");
                         swap(a, b);
                     }
                 }
@@ -505,27 +521,27 @@ void SyntaxAnalyzer::_expression(SyntaxTreeNode * father_node, TOKEN_TYPE_ENUM s
  * @brief 处理函数声明
  */
 void SyntaxAnalyzer::_functionStatement(SyntaxTreeNode * father_node) {
-    SyntaxTree * func_state_tree = new SyntaxTree(new SyntaxTreeNode("FunctionStatement", POS(tokens[index])));
+    SyntaxTree * func_state_tree = arena -> newTree(arena -> newNode(SYNTAX_NODE_ENUM::FUNCTION_STATEMENT, POS(tokens[index])));
     tree -> addNode(func_state_tree -> root, father_node);
 
     string cur_value;
     TOKEN_TYPE_ENUM cur_type;
 
     // 读取返回类型
-    func_state_tree -> addNode(new SyntaxTreeNode("Type", POS(tokens[index])), func_state_tree -> root);
-    func_state_tree -> addNode(new SyntaxTreeNode(tokens[index].value, POS(tokens[index])), func_state_tree -> cur_node);
+    func_state_tree -> addNode(arena -> newNode(SYNTAX_NODE_ENUM::TYPE, POS(tokens[index])), func_state_tree -> root);
+    func_state_tree -> addNode(arena -> newNode(_value(index), POS(tokens[index])), func_state_tree -> cur_node);
     index ++;
 
     // 读取函数名
-    func_state_tree -> addNode(new SyntaxTreeNode("FunctionName", POS(tokens[index])), func_state_tree -> root);
-    func_state_tree -> addNode(new SyntaxTreeNode(tokens[index].value, POS(tokens[index])), func_state_tree -> cur_node);
+    func_state_tree -> addNode(arena -> newNode(SYNTAX_NODE_ENUM::FUNCTION_NAME, POS(tokens[index])), func_state_tree -> root);
+    func_state_tree -> addNode(arena -> newNode(_value(index), POS(tokens[index])), func_state_tree -> cur_node);
     index ++;
 
     // 读取(
     index ++;
 
     // 建一个参数树
-    SyntaxTreeNode * param_list = new SyntaxTreeNode("ParameterList", POS(tokens[index]));
+    SyntaxTreeNode * param_list = arena -> newNode(SYNTAX_NODE_ENUM::PARAMETER_LIST, POS(tokens[index]));
     func_state_tree -> addNode(param_list, func_state_tree -> root);
 
     // 如果下一个是）
@@ -534,23 +550,23 @@ void SyntaxAnalyzer::_functionStatement(SyntaxTreeNode * father_node) {
     }
     // 如果下一个不是），读取参数列表
     else {
-        while (index < len && tokens[index].type != TOKEN_TYPE_ENUM::RL_BRACKET) {
-            cur_value = tokens[index].value;
+        while (tokens.has(index) && tokens[index].type != TOKEN_TYPE_ENUM::RL_BRACKET) {
+            cur_value = _value(index);
 
             if (cur_value == "int" || cur_value == "double" || cur_value == "float") {
-                SyntaxTreeNode * param = new SyntaxTreeNode("Parameter", POS(tokens[index]));
+                SyntaxTreeNode * param = arena -> newNode(SYNTAX_NODE_ENUM::PARAMETER, POS(tokens[index]));
                 func_state_tree -> addNode(param, param_list);
 
                 index ++;
-                if (index < len && tokens[index].type == TOKEN_TYPE_ENUM::IDENTIFIER) {
-                    func_state_tree -> addNode(new SyntaxTreeNode(tokens[index].value,
+                if (tokens.has(index) && tokens[index].type == TOKEN_TYPE_ENUM::IDENTIFIER) {
+                    func_state_tree -> addNode(arena -> newNode(_value(index),
                                                                   cur_value, "",
                                                                   POS(tokens[index])), param);
                     index ++;
 
-                    if (index < len && tokens[index].type == TOKEN_TYPE_ENUM::COMMA)
+                    if (tokens.has(index) && tokens[index].type == TOKEN_TYPE_ENUM::COMMA)
                         index ++;
-                    else if (index < len && tokens[index].type == TOKEN_TYPE_ENUM::RL_BRACKET) {
+                    else if (tokens.has(index) && tokens[index].type == TOKEN_TYPE_ENUM::RL_BRACKET) {
                         index ++;
                         break;
                     }
@@ -580,22 +596,22 @@ void SyntaxAnalyzer::_functionStatement(SyntaxTreeNode * father_node) {
  * @brief 处理return
  */
 void SyntaxAnalyzer::_return(SyntaxTreeNode * father_node) {
-    SyntaxTree * return_tree = new SyntaxTree();
+    SyntaxTree * return_tree = arena -> newTree();
 
     index ++;
-    if (index < len) {
+    if (tokens.has(index)) {
         if (tokens[index].type == TOKEN_TYPE_ENUM::SEMICOLON) {
-            return_tree -> root = return_tree -> cur_node = new SyntaxTreeNode("VoidReturn", POS(tokens[index]));
-            return_tree -> addNode(new SyntaxTreeNode(tokens[index - 1].value, POS(tokens[index])), return_tree -> cur_node);
+            return_tree -> root = return_tree -> cur_node = arena -> newNode(SYNTAX_NODE_ENUM::VOID_RETURN, POS(tokens[index]));
+            return_tree -> addNode(arena -> newNode(_value(index - 1), POS(tokens[index])), return_tree -> cur_node);
 
             tree -> addNode(return_tree -> root, father_node);
             index ++;
         }
         else {
-            return_tree -> root = return_tree -> cur_node = new SyntaxTreeNode("Return", POS(tokens[index]));
+            return_tree -> root = return_tree -> cur_node = arena -> newNode(SYNTAX_NODE_ENUM::RETURN, POS(tokens[index]));
             tree -> addNode(return_tree -> root, father_node);
 
-            return_tree -> addNode(new SyntaxTreeNode(tokens[index - 1].value, POS(tokens[index])), return_tree -> cur_node);
+            return_tree -> addNode(arena -> newNode(_value(index - 1), POS(tokens[index])), return_tree -> cur_node);
             _expression(return_tree -> root);
             return;
         }
@@ -610,11 +626,12 @@ void SyntaxAnalyzer::_return(SyntaxTreeNode * father_node) {
  * @brief 处理大括号{} 内的内容
  */
 void SyntaxAnalyzer::_block(SyntaxTreeNode * father_node) {
-    SyntaxTree * block_tree = new SyntaxTree(new SyntaxTreeNode("Block", POS(tokens[index])));
+    SyntaxTree * block_tree = arena -> newTree(arena -> newNode(SYNTAX_NODE_ENUM::BLOCK, POS(tokens[index])));
     tree -> addNode(block_tree -> root, father_node);
 
     index ++;
-    while (index < len && tokens[index].type != TOKEN_TYPE_ENUM::RB_BRACKET) {
+    while (tokens.has(index) && tokens[index].type != TOKEN_TYPE_ENUM::RB_BRACKET) {
+        tokens.release(index);
         int cur_type = int(_judgeSentencePattern());
 
         switch (cur_type) {
@@ -643,12 +660,12 @@ void SyntaxAnalyzer::_block(SyntaxTreeNode * father_node) {
                     continue;
                 }
 
-                throw Error("in block, unidentified symbols `" + tokens[index].value + "`  found",
+                throw Error("in block, unidentified symbols `" + _value(index) + "`  found",
                             POS(tokens[index]));
         }
     }
 
-    if (index < len && tokens[index].type == TOKEN_TYPE_ENUM::RB_BRACKET)
+    if (tokens.has(index) && tokens[index].type == TOKEN_TYPE_ENUM::RB_BRACKET)
         index ++;
     else
         throw Error("in block, expected }`", POS(tokens[index]));
@@ -661,30 +678,30 @@ void SyntaxAnalyzer::_block(SyntaxTreeNode * father_node) {
 void SyntaxAnalyzer::_functionCall(SyntaxTreeNode * father_node) {
     // TODO 在 expression 里添加函数调用
 
-    SyntaxTree * func_call_tree = new SyntaxTree(new SyntaxTreeNode("FunctionCall", POS(tokens[index])));
+    SyntaxTree * func_call_tree = arena -> newTree(arena -> newNode(SYNTAX_NODE_ENUM::FUNCTION_CALL, POS(tokens[index])));
     tree -> addNode(func_call_tree -> root, father_node);
 
-    func_call_tree -> addNode(new SyntaxTreeNode("FunctionName", POS(tokens[index])), func_call_tree -> root);
-    func_call_tree -> addNode(new SyntaxTreeNode(tokens[index].value, POS(tokens[index])), func_call_tree -> cur_node);
+    func_call_tree -> addNode(arena -> newNode(SYNTAX_NODE_ENUM::FUNCTION_NAME, POS(tokens[index])), func_call_tree -> root);
+    func_call_tree -> addNode(arena -> newNode(_value(index), POS(tokens[index])), func_call_tree -> cur_node);
 
-    SyntaxTree * param_tree = new SyntaxTree(new SyntaxTreeNode("FunctionParameters", POS(tokens[index])));
+    SyntaxTree * param_tree = arena -> newTree(arena -> newNode(SYNTAX_NODE_ENUM::FUNCTION_PARAMETERS, POS(tokens[index])));
     func_call_tree -> addNode(param_tree -> root, func_call_tree -> root);
 
     // 读取 函数名
     index ++;
-    if (index < len && tokens[index].type == TOKEN_TYPE_ENUM::LL_BRACKET) {
+    if (tokens.has(index) && tokens[index].type == TOKEN_TYPE_ENUM::LL_BRACKET) {
         // 读取 （
         index ++;
 
         int next_end;
-        while (index < len && tokens[index].type != TOKEN_TYPE_ENUM::RL_BRACKET) {
+        while (tokens.has(index) && tokens[index].type != TOKEN_TYPE_ENUM::RL_BRACKET) {
             next_end = index;
-            while (next_end < len &&
+            while (tokens.has(next_end) &&
                   (tokens[next_end].type != TOKEN_TYPE_ENUM::RL_BRACKET &&
                    tokens[next_end].type != TOKEN_TYPE_ENUM::COMMA))
                         next_end ++;
 
-            param_tree -> addNode(new SyntaxTreeNode("Param", POS(tokens[index])), param_tree -> root);
+            param_tree -> addNode(arena -> newNode(SYNTAX_NODE_ENUM::PARAM, POS(tokens[index])), param_tree -> root);
             _expression(param_tree -> cur_node, tokens[next_end].type);
 
             index = next_end + 1;
@@ -702,27 +719,27 @@ void SyntaxAnalyzer::_functionCall(SyntaxTreeNode * father_node) {
  * @brief 处理赋值语句
  */
 void SyntaxAnalyzer::_assignment(SyntaxTreeNode * father_node, TOKEN_TYPE_ENUM stop_token) {
-    SyntaxTree * assign_tree = new SyntaxTree(new SyntaxTreeNode("Assignment", POS(tokens[index])));
+    SyntaxTree * assign_tree = arena -> newTree(arena -> newNode(SYNTAX_NODE_ENUM::ASSIGNMENT, POS(tokens[index])));
     tree -> addNode(assign_tree -> root, father_node);
 
-    if (index < len && tokens[index].type == TOKEN_TYPE_ENUM::IDENTIFIER) {
-        assign_tree -> addNode(new SyntaxTreeNode(tokens[index].value, POS(tokens[index])), assign_tree -> root);
+    if (tokens.has(index) && tokens[index].type == TOKEN_TYPE_ENUM::IDENTIFIER) {
+        assign_tree -> addNode(arena -> newNode(_value(index), POS(tokens[index])), assign_tree -> root);
         index ++;
 
         // a[0] = 10;
-        if (index < len && tokens[index].type == TOKEN_TYPE_ENUM::LM_BRACKET) {
-            assign_tree -> cur_node -> value = "Expression-ArrayItem";
+        if (tokens.has(index) && tokens[index].type == TOKEN_TYPE_ENUM::LM_BRACKET) {
+            assign_tree -> cur_node -> kind = SYNTAX_NODE_ENUM::EXPRESSION_ARRAY_ITEM;
 
             index ++;
-            assign_tree -> addNode(new SyntaxTreeNode(tokens[index - 2].value,
+            assign_tree -> addNode(arena -> newNode(_value(index - 2),
                                                       POS(tokens[index - 2])),
                                    assign_tree -> root -> first_son);
-            assign_tree -> addNode(new SyntaxTreeNode("Array-Index", POS(tokens[index])), assign_tree -> root -> first_son);
+            assign_tree -> addNode(arena -> newNode(SYNTAX_NODE_ENUM::ARRAY_INDEX, POS(tokens[index])), assign_tree -> root -> first_son);
             _expression(assign_tree -> cur_node, TOKEN_TYPE_ENUM::RM_BRACKET);
         }
 
         // a = 10;
-        if (index < len && tokens[index].type == TOKEN_TYPE_ENUM::ASSIGN) {
+        if (tokens.has(index) && tokens[index].type == TOKEN_TYPE_ENUM::ASSIGN) {
             index ++;
 
             _expression(assign_tree -> root, stop_token);
@@ -731,7 +748,7 @@ void SyntaxAnalyzer::_assignment(SyntaxTreeNode * father_node, TOKEN_TYPE_ENUM s
             throw Error("in assignment, expected `=` after an identifier", POS(tokens[index]));
         }
     }
-    else if (index < len && tokens[index].type == stop_token)
+    else if (tokens.has(index) && tokens[index].type == stop_token)
         index ++;
     else
         throw Error("in assignment, expected a `" + token2string(stop_token) + "` after", POS(tokens[index]));
@@ -763,7 +780,7 @@ void SyntaxAnalyzer::_control(SyntaxTreeNode * father_node) {
  * @brief 处理for
  */
 void SyntaxAnalyzer::_for(SyntaxTreeNode * father_node) {
-    SyntaxTree * psudo_while_tree = new SyntaxTree(new SyntaxTreeNode("Control-While", POS(tokens[index])));
+    SyntaxTree * psudo_while_tree = arena -> newTree(arena -> newNode(SYNTAX_NODE_ENUM::CONTROL_WHILE, POS(tokens[index])));
     // 读取 for
     index ++;
 
@@ -776,15 +793,15 @@ void SyntaxAnalyzer::_for(SyntaxTreeNode * father_node) {
         _assignment(father_node);
 
         // 读取第二个条件语句
-        psudo_while_tree -> addNode(new SyntaxTreeNode("Condition", POS(tokens[index])), psudo_while_tree -> root);
+        psudo_while_tree -> addNode(arena -> newNode(SYNTAX_NODE_ENUM::CONDITION, POS(tokens[index])), psudo_while_tree -> root);
         _expression(psudo_while_tree -> cur_node);
 
         // 读取第三个赋值语句
-        SyntaxTreeNode * temp = new SyntaxTreeNode("", POS(tokens[index]));
+        SyntaxTreeNode * temp = arena -> newNode(SYNTAX_NODE_ENUM::NONE, POS(tokens[index]));
         _assignment(temp, TOKEN_TYPE_ENUM::RL_BRACKET);
 
         // 读取 {
-        if (index < len && tokens[index].type == TOKEN_TYPE_ENUM::LB_BRACKET) {
+        if (tokens.has(index) && tokens[index].type == TOKEN_TYPE_ENUM::LB_BRACKET) {
             _block(psudo_while_tree -> root);
             psudo_while_tree -> addNode(temp -> first_son, psudo_while_tree -> root -> first_son -> right);
             tree -> addNode(psudo_while_tree -> root, father_node);
@@ -801,21 +818,21 @@ void SyntaxAnalyzer::_for(SyntaxTreeNode * father_node) {
  * @brief 处理while
  */
 void SyntaxAnalyzer::_while(SyntaxTreeNode * father_node) {
-    SyntaxTree * while_tree = new SyntaxTree(new SyntaxTreeNode("Control-While", POS(tokens[index])));
+    SyntaxTree * while_tree = arena -> newTree(arena -> newNode(SYNTAX_NODE_ENUM::CONTROL_WHILE, POS(tokens[index])));
     tree -> addNode(while_tree -> root, father_node);
 
     // 读取while
     index ++;
 
-    if (index < len && tokens[index].type == TOKEN_TYPE_ENUM::LL_BRACKET) {
+    if (tokens.has(index) && tokens[index].type == TOKEN_TYPE_ENUM::LL_BRACKET) {
         index ++;
 
         // 读取 表达式 直到遇到）
-        while_tree -> addNode(new SyntaxTreeNode("Condition", POS(tokens[index])), while_tree -> root);
+        while_tree -> addNode(arena -> newNode(SYNTAX_NODE_ENUM::CONDITION, POS(tokens[index])), while_tree -> root);
         _expression(while_tree -> cur_node, TOKEN_TYPE_ENUM::RL_BRACKET);
 
         // 读取 {
-        if (index < len && tokens[index].type == TOKEN_TYPE_ENUM::LB_BRACKET)
+        if (tokens.has(index) && tokens[index].type == TOKEN_TYPE_ENUM::LB_BRACKET)
             _block(while_tree -> root);
         else
             throw Error("Expected `{` after `while (condition)`", POS(tokens[index]));
@@ -829,27 +846,27 @@ void SyntaxAnalyzer::_while(SyntaxTreeNode * father_node) {
  * @brief 处理if
  */
 void SyntaxAnalyzer::_if(SyntaxTreeNode * father_node) {
-    SyntaxTree * if_tree = new SyntaxTree(new SyntaxTreeNode("Control-If", POS(tokens[index])));
+    SyntaxTree * if_tree = arena -> newTree(arena -> newNode(SYNTAX_NODE_ENUM::CONTROL_IF, POS(tokens[index])));
     tree -> addNode(if_tree -> root, father_node);
 
     // 读取 if
     index ++;
 
     // 处理if
-    if (index < len && tokens[index].type == TOKEN_TYPE_ENUM::LL_BRACKET) {
+    if (tokens.has(index) && tokens[index].type == TOKEN_TYPE_ENUM::LL_BRACKET) {
         // 读取 (
         index ++;
 
-        if_tree -> addNode(new SyntaxTreeNode("Control-Condition", POS(tokens[index])), if_tree -> root);
+        if_tree -> addNode(arena -> newNode(SYNTAX_NODE_ENUM::CONTROL_CONDITION, POS(tokens[index])), if_tree -> root);
         _expression(if_tree -> cur_node, TOKEN_TYPE_ENUM::RL_BRACKET);
 
         // 如果是 {
-        if (index < len && tokens[index].type == TOKEN_TYPE_ENUM::LB_BRACKET) {
+        if (tokens.has(index) && tokens[index].type == TOKEN_TYPE_ENUM::LB_BRACKET) {
             _block(if_tree -> root);
 
             // 如果还有else 和 else if
-            if (index < len && tokens[index].type == TOKEN_TYPE_ENUM::ELSE) {
-                if (index + 1 < len && tokens[index].type == TOKEN_TYPE_ENUM::IF) {
+            if (tokens.has(index) && tokens[index].type == TOKEN_TYPE_ENUM::ELSE) {
+                if (tokens.has(index + 1) && tokens[index].type == TOKEN_TYPE_ENUM::IF) {
                     _else_if(if_tree -> root);
                 }
                 else {
@@ -874,19 +891,19 @@ void SyntaxAnalyzer::_else_if(SyntaxTreeNode * father_node) {
     // 读取 else if
     index += 2;
 
-    if (index < len && tokens[index].type == TOKEN_TYPE_ENUM::LL_BRACKET) {
+    if (tokens.has(index) && tokens[index].type == TOKEN_TYPE_ENUM::LL_BRACKET) {
         // 读取 (
         index ++;
 
         _expression(father_node, TOKEN_TYPE_ENUM::RL_BRACKET);
 
         // 如果是 {
-        if (index < len && tokens[index].type == TOKEN_TYPE_ENUM::LB_BRACKET) {
+        if (tokens.has(index) && tokens[index].type == TOKEN_TYPE_ENUM::LB_BRACKET) {
             _block(father_node);
 
             // 如果还有else 和 else if
-            if (index < len && tokens[index].type == TOKEN_TYPE_ENUM::ELSE) {
-                if (index + 1 < len && tokens[index].type == TOKEN_TYPE_ENUM::IF) {
+            if (tokens.has(index) && tokens[index].type == TOKEN_TYPE_ENUM::ELSE) {
+                if (tokens.has(index + 1) && tokens[index].type == TOKEN_TYPE_ENUM::IF) {
                     _else_if(father_node);
                 }
                 else {
@@ -0,0 +1,67 @@
+/**
+ * @file token_window.cc
+ * @brief token 窗口具体实现
+ */
+
+#include "../include/token_window.h"
+
+
+TokenWindow::TokenWindow() {
+    lexer = nullptr;
+    base = 0;
+    finished = true;
+}
+
+
+/**
+ * @brief 换一个词法分析器，从它的第一个 token 开始
+ * @param _lexer 已经 start 过的词法分析器
+ */
+void TokenWindow::reset(LexicalAnalyzer * _lexer) {
+    lexer = _lexer;
+    window.clear();
+    base = 0;
+    finished = false;
+}
+
+
+/**
+ * @brief 从词法分析器里取 token 直到有下标 i 的
+ * @return 有没有下标 i 的 token
+ */
+bool TokenWindow::_fill(int i) {
+    Token token;
+    while (base + int(window.size()) <= i && ! finished) {
+        if (lexer -> next(token))
+            window.push_back(token);
+        else
+            finished = true;
+    }
+    return i < base + int(window.size());
+}
+
+
+bool TokenWindow::has(int i) {
+    return i >= 0 && _fill(i);
+}
+
+
+/**
+ * @brief 下标 i 的 token，已经放掉的 token 不能再看
+ */
+const Token & TokenWindow::operator [] (int i) {
+    if (i < base)
+        throw Error("internal error, token " + std::to_string(i) + " was released before it is read");
+    return _fill(i) ? window[i - base] : end_token;
+}
+
+
+/**
+ * @brief 放掉下标 before 之前的 token，语法分析每开始一个语句调一次
+ */
+void TokenWindow::release(int before) {
+    while (base < before && ! window.empty()) {
+        window.pop_front();
+        base ++;
+    }
+}
@@ -0,0 +1,76 @@
+/**
+ * @file arena.h
+ * @brief 同一种对象的块分配器，分配只移动指针，用完一起析构
+ *
+ * 对象按块放，块不会移动，所以分配出去的指针一直有效，直到 clear
+ */
+
+#ifndef LLCC_ARENA_H
+#define LLCC_ARENA_H
+
+#include <new>
+#include <vector>
+#include <cstddef>
+#include <utility>
+#include <type_traits>
+
+using std::vector;
+
+
+template <class T>
+class Arena {
+private:
+    static const size_t BLOCK_SIZE = 512;     // 每块放几个对象
+
+    vector<T *> blocks;                       // 所有块，clear 之后留着接着用
+    size_t cur_block;                         // 正在用的块
+    size_t used;                              // 正在用的块里已经有几个对象
+
+public:
+    Arena() {
+        cur_block = used = 0;
+    }
+
+    ~Arena() {
+        clear();
+        for (T * block: blocks)
+            ::operator delete(block);
+    }
+
+    Arena(const Arena &) = delete;
+    Arena & operator = (const Arena &) = delete;
+
+    /**
+     * @brief 在块里构造一个对象
+     */
+    template <class... Args>
+    T * create(Args &&... args) {
+        if (used == BLOCK_SIZE) {
+            cur_block ++;
+            used = 0;
+        }
+        if (cur_block == blocks.size())
+            blocks.push_back((T *) ::operator new(sizeof(T) * BLOCK_SIZE));
+
+        T * object = blocks[cur_block] + used;
+        new (object) T(std::forward<Args>(args)...);
+        used ++;
+        return object;
+    }
+
+    /**
+     * @brief 析构所有对象，块留着下次用
+     */
+    void clear() {
+        if (! std::is_trivially_destructible<T>::value)
+            for (size_t i = 0; i <= cur_block && i < blocks.size(); i ++) {
+                size_t count = i < cur_block ? BLOCK_SIZE : used;
+                for (size_t j = 0; j < count; j ++)
+                    blocks[i][j].~T();
+            }
+        cur_block = used = 0;
+    }
+};
+
+
+#endif //LLCC_ARENA_H
@@ -8,99 +8,61 @@
 
 #include "quadruple.h"
 #include "str_tools.h"
+#include "inter_code_reader.h"
+#include "source_file.h"
 
-#include <regex>
 #include <string>
 #include <vector>
-#include <fstream>
 #include <iostream>
 
 using std::cout;
 using std::endl;
-using std::regex;
 using std::vector;
 using std::string;
-using std::ifstream;
-using std::regex_replace;
 
 
 /**
- * @brief 读取源文件
+ * @brief 打开源文件，打不开就报错退出
+ * @param source 源文件，内容映射在里面
  * @param path 文件路径
- * @return vector<string> 句子数组
  */
-vector<string> readSourceFile(string path) {
-    ifstream in_file;
-    in_file.open(path);
+void openSourceFile(SourceFile & source, string path) {
+    if (! source.open(path)) {
+        cout << "File error" << endl;
+        cout << "no file named `" << path << "`" << endl;
+        exit(0);
+    }
+}
 
-    vector<string> ret;
 
-    if (in_file.is_open()) {
-        string line;
-        while (getline(in_file, line))
-            ret.emplace_back(line);
-    }
-    else {
+
+/**
+ * @brief 打开中间代码文件，打不开就报错退出
+ * @param reader 读取器
+ * @param path 文件路径
+ */
+void openInterCodeFile(InterCodeReader & reader, string path) {
+    if (! reader.open(path)) {
         cout << "File error" << endl;
         cout << "no file named `" << path << "`" << endl;
         exit(0);
     }
-
-    return ret;
 }
 
 
-
 /**
  * @brief 读取中间代码文件
  * @param path 文件路径
- * @return vector<string> 句子数组
+ * @return vector<Quadruple> 四元式数组
  */
 vector<Quadruple> readInterCodeFile(string path) {
-    ifstream in_file;
-    in_file.open(path);
+    InterCodeReader reader;
+    openInterCodeFile(reader, path);
 
     vector<Quadruple> ret;
-
-    if (in_file.is_open()) {
-        string line;
-        while (getline(in_file, line)) {
-            if (line.size() <= 3) {
-                break;
-            }
-
-            int start = 0, len = 0, line_len = line.size();
-            while (start + len < line_len && line[start + len] != ',')
-                len ++;
-
-            INTER_CODE_OP_ENUM op = Quadruple::INTER_CODE_MAP[line.substr(start, len)];
-
-            start += len + 1;
-            len = 0;
-            while (start + len < line_len && ! (line[start + len] == ',' && line[start + len - 1] != '\\'))
-                len ++;
-            string arg1 = regex_replace(line.substr(start, len), regex("\\\\"), string(""));
-
-            start += len + 1;
-            len = 0;
-            while (start + len < line_len && line[start + len] != ',')
-                len ++;
-            string arg2 = line.substr(start, len);
-
-            start += len + 1;
-            len = 0;
-            while (start + len < line_len)
-                len ++;
-            string res = line.substr(start, len);
-
-            ret.emplace_back(Quadruple(op, arg1, arg2, res));
-        }
-    }
-    else {
-        cout << "File error" << endl;
-        cout << "no file named `" << path << "`" << endl;
-        exit(0);
-    }
+    Quadruple quadruple(INTER_CODE_OP_ENUM::HALT, "", "", "");
+    while (reader.next(quadruple))
+        ret.emplace_back(quadruple);
 
     return ret;
 }
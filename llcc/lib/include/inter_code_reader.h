@@ -0,0 +1,48 @@
+/**
+ * @file inter_code_reader.h
+ * @brief 流式读取中间代码文件 (.ic)，在固定大小的缓冲区里就地解析，内存占用和文件大小无关
+ */
+
+#ifndef LLCC_INTER_CODE_READER_H
+#define LLCC_INTER_CODE_READER_H
+
+#include "quadruple.h"
+
+#include <string>
+#include <vector>
+#include <cstdio>
+
+using std::string;
+using std::vector;
+
+#define INTER_CODE_BUFFER_SIZE (1 << 16)
+
+
+class InterCodeReader {
+private:
+    FILE * file;
+    vector<char> buffer;   // 只有一行比它还长时才扩大
+    size_t begin, end;     // 缓冲区里还没解析的部分 [begin, end)
+    bool eof;              // 文件读完了
+    bool stopped;          // 遇到了结束行
+    string scratch;        // 拼操作数文本用，查驻留表
+
+    uint32_t _intern(const char * data, size_t length);
+
+    bool _nextLine(const char * & line, size_t & length);
+    static INTER_CODE_OP_ENUM _opcode(const char * name, size_t length);
+
+public:
+    InterCodeReader();
+    ~InterCodeReader();
+    InterCodeReader(const InterCodeReader &) = delete;
+    InterCodeReader & operator = (const InterCodeReader &) = delete;
+
+    bool open(const string & path);
+    bool next(Quadruple & quadruple);
+    bool nextLineEntry(int & pc, int & line);
+    bool nextRecord(string & record);
+};
+
+
+#endif //LLCC_INTER_CODE_READER_H
@@ -0,0 +1,31 @@
+/**
+ * @file inter_code_writer.h
+ * @brief 写中间代码文件 (.ic)，代码生成器和链接器共用
+ *
+ * 文件布局: 每行一条四元式，然后是一个空行，之后是附加记录，读四元式的读取器读到空行就停:
+ *      LINE,pc,行号            从 pc 开始的代码来自源代码的这一行，只在行号变化时记
+ *      其他记录                 比如可重定位目标文件 (.ico) 的符号表和重定位表，见 InterCodeGenerator::saveObject
+ */
+
+#ifndef LLCC_INTER_CODE_WRITER_H
+#define LLCC_INTER_CODE_WRITER_H
+
+#include "quadruple.h"
+
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+#define INTER_CODE_OBJECT_VERSION 1 // 可重定位目标文件 (.ico) 记录格式的版本
+
+
+class InterCodeWriter {
+public:
+    static bool save(const string & path, const vector<Quadruple> & code, const vector<int> & lines,
+                     const vector<string> & records = vector<string>());
+};
+
+
+#endif //LLCC_INTER_CODE_WRITER_H
@@ -0,0 +1,38 @@
+/**
+ * @file operand_pool.h
+ * @brief 四元式操作数的驻留表，相同的操作数文本只存一份，四元式里只放 32 位编号
+ */
+
+#ifndef LLCC_OPERAND_POOL_H
+#define LLCC_OPERAND_POOL_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <unordered_map>
+
+using std::string;
+using std::vector;
+using std::unordered_map;
+
+#define OPERAND_NONE 0 // 空操作数的编号
+
+
+class OperandPool {
+private:
+    unordered_map<string, uint32_t> ids;   // 文本 -> 编号
+    vector<const string *> texts;          // 编号 -> 文本，指向 ids 里的 key，rehash 也不会失效
+
+public:
+    OperandPool();
+    OperandPool(const OperandPool &) = delete;
+    OperandPool & operator = (const OperandPool &) = delete;
+
+    uint32_t intern(const string & text);
+    const string & text(uint32_t id) const;
+    size_t size() const;
+    void clear();
+};
+
+
+#endif //LLCC_OPERAND_POOL_H
@@ -6,9 +6,12 @@
 #ifndef LLCC_QUADRUPLE_H
 #define LLCC_QUADRUPLE_H
 
+#include "operand_pool.h"
+
 #include <map>
 #include <string>
 #include <vector>
+#include <cstdint>
 #include <iomanip>
 #include <fstream>
 #include <iostream>
@@ -24,6 +27,10 @@ using std::setfill;
 using std::ostream;
 using std::ofstream;
 
+// CALL 在栈上写的链接字个数: 返回地址 + 调用者的帧指针，参数 i 在帧里的位置是 i - 参数个数 - FRAME_LINK_SIZE
+#define FRAME_LINK_SIZE 2
+
+// 不带前缀的运算都是整数 (int64) 运算，F 开头的是浮点 (double) 运算
 enum class INTER_CODE_OP_ENUM {
     /* arithmetic */
     ADD,
@@ -41,26 +48,69 @@ enum class INTER_CODE_OP_ENUM {
     MOV,   // 赋值
     PRINT, // 输出
     POP,
-    PUSH
+    PUSH,
+    /* float */
+    FADD,
+    FSUB,
+    FDIV,
+    FMUL,
+    FJE,
+    FJNE,
+    FJL,
+    FJG,
+    FMOV,
+    FPRINT,
+    ITOF,  // int -> double
+    FTOI,  // double -> int, 向 0 截断
+    /* function */
+    CALL,  // 保存返回地址和帧指针，跳到 res
+    RET,   // 弹出 res 个参数，回到调用者
+    ENTER, // 当前栈帧的大小，pc 0 处的是全局变量
+    HALT   // 停机
 };
 
 
 /**
- * @brief 四元式类
+ * @brief 四元式类，16 字节: 操作符 + 三个操作数在 OPERAND_POOL 里的编号，文本只在输出时取出来
+ *        OPERAND_POOL 是本线程当前 OperandScope 的驻留表，编号只在这个 scope 里有效
  */
 class Quadruple {
 public:
     static vector<string> INTER_CODE_OP;
     static map<string, INTER_CODE_OP_ENUM> INTER_CODE_MAP;
     static map<string, INTER_CODE_OP_ENUM> COUNTERPART_INTER_CODE_MAP;
+    static map<INTER_CODE_OP_ENUM, INTER_CODE_OP_ENUM> FLOAT_INTER_CODE_MAP;
+    static thread_local OperandPool * OPERAND_POOL;
 
     INTER_CODE_OP_ENUM op;
-    string res, arg1, arg2;
+    uint32_t arg1, arg2, res;
+
+    Quadruple(INTER_CODE_OP_ENUM _op, const string & _arg1,
+              const string & _arg2, const string & _res);
+    Quadruple(INTER_CODE_OP_ENUM _op, uint32_t _arg1, uint32_t _arg2, uint32_t _res);
+
+    static uint32_t intern(const string & text);
+    static const string & text(uint32_t id);
+
+    friend ostream & operator << (ostream &out, const Quadruple & q);
+};
+
+
+/**
+ * @brief 一次编译的操作数驻留表，活着的时候本线程新的四元式都驻留到这里，析构时文本一起放掉
+ *        可以嵌套，析构后恢复外层的驻留表；四元式不能带出它所在的 scope
+ */
+class OperandScope {
+public:
+    OperandScope();
+    ~OperandScope();
 
-    Quadruple(INTER_CODE_OP_ENUM _op, string arg1,
-              string _arg2, string _res);
+    OperandScope(const OperandScope &) = delete;
+    OperandScope & operator = (const OperandScope &) = delete;
 
-    friend ostream & operator << (ostream &out, Quadruple & q);
+private:
+    OperandPool pool;
+    OperandPool * outer;
 };
 
 
@@ -0,0 +1,39 @@
+/**
+ * @file source_file.h
+ * @brief 源文件，能映射就只读映射整个文件，词法分析直接在映射上扫描，不按行拷贝
+ */
+
+#ifndef LLCC_SOURCE_FILE_H
+#define LLCC_SOURCE_FILE_H
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+using std::string;
+using std::vector;
+
+
+class SourceFile {
+private:
+    const char * content;   // 文件内容，不以 '\0' 结尾
+    size_t length;
+    void * mapping;         // 映射的文件，没有是 nullptr
+    size_t mapping_size;
+    vector<char> storage;   // 不能映射的时候读到这里
+
+    void _release();
+
+public:
+    SourceFile();
+    ~SourceFile();
+    SourceFile(const SourceFile &) = delete;
+    SourceFile & operator = (const SourceFile &) = delete;
+
+    bool open(const string & path);
+    const char * data() const;
+    size_t size() const;
+};
+
+
+#endif //LLCC_SOURCE_FILE_H
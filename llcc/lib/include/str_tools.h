@@ -123,14 +123,11 @@ inline string double2string(double x) {
  * @return string，返回string
  */
 inline string token2string(TOKEN_TYPE_ENUM type) {
-    if (int(type) < int(Token::TOKEN_TYPE.size()))
+    if (type <= TOKEN_TYPE_ENUM::STRING_CONSTANT)
     return Token::TOKEN_TYPE[int(type)];
 
-    for (auto iter = Token::DETAIL_TOKEN_TYPE.begin(); iter != Token::DETAIL_TOKEN_TYPE.end(); iter ++)
-        if (iter -> second == type)
-            return iter -> first;
-
-    return "";
+    const char * text = Token::spelling(type);
+    return text ? text : "";
 }
 
 
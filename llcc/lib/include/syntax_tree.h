@@ -5,8 +5,13 @@
 #ifndef LLCC_SYNTAX_TREE_H
 #define LLCC_SYNTAX_TREE_H
 
+#include "arena.h"
+#include "operand_pool.h"
+
 #include <vector>
 #include <string>
+#include <cstdint>
+#include <utility>
 #include <iostream>
 #include <algorithm>
 using std::cout;
@@ -16,19 +21,69 @@ using std::vector;
 using std::string;
 
 
+/**
+ * @brief 语法树节点的种类，中间代码生成按种类 switch
+ */
+enum class SYNTAX_NODE_ENUM : uint8_t {
+    TEXT = 0,                   // 叶子，标识符、常量、运算符这些原文放在 value 里
+    CLASS,                      // 根节点，类名放在 value 里
+    STATEMENT,
+    ASSIGNMENT,
+    PRINT,
+    BLOCK,
+    RETURN,
+    VOID_RETURN,
+    TYPE,
+    FUNCTION_STATEMENT,
+    FUNCTION_NAME,
+    FUNCTION_CALL,
+    FUNCTION_PARAMETERS,
+    PARAM,
+    PARAMETER,
+    PARAMETER_LIST,
+    CONTROL_IF,
+    CONTROL_WHILE,
+    CONTROL_CONDITION,
+    CONDITION,
+    ARRAY_INDEX,
+    EXPRESSION_CONSTANT,
+    EXPRESSION_STRING,
+    EXPRESSION_VARIABLE,
+    EXPRESSION_ARRAY_ITEM,
+    EXPRESSION_OPERATOR,
+    EXPRESSION_UNI_OP,
+    EXPRESSION_BOOL_UNI_OP,
+    EXPRESSION_DOUBLE_OP,
+    EXPRESSION_BOOL_DOUBLE_OP,
+    /* for 里暂时挂第三个赋值语句的节点 */
+    NONE
+};
+
+
+class SyntaxTreeArena;
+
+
+/**
+ * @brief 语法树节点，64 字节: 四个指针 + 三个文本在 SyntaxTreeArena 里的编号 + 编号、位置、种类
+ *
+ * 回填用的 true_list / false_list / next_list 不放在节点里，中间代码生成器按 id 另外存
+ */
 class SyntaxTreeNode {
 public:
-    string value, type, extra_info;
-    int line_number, pos;
+    static const char * const KIND_NAME[int(SYNTAX_NODE_ENUM::NONE) + 1];   // 种类的名字，输出语法树用
 
     // 孩子-兄弟表示法
     SyntaxTreeNode * left, * right; // left 是左兄弟, right 是右边兄弟
     SyntaxTreeNode * father, * first_son; // father 是父节点, first_son 是第一个子节点
-    vector<int> true_list, false_list, next_list;
 
-    SyntaxTreeNode(string _value, string _type = "", string _extra_info = "");
-    SyntaxTreeNode(string _value, int _line_number, int _pos);
-    SyntaxTreeNode(string _value, string _type, string _extra_info, int _line_number, int _pos);
+    uint32_t value, type, extra_info;   // 文本在分配它的 SyntaxTreeArena 里的编号，0 是空串
+    uint32_t id;                        // 这次编译里的第几个节点
+    int32_t line_number;
+    int32_t pos;
+    SYNTAX_NODE_ENUM kind;
+
+    SyntaxTreeNode(SYNTAX_NODE_ENUM _kind, uint32_t _value, uint32_t _type, uint32_t _extra_info,
+                   uint32_t _id, int _line_number, int _pos);
 };
 
 
@@ -38,10 +93,56 @@ private:
 
 public:
     SyntaxTreeNode * root, * cur_node;
-    SyntaxTree(SyntaxTreeNode * _root = nullptr);
+    const SyntaxTreeArena * arena;      // 节点的文本存在这里
+    SyntaxTree(const SyntaxTreeArena * _arena, SyntaxTreeNode * _root = nullptr);
 
     void addNode(SyntaxTreeNode * child_node, SyntaxTreeNode * father_node = nullptr);
     void display(bool verbose = false);
 };
 
+
+/**
+ * @brief 一次编译的语法树节点、子树和节点的文本都从这里分配，生成完中间代码一起释放
+ */
+class SyntaxTreeArena {
+private:
+    Arena<SyntaxTreeNode> nodes;
+    Arena<SyntaxTree> trees;
+    OperandPool texts;                  // 节点的文本，相同的只存一份
+    uint32_t node_count;                // 分配出去的节点数，也是下一个节点的 id
+
+public:
+    SyntaxTreeArena();
+
+    SyntaxTreeNode * newNode(SYNTAX_NODE_ENUM kind, const string & value, const string & type,
+                             const string & extra_info, int line_number, int pos);
+
+    SyntaxTreeNode * newNode(SYNTAX_NODE_ENUM kind, int line_number, int pos) {
+        return nodes.create(kind, 0, 0, 0, node_count ++, line_number, pos);
+    }
+
+    SyntaxTreeNode * newNode(SYNTAX_NODE_ENUM kind, const string & value, int line_number, int pos) {
+        return newNode(kind, value, "", "", line_number, pos);
+    }
+
+    SyntaxTreeNode * newNode(const string & value, int line_number, int pos) {
+        return newNode(SYNTAX_NODE_ENUM::TEXT, value, "", "", line_number, pos);
+    }
+
+    SyntaxTreeNode * newNode(const string & value, const string & type, const string & extra_info,
+                             int line_number, int pos) {
+        return newNode(SYNTAX_NODE_ENUM::TEXT, value, type, extra_info, line_number, pos);
+    }
+
+    SyntaxTree * newTree(SyntaxTreeNode * _root = nullptr) {
+        return trees.create(this, _root);
+    }
+
+    uint32_t intern(const string & text) { return texts.intern(text); }
+    const string & text(uint32_t id) const { return texts.text(id); }
+    string name(const SyntaxTreeNode * node) const;
+
+    void release();
+};
+
 #endif //LLCC_SYNTAX_TREE_H
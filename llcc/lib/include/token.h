@@ -5,14 +5,12 @@
 #ifndef LLCC_TOKEN_HPP
 #define LLCC_TOKEN_HPP
 
-#include <map>
-#include <vector>
 #include <string>
+#include <cstddef>
+#include <cstdint>
 #include <iostream>
 
-using std::vector;
 using std::string;
-using std::map;
 using std::ostream;
 
 
@@ -83,28 +81,44 @@ enum class TOKEN_TYPE_ENUM {
 
 
 /**
- * @brief Token 类
+ * @brief 关键字、运算符、分隔符的写法和具体类别
+ */
+struct TokenSpelling {
+    const char * text;
+    int length;
+    TOKEN_TYPE_ENUM type;
+};
+
+
+/**
+ * @brief Token 类，不存值，只记在源文件里的位置和长度，值要从源文件里取
  */
 class Token {
 public:
-    string value;                                           // 值
+    uint32_t offset;                                        // 在源文件里的位置
+    uint32_t length;                                        // 长度
     int line_number;                                        // 行号
     int pos;                                                // 行中位置
     TOKEN_TYPE_ENUM type;
 
-    Token(string _value = "", TOKEN_TYPE_ENUM = TOKEN_TYPE_ENUM::NONE, int _pos = -1, int _line_number  = -1);
+    Token();
+    Token(const char * source, size_t _offset, size_t _length, TOKEN_TYPE_ENUM _type, int _pos, int _line_number);
 
-    static vector<string> TOKEN_TYPE;                       // Token 种类
-    static map<string, TOKEN_TYPE_ENUM> DETAIL_TOKEN_TYPE;  // 将关键字、运算符、分隔符进行具体化
-    static vector<string> KEYWORDS;                         // 关键字
-    static vector<string> OPERATORS;                        // 运算符
-    static vector<char> SEPARATORS;                         // 分隔符
+    string value(const char * source) const;                // 从源文件里取值
+    void display(ostream & out, const char * source) const; // 输出 token
 
+    static const char * const TOKEN_TYPE[int(TOKEN_TYPE_ENUM::STRING_CONSTANT) + 1]; // Token 种类
+
+    // 关键字、运算符、分隔符的具体类别，查编译时生成的完美哈希表
+    static TOKEN_TYPE_ENUM detailType(const char * text, size_t length);
+    static TOKEN_TYPE_ENUM detailType(const string & text);
+    static const char * spelling(TOKEN_TYPE_ENUM t);        // 具体类别的写法，没有返回 nullptr
+    static bool isKeyword(const char * text, size_t length); // 是否是关键字
+    static bool isSeparator(char ch);                       // 是否是分隔符
+    static bool isOperator(char ch);                        // 是否是运算符的第一个字符
     static bool isExpressionOperator(TOKEN_TYPE_ENUM t);    // 是否是表达式中的运算符
     static bool isBoolOperator(TOKEN_TYPE_ENUM t);          // 是否是bool运算符
     static bool isUniOperator(TOKEN_TYPE_ENUM t);           // 是不是一元输入法
-
-    friend ostream & operator << (ostream &out, Token & t);
 };
 
 
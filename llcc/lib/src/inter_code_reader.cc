@@ -0,0 +1,188 @@
+/**
+ * @file inter_code_reader.cc
+ * @brief 中间代码文件读取具体实现
+ */
+
+#include "../include/inter_code_reader.h"
+
+#include <cstring>
+
+
+InterCodeReader::InterCodeReader() {
+    file = nullptr;
+    begin = end = 0;
+    eof = stopped = false;
+}
+
+
+InterCodeReader::~InterCodeReader() {
+    if (file)
+        fclose(file);
+}
+
+
+/**
+ * @brief 打开中间代码文件
+ * @return 能不能打开
+ */
+bool InterCodeReader::open(const string & path) {
+    FILE * f = fopen(path.c_str(), "rb");
+    if (! f)
+        return false;
+
+    if (file)
+        fclose(file);
+    file = f;
+    buffer.resize(INTER_CODE_BUFFER_SIZE);
+    begin = end = 0;
+    eof = stopped = false;
+    return true;
+}
+
+
+/**
+ * @brief 取下一行，不含换行符，指向缓冲区，下次调用前有效
+ * @return 还有没有
+ */
+bool InterCodeReader::_nextLine(const char * & line, size_t & length) {
+    size_t scanned = begin;
+    while (true) {
+        const char * newline = (const char *) memchr(buffer.data() + scanned, '\n', end - scanned);
+        if (newline) {
+            line = buffer.data() + begin;
+            length = newline - line;
+            begin += length + 1;
+            return true;
+        }
+        if (eof) {
+            if (begin == end)
+                return false;
+            // 最后一行没有换行符
+            line = buffer.data() + begin;
+            length = end - begin;
+            begin = end;
+            return true;
+        }
+
+        // 剩下的半行挪到开头，一行装不下就扩大缓冲区
+        scanned = end - begin;
+        memmove(buffer.data(), buffer.data() + begin, scanned);
+        begin = 0;
+        end = scanned;
+        if (end == buffer.size())
+            buffer.resize(buffer.size() * 2);
+
+        size_t got = fread(buffer.data() + end, 1, buffer.size() - end, file);
+        end += got;
+        if (got == 0)
+            eof = true;
+    }
+}
+
+
+/**
+ * @brief 指令名 -> 指令，不认识的和原来查表一样当作 ADD
+ */
+INTER_CODE_OP_ENUM InterCodeReader::_opcode(const char * name, size_t length) {
+    int l = Quadruple::INTER_CODE_OP.size();
+    for (int i = 0; i < l; i ++) {
+        const string & op = Quadruple::INTER_CODE_OP[i];
+        if (op.size() == length && memcmp(op.data(), name, length) == 0)
+            return INTER_CODE_OP_ENUM(i);
+    }
+
+    // 运算符写法 (+, ==, ...)
+    auto it = Quadruple::INTER_CODE_MAP.find(string(name, length));
+    return it == Quadruple::INTER_CODE_MAP.end() ? INTER_CODE_OP_ENUM::ADD : it -> second;
+}
+
+
+/**
+ * @brief 驻留一段操作数文本，scratch 的空间反复用
+ */
+uint32_t InterCodeReader::_intern(const char * data, size_t length) {
+    if (length == 0)
+        return OPERAND_NONE;
+    scratch.assign(data, length);
+    return Quadruple::intern(scratch);
+}
+
+
+/**
+ * @brief 读下一条四元式，操作数驻留到当前 OperandScope 的 Quadruple::OPERAND_POOL 里
+ * @return 还有没有，不超过 3 个字符的行 (空行) 表示结束
+ */
+bool InterCodeReader::next(Quadruple & quadruple) {
+    const char * line;
+    size_t length;
+    if (stopped || ! file || ! _nextLine(line, length))
+        return false;
+    if (length <= 3) {
+        stopped = true;
+        return false;
+    }
+
+    size_t start = 0, len = 0;
+    while (start + len < length && line[start + len] != ',')
+        len ++;
+    quadruple.op = _opcode(line + start, len);
+
+    // 字符串常量里的逗号转义成了 \,，去掉所有的 '\'
+    start += len + 1;
+    len = 0;
+    while (start + len < length && ! (line[start + len] == ',' && line[start + len - 1] != '\\'))
+        len ++;
+    scratch.clear();
+    for (size_t i = start; i < start + len && i < length; i ++)
+        if (line[i] != '\\')
+            scratch.push_back(line[i]);
+    quadruple.arg1 = Quadruple::intern(scratch);
+
+    start += len + 1;
+    len = 0;
+    while (start + len < length && line[start + len] != ',')
+        len ++;
+    quadruple.arg2 = start < length ? _intern(line + start, len) : OPERAND_NONE;
+
+    start += len + 1;
+    quadruple.res = start < length ? _intern(line + start, length - start) : OPERAND_NONE;
+
+    return true;
+}
+
+
+/**
+ * @brief 四元式读完以后，读结束行后面的行号表 LINE,pc,行号，跳过别的记录
+ * @return 还有没有，没有行号表的旧文件直接返回 false
+ */
+bool InterCodeReader::nextLineEntry(int & pc, int & line) {
+    while (nextRecord(scratch)) {
+        if (scratch.compare(0, 5, "LINE,") != 0)
+            continue;
+        if (sscanf(scratch.c_str() + 5, "%d,%d", &pc, &line) == 2)
+            return true;
+    }
+    return false;
+}
+
+
+/**
+ * @brief 四元式读完以后，读结束行后面的下一条记录，跳过空行
+ * @return 还有没有
+ */
+bool InterCodeReader::nextRecord(string & record) {
+    const char * text;
+    size_t length;
+    if (! stopped || ! file)
+        return false;
+
+    while (_nextLine(text, length)) {
+        if (length > 0 && text[length - 1] == '\r')
+            length --;
+        if (length == 0)
+            continue;
+        record.assign(text, length);
+        return true;
+    }
+    return false;
+}
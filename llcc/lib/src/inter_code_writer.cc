@@ -0,0 +1,53 @@
+/**
+ * @file inter_code_writer.cc
+ * @brief 写中间代码文件具体实现
+ */
+
+#include "../include/inter_code_writer.h"
+
+#include <regex>
+#include <fstream>
+#include <algorithm>
+
+using std::endl;
+using std::regex;
+using std::ofstream;
+using std::regex_replace;
+
+
+/**
+ * @brief 保存到文件
+ * @param lines 每条四元式的源代码行号，可以是空的
+ * @param records 行号表后面的附加记录，每个一行
+ * @return 能不能写
+ */
+bool InterCodeWriter::save(const string & path, const vector<Quadruple> & code, const vector<int> & lines,
+                           const vector<string> & records) {
+    ofstream out_file;
+    out_file.open(path, ofstream::out | ofstream::trunc);
+    if (! out_file.is_open())
+        return false;
+
+    for (auto & ic: code) {
+        string arg1 = Quadruple::text(ic.arg1);
+        // 字符串常量里的逗号转义
+        if (! arg1.empty() && arg1[0] == '\"') {
+            arg1 = regex_replace(arg1, regex(","), string("\\,"));
+            arg1 = regex_replace(arg1, regex("\\\\"), string("\\\\"));
+        }
+        out_file << Quadruple::INTER_CODE_OP[int(ic.op)] << "," << arg1 << ","
+                 << Quadruple::text(ic.arg2) << "," << Quadruple::text(ic.res) << endl;
+    }
+
+    // 读到空行就停的旧读取器会忽略后面的记录
+    out_file << endl;
+    int l = std::min(lines.size(), code.size());
+    for (int i = 0; i < l; i ++)
+        if (i == 0 || lines[i] != lines[i - 1])
+            out_file << "LINE," << i << "," << lines[i] << endl;
+    for (auto & record: records)
+        out_file << record << endl;
+
+    out_file.close();
+    return ! out_file.fail();
+}
@@ -0,0 +1,49 @@
+/**
+ * @file operand_pool.cc
+ * @brief 操作数驻留表具体实现
+ */
+
+#include "../include/operand_pool.h"
+
+
+/**
+ * @brief 构造函数，0 号是空操作数
+ */
+OperandPool::OperandPool() {
+    intern("");
+}
+
+
+/**
+ * @brief 取操作数的编号，没见过的新分配一个
+ */
+uint32_t OperandPool::intern(const string & text) {
+    auto it = ids.find(text);
+    if (it != ids.end())
+        return it -> second;
+
+    uint32_t id = texts.size();
+    it = ids.emplace(text, id).first;
+    texts.emplace_back(&it -> first);
+    return id;
+}
+
+
+const string & OperandPool::text(uint32_t id) const {
+    return * texts[id];
+}
+
+
+size_t OperandPool::size() const {
+    return texts.size();
+}
+
+
+/**
+ * @brief 放掉所有文本，连同哈希表的桶一起，之后只剩 0 号空操作数
+ */
+void OperandPool::clear() {
+    unordered_map<string, uint32_t>().swap(ids);
+    vector<const string *>().swap(texts);
+    intern("");
+}
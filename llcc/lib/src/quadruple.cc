@@ -9,7 +9,11 @@
 vector<string> Quadruple::INTER_CODE_OP = {
         "ADD", "SUB", "DIV", "MUL", "MOD",
         "J", "JE", "JNE", "JL", "JG",
-        "MOV", "PRINT", "POP", "PUSH"
+        "MOV", "PRINT", "POP", "PUSH",
+        "FADD", "FSUB", "FDIV", "FMUL",
+        "FJE", "FJNE", "FJL", "FJG",
+        "FMOV", "FPRINT", "ITOF", "FTOI",
+        "CALL", "RET", "ENTER", "HALT"
 };
 
 
@@ -42,6 +46,24 @@ map<string, INTER_CODE_OP_ENUM> Quadruple::INTER_CODE_MAP = {
         {"PRINT", INTER_CODE_OP_ENUM::PRINT},
         {"POP", INTER_CODE_OP_ENUM::POP},
         {"PUSH", INTER_CODE_OP_ENUM::PUSH},
+
+        {"FADD", INTER_CODE_OP_ENUM::FADD},
+        {"FSUB", INTER_CODE_OP_ENUM::FSUB},
+        {"FMUL", INTER_CODE_OP_ENUM::FMUL},
+        {"FDIV", INTER_CODE_OP_ENUM::FDIV},
+        {"FJE", INTER_CODE_OP_ENUM::FJE},
+        {"FJNE", INTER_CODE_OP_ENUM::FJNE},
+        {"FJG", INTER_CODE_OP_ENUM::FJG},
+        {"FJL", INTER_CODE_OP_ENUM::FJL},
+        {"FMOV", INTER_CODE_OP_ENUM::FMOV},
+        {"FPRINT", INTER_CODE_OP_ENUM::FPRINT},
+        {"ITOF", INTER_CODE_OP_ENUM::ITOF},
+        {"FTOI", INTER_CODE_OP_ENUM::FTOI},
+
+        {"CALL", INTER_CODE_OP_ENUM::CALL},
+        {"RET", INTER_CODE_OP_ENUM::RET},
+        {"ENTER", INTER_CODE_OP_ENUM::ENTER},
+        {"HALT", INTER_CODE_OP_ENUM::HALT},
 };
 
 
@@ -52,26 +74,93 @@ map<string, INTER_CODE_OP_ENUM> Quadruple::COUNTERPART_INTER_CODE_MAP = {
         {"<", INTER_CODE_OP_ENUM::JG},
 };
 
+
+// 整数运算对应的浮点运算
+map<INTER_CODE_OP_ENUM, INTER_CODE_OP_ENUM> Quadruple::FLOAT_INTER_CODE_MAP = {
+        {INTER_CODE_OP_ENUM::ADD, INTER_CODE_OP_ENUM::FADD},
+        {INTER_CODE_OP_ENUM::SUB, INTER_CODE_OP_ENUM::FSUB},
+        {INTER_CODE_OP_ENUM::MUL, INTER_CODE_OP_ENUM::FMUL},
+        {INTER_CODE_OP_ENUM::DIV, INTER_CODE_OP_ENUM::FDIV},
+        {INTER_CODE_OP_ENUM::JE, INTER_CODE_OP_ENUM::FJE},
+        {INTER_CODE_OP_ENUM::JNE, INTER_CODE_OP_ENUM::FJNE},
+        {INTER_CODE_OP_ENUM::JG, INTER_CODE_OP_ENUM::FJG},
+        {INTER_CODE_OP_ENUM::JL, INTER_CODE_OP_ENUM::FJL},
+        {INTER_CODE_OP_ENUM::MOV, INTER_CODE_OP_ENUM::FMOV},
+        {INTER_CODE_OP_ENUM::PRINT, INTER_CODE_OP_ENUM::FPRINT},
+};
+
+// 不在任何 OperandScope 里时用的驻留表，每个线程一个
+static thread_local OperandPool THREAD_OPERAND_POOL;
+
+thread_local OperandPool * Quadruple::OPERAND_POOL = & THREAD_OPERAND_POOL;
+
+static_assert(sizeof(Quadruple) == 16, "Quadruple should stay an opcode plus three 32-bit operand ids");
+
+
 /**
  * @brief 四元式构造函数
  */
-Quadruple::Quadruple(INTER_CODE_OP_ENUM _op, string _arg1, string _arg2, string _res) {
+Quadruple::Quadruple(INTER_CODE_OP_ENUM _op, const string & _arg1, const string & _arg2, const string & _res) {
     op = _op;
-    arg1 = move(_arg1);
-    arg2 = move(_arg2);
-    res = move(_res);
+    arg1 = intern(_arg1);
+    arg2 = intern(_arg2);
+    res = intern(_res);
+}
+
+
+/**
+ * @brief 四元式构造函数，操作数是已经驻留的编号
+ */
+Quadruple::Quadruple(INTER_CODE_OP_ENUM _op, uint32_t _arg1, uint32_t _arg2, uint32_t _res) {
+    op = _op;
+    arg1 = _arg1;
+    arg2 = _arg2;
+    res = _res;
+}
+
+
+/**
+ * @brief 操作数文本 -> 编号
+ */
+uint32_t Quadruple::intern(const string & text) {
+    return OPERAND_POOL -> intern(text);
+}
+
+
+/**
+ * @brief 编号 -> 操作数文本
+ */
+const string & Quadruple::text(uint32_t id) {
+    return OPERAND_POOL -> text(id);
+}
+
+
+/**
+ * @brief 打开一个驻留表，之后本线程的四元式都驻留到这里
+ */
+OperandScope::OperandScope() {
+    outer = Quadruple::OPERAND_POOL;
+    Quadruple::OPERAND_POOL = & pool;
+}
+
+
+/**
+ * @brief 恢复外层的驻留表，这个 scope 里的操作数文本随 pool 一起释放
+ */
+OperandScope::~OperandScope() {
+    Quadruple::OPERAND_POOL = outer;
 }
 
 
 /**
  * @brief 四元式输出流
  */
-ostream & operator << (ostream & out, Quadruple & q) {
+ostream & operator << (ostream & out, const Quadruple & q) {
     out << "(";
     out << setw(6) << setfill (' ') << Quadruple::INTER_CODE_OP[int(q.op)] << ", ";
-    out << setw(6) << setfill (' ') << q.arg1 << ", ";
-    out << setw(6) << setfill (' ') << q.arg2 << ", ";
-    out << setw(6) << setfill (' ') << q.res;
+    out << setw(6) << setfill (' ') << Quadruple::text(q.arg1) << ", ";
+    out << setw(6) << setfill (' ') << Quadruple::text(q.arg2) << ", ";
+    out << setw(6) << setfill (' ') << Quadruple::text(q.res);
     out << ")" << endl;
 
     return out;
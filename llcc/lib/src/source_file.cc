@@ -0,0 +1,98 @@
+/**
+ * @file source_file.cc
+ * @brief 源文件具体实现
+ */
+
+#include "../include/source_file.h"
+
+#include <cstdio>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+
+SourceFile::SourceFile() {
+    content = "";
+    length = 0;
+    mapping = nullptr;
+    mapping_size = 0;
+}
+
+
+SourceFile::~SourceFile() {
+    _release();
+}
+
+
+/**
+ * @brief 解除映射，放掉读进来的内容
+ */
+void SourceFile::_release() {
+#if defined(__unix__) || defined(__APPLE__)
+    if (mapping)
+        munmap(mapping, mapping_size);
+#endif
+    mapping = nullptr;
+    mapping_size = 0;
+    storage.clear();
+    content = "";
+    length = 0;
+}
+
+
+/**
+ * @brief 打开源文件，空文件和不能映射的文件整个读进来
+ * @return 能不能打开
+ */
+bool SourceFile::open(const string & path) {
+    _release();
+
+#if defined(__unix__) || defined(__APPLE__)
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        void * mapped = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped != MAP_FAILED) {
+            mapping = mapped;
+            mapping_size = st.st_size;
+            content = (const char *) mapped;
+            length = st.st_size;
+            close(fd);
+            return true;
+        }
+    }
+    close(fd);
+#endif
+
+    FILE * f = fopen(path.c_str(), "rb");
+    if (! f)
+        return false;
+
+    char buffer[1 << 16];
+    size_t got;
+    while ((got = fread(buffer, 1, sizeof(buffer), f)) > 0)
+        storage.insert(storage.end(), buffer, buffer + got);
+    bool ok = ! ferror(f);
+    fclose(f);
+
+    content = storage.empty() ? "" : storage.data();
+    length = storage.size();
+    return ok;
+}
+
+
+const char * SourceFile::data() const {
+    return content;
+}
+
+
+size_t SourceFile::size() const {
+    return length;
+}
@@ -4,53 +4,41 @@
  */
 #include "../include/syntax_tree.h"
 
+const char * const SyntaxTreeNode::KIND_NAME[int(SYNTAX_NODE_ENUM::NONE) + 1] = {
+        "", "Class-", "Statement", "Assignment", "Print", "Block", "Return", "VoidReturn", "Type",
+        "FunctionStatement", "FunctionName", "FunctionCall", "FunctionParameters", "Param", "Parameter",
+        "ParameterList", "Control-If", "Control-While", "Control-Condition", "Condition", "Array-Index",
+        "Expression-Constant", "Expression-String", "Expression-Variable", "Expression-ArrayItem",
+        "Expression-Operator", "Expression-UniOp", "Expression-Bool-UniOp", "Expression-DoubleOp",
+        "Expression-Bool-DoubleOp", ""
+};
+
+
 /**
  * @brief 语法树节点构造函数
+ * @param _value, _type, _extra_info 文本在 SyntaxTreeArena 里的编号
+ * @param _id 这次编译里的第几个节点，由 SyntaxTreeArena 给
  */
-SyntaxTreeNode::SyntaxTreeNode(string _value, string _type, string _extra_info) {
+SyntaxTreeNode::SyntaxTreeNode(SYNTAX_NODE_ENUM _kind, uint32_t _value, uint32_t _type, uint32_t _extra_info,
+                               uint32_t _id, int _line_number, int _pos) {
     left = right = father = first_son = nullptr;
 
-    value = move(_value);
-    type = move(_type);
-    extra_info = move(_extra_info);
-
-    true_list.clear();
-    false_list.clear();
-    next_list.clear();
-}
-
-
-SyntaxTreeNode::SyntaxTreeNode(string _value, int _line_number, int _pos) {
-    left = right = father = first_son = nullptr;
-
-    value = move(_value);
+    kind = _kind;
+    value = _value;
+    type = _type;
+    extra_info = _extra_info;
+    id = _id;
     line_number = _line_number;
     pos = _pos;
-
-    true_list.clear();
-    false_list.clear();
-    next_list.clear();
 }
 
-SyntaxTreeNode::SyntaxTreeNode(string _value, string _type, string _extra_info, int _line_number, int _pos) {
-    left = right = father = first_son = nullptr;
-
-    value = move(_value);
-    type = move(_type);
-    extra_info = move(_extra_info);
-    line_number = _line_number;
-    pos = _pos;
-
-    true_list.clear();
-    false_list.clear();
-    next_list.clear();
-}
 
 /**
  * @brief 语法树构造函数
  */
-SyntaxTree::SyntaxTree(SyntaxTreeNode * _root) {
+SyntaxTree::SyntaxTree(const SyntaxTreeArena * _arena, SyntaxTreeNode * _root) {
     root = cur_node = _root;
+    arena = _arena;
 }
 
 
@@ -88,7 +76,7 @@ void SyntaxTree::addNode(SyntaxTreeNode * child_node, SyntaxTreeNode * father_no
          else
              cout << "│   ";
      }
-     cout << (cur -> right ? "├── " : "└── " ) << cur -> value;
+     cout << (cur -> right ? "├── " : "└── " ) << arena -> name(cur);
     */
 
      // 这里的trick是状态压缩，提高速度
@@ -99,35 +87,17 @@ void SyntaxTree::addNode(SyntaxTreeNode * child_node, SyntaxTreeNode * father_no
          else
              cout << "|   ";
      }
-     cout << (cur -> right ? "|-- " : "\\-- " ) << cur -> value;
+     cout << (cur -> right ? "|-- " : "\\-- " ) << arena -> name(cur);
 
      // 除了 value 之外的信息
      if (verbose) {
-         if (cur -> type != "" && cur -> extra_info != "")
-             cout << " (type: " << cur -> type << ", extra_info: " << cur -> extra_info << ")";
-         else if (cur -> type != "")
-             cout << " (type: " << cur -> type << ")";
-         else if (cur -> extra_info != "")
-             cout << " (extra_info: " << cur -> extra_info << ")";
-
-         if (! cur -> true_list.empty()) {
-             cout << " true_list = { ";
-             for (auto tl: cur -> true_list)
-                 cout << tl << ", ";
-             cout << "} ";
-         }
-         if (! cur -> false_list.empty()) {
-             cout << " false_list = { ";
-             for (auto tl: cur -> false_list)
-                 cout << tl << ", ";
-             cout << "} ";
-         }
-         if (! cur -> next_list.empty()) {
-             cout << " next_list = { ";
-             for (auto tl: cur -> next_list)
-                 cout << tl << ", ";
-             cout << "} ";
-         }
+         if (cur -> type && cur -> extra_info)
+             cout << " (type: " << arena -> text(cur -> type) << ", extra_info: "
+                  << arena -> text(cur -> extra_info) << ")";
+         else if (cur -> type)
+             cout << " (type: " << arena -> text(cur -> type) << ")";
+         else if (cur -> extra_info)
+             cout << " (extra_info: " << arena -> text(cur -> extra_info) << ")";
      }
 
      cout << endl;
@@ -151,7 +121,45 @@ void SyntaxTree::addNode(SyntaxTreeNode * child_node, SyntaxTreeNode * father_no
  * @brief 打印语法树
  */
  void SyntaxTree::display(bool verbose) {
-     cout << root -> value << endl;
+     cout << arena -> name(root) << endl;
      dfs(root -> first_son, 0, 0, verbose);
      cout << endl;
  }
+
+
+SyntaxTreeArena::SyntaxTreeArena() {
+    node_count = 0;
+}
+
+
+/**
+ * @brief 分配一个节点，文本都驻留到 texts 里
+ */
+SyntaxTreeNode * SyntaxTreeArena::newNode(SYNTAX_NODE_ENUM kind, const string & value, const string & type,
+                                          const string & extra_info, int line_number, int pos) {
+    return nodes.create(kind, texts.intern(value), texts.intern(type), texts.intern(extra_info),
+                        node_count ++, line_number, pos);
+}
+
+
+/**
+ * @brief 节点输出时的样子: 叶子是原文，别的是种类名
+ */
+string SyntaxTreeArena::name(const SyntaxTreeNode * node) const {
+    if (node -> kind == SYNTAX_NODE_ENUM::TEXT)
+        return text(node -> value);
+    if (node -> kind == SYNTAX_NODE_ENUM::CLASS)
+        return SyntaxTreeNode::KIND_NAME[int(node -> kind)] + text(node -> value);
+    return SyntaxTreeNode::KIND_NAME[int(node -> kind)];
+}
+
+
+/**
+ * @brief 释放所有节点、子树和文本，之后从这里分配的指针和文本编号都不能再用
+ */
+void SyntaxTreeArena::release() {
+    nodes.clear();
+    trees.clear();
+    texts.clear();
+    node_count = 0;
+}
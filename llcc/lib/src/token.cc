@@ -6,13 +6,14 @@
 #include "../include/token.h"
 
 #include <iomanip>
+#include <cstring>
 
 using std::setw;
 using std::setfill;
 using std::endl;
 
 
-vector<string> Token::TOKEN_TYPE = {
+const char * const Token::TOKEN_TYPE[] = {
         "keyword",
         "identifier",
         "digit constant",
@@ -22,86 +23,266 @@ vector<string> Token::TOKEN_TYPE = {
 };
 
 
-map<string, TOKEN_TYPE_ENUM> Token::DETAIL_TOKEN_TYPE = {
-        {"include", TOKEN_TYPE_ENUM::INCLUDE},
-        {"print", TOKEN_TYPE_ENUM::PRINT},
-        {"class", TOKEN_TYPE_ENUM::CLASS},
-        {"public", TOKEN_TYPE_ENUM::PUBLIC},
-        {"private", TOKEN_TYPE_ENUM::PRIVATE},
-        {"void", TOKEN_TYPE_ENUM::VOID},
-        {"int", TOKEN_TYPE_ENUM::INT},
-        {"float", TOKEN_TYPE_ENUM::FLOAT},
-        {"char", TOKEN_TYPE_ENUM::CHAR},
-        {"double", TOKEN_TYPE_ENUM::DOUBLE},
-        {"for", TOKEN_TYPE_ENUM::FOR},
-        {"if", TOKEN_TYPE_ENUM::IF},
-        {"else", TOKEN_TYPE_ENUM::ELSE},
-        {"while", TOKEN_TYPE_ENUM::WHILE},
-        {"do", TOKEN_TYPE_ENUM::DO},
-        {"return", TOKEN_TYPE_ENUM::RETURN},
-        {"+", TOKEN_TYPE_ENUM::PLUS},
-        {"-", TOKEN_TYPE_ENUM::MINUS},
-        {"<", TOKEN_TYPE_ENUM::LT},
-        {">", TOKEN_TYPE_ENUM::GT},
-        {"!", TOKEN_TYPE_ENUM::NOT},
-        {"=", TOKEN_TYPE_ENUM::ASSIGN},
-        {"||", TOKEN_TYPE_ENUM::OR},
-        {"&&", TOKEN_TYPE_ENUM::AND},
-        {"==", TOKEN_TYPE_ENUM::EQUAL},
-        {"*", TOKEN_TYPE_ENUM::MUL},
-        {"%", TOKEN_TYPE_ENUM::MOD},
-        {"/", TOKEN_TYPE_ENUM::DIV},
-        {"++", TOKEN_TYPE_ENUM::SELF_PLUS},
-        {"--", TOKEN_TYPE_ENUM::SELF_MINUS},
-        {">>", TOKEN_TYPE_ENUM::RIGHT_SHIFT},
-        {"<<", TOKEN_TYPE_ENUM::LEFT_SHIFT},
-        {">=", TOKEN_TYPE_ENUM::GET},
-        {"<=", TOKEN_TYPE_ENUM::LET},
-        {"!=", TOKEN_TYPE_ENUM::NOT_EQUAL},
-        {"(", TOKEN_TYPE_ENUM::LL_BRACKET},
-        {")", TOKEN_TYPE_ENUM::RL_BRACKET},
-        {"{", TOKEN_TYPE_ENUM::LB_BRACKET},
-        {"}", TOKEN_TYPE_ENUM::RB_BRACKET},
-        {"[", TOKEN_TYPE_ENUM::LM_BRACKET},
-        {"]", TOKEN_TYPE_ENUM::RM_BRACKET},
-        {",", TOKEN_TYPE_ENUM::COMMA},
-        {"\"", TOKEN_TYPE_ENUM::DOUBLE_QUOTE},
-        {"\'", TOKEN_TYPE_ENUM::SINGLE_QUOTE},
-        {";", TOKEN_TYPE_ENUM::SEMICOLON},
-        {"#", TOKEN_TYPE_ENUM::SHARP},
+/*
+ * 关键字、运算符、分隔符的表都在编译时生成，不需要静态构造:
+ *      SPELLINGS           所有写法和具体类别
+ *      SpellingTable       以写法的哈希值为下标，存 SPELLINGS 的下标，哈希没有冲突 (完美哈希)
+ *      CharClassTable      每个字符是不是分隔符、是不是运算符的第一个字符
+ * C++11 的 constexpr 函数只能有一条 return，所以都写成递归
+ */
+namespace {
+
+constexpr TokenSpelling SPELLINGS[] = {
+        {"include", 7, TOKEN_TYPE_ENUM::INCLUDE},
+        {"print", 5, TOKEN_TYPE_ENUM::PRINT},
+        {"class", 5, TOKEN_TYPE_ENUM::CLASS},
+        {"public", 6, TOKEN_TYPE_ENUM::PUBLIC},
+        {"private", 7, TOKEN_TYPE_ENUM::PRIVATE},
+        {"void", 4, TOKEN_TYPE_ENUM::VOID},
+        {"int", 3, TOKEN_TYPE_ENUM::INT},
+        {"float", 5, TOKEN_TYPE_ENUM::FLOAT},
+        {"char", 4, TOKEN_TYPE_ENUM::CHAR},
+        {"double", 6, TOKEN_TYPE_ENUM::DOUBLE},
+        {"for", 3, TOKEN_TYPE_ENUM::FOR},
+        {"if", 2, TOKEN_TYPE_ENUM::IF},
+        {"else", 4, TOKEN_TYPE_ENUM::ELSE},
+        {"while", 5, TOKEN_TYPE_ENUM::WHILE},
+        {"do", 2, TOKEN_TYPE_ENUM::DO},
+        {"return", 6, TOKEN_TYPE_ENUM::RETURN},
+        {"+", 1, TOKEN_TYPE_ENUM::PLUS},
+        {"-", 1, TOKEN_TYPE_ENUM::MINUS},
+        {"<", 1, TOKEN_TYPE_ENUM::LT},
+        {">", 1, TOKEN_TYPE_ENUM::GT},
+        {"!", 1, TOKEN_TYPE_ENUM::NOT},
+        {"=", 1, TOKEN_TYPE_ENUM::ASSIGN},
+        {"||", 2, TOKEN_TYPE_ENUM::OR},
+        {"&&", 2, TOKEN_TYPE_ENUM::AND},
+        {"==", 2, TOKEN_TYPE_ENUM::EQUAL},
+        {"*", 1, TOKEN_TYPE_ENUM::MUL},
+        {"%", 1, TOKEN_TYPE_ENUM::MOD},
+        {"/", 1, TOKEN_TYPE_ENUM::DIV},
+        {"++", 2, TOKEN_TYPE_ENUM::SELF_PLUS},
+        {"--", 2, TOKEN_TYPE_ENUM::SELF_MINUS},
+        {">>", 2, TOKEN_TYPE_ENUM::RIGHT_SHIFT},
+        {"<<", 2, TOKEN_TYPE_ENUM::LEFT_SHIFT},
+        {">=", 2, TOKEN_TYPE_ENUM::GET},
+        {"<=", 2, TOKEN_TYPE_ENUM::LET},
+        {"!=", 2, TOKEN_TYPE_ENUM::NOT_EQUAL},
+        {"(", 1, TOKEN_TYPE_ENUM::LL_BRACKET},
+        {")", 1, TOKEN_TYPE_ENUM::RL_BRACKET},
+        {"{", 1, TOKEN_TYPE_ENUM::LB_BRACKET},
+        {"}", 1, TOKEN_TYPE_ENUM::RB_BRACKET},
+        {"[", 1, TOKEN_TYPE_ENUM::LM_BRACKET},
+        {"]", 1, TOKEN_TYPE_ENUM::RM_BRACKET},
+        {",", 1, TOKEN_TYPE_ENUM::COMMA},
+        {"\"", 1, TOKEN_TYPE_ENUM::DOUBLE_QUOTE},
+        {"\'", 1, TOKEN_TYPE_ENUM::SINGLE_QUOTE},
+        {";", 1, TOKEN_TYPE_ENUM::SEMICOLON},
+        {"#", 1, TOKEN_TYPE_ENUM::SHARP},
 };
 
+constexpr int SPELLING_COUNT = sizeof(SPELLINGS) / sizeof(SPELLINGS[0]);
+constexpr int MAX_SPELLING_LENGTH = 7;          // include private
+constexpr int HASH_SIZE = 128;
+
+// 分隔符的类别，# 不在词法分析的分隔符里
+constexpr bool isSeparatorType(TOKEN_TYPE_ENUM t) {
+    return TOKEN_TYPE_ENUM::LL_BRACKET <= t && t <= TOKEN_TYPE_ENUM::SEMICOLON;
+}
+
+constexpr bool isOperatorType(TOKEN_TYPE_ENUM t) {
+    return TOKEN_TYPE_ENUM::ASSIGN <= t && t <= TOKEN_TYPE_ENUM::NOT;
+}
+
+
+/**
+ * @brief 用长度、第一个和最后一个字符算哈希，系数是试出来的，让 SPELLINGS 互不冲突
+ */
+constexpr int spellingHash(const char * text, int length) {
+    return (length * 12 + (unsigned char) text[0] + (unsigned char) text[length - 1] * 14) & (HASH_SIZE - 1);
+}
+
+
+// 哈希值是 h 的写法在 SPELLINGS 里的下标，没有是 -1
+constexpr int spellingAt(int h, int i = 0) {
+    return i == SPELLING_COUNT ? -1 :
+           spellingHash(SPELLINGS[i].text, SPELLINGS[i].length) == h ? i :
+           spellingAt(h, i + 1);
+}
+
+
+// 哈希值是 h 的写法有几个
+constexpr int spellingsAt(int h, int i = 0) {
+    return i == SPELLING_COUNT ? 0 :
+           (spellingHash(SPELLINGS[i].text, SPELLINGS[i].length) == h ? 1 : 0) + spellingsAt(h, i + 1);
+}
+
+
+constexpr bool isPerfect(int h = 0) {
+    return h == HASH_SIZE || (spellingsAt(h) <= 1 && isPerfect(h + 1));
+}
 
-vector<string> Token::KEYWORDS = {
-        "int", "float", "double", "char", "void",
-        "class", "public", "private",
-        "if", "for", "while", "do", "else",
-        "include", "return", "print"
+static_assert(isPerfect(), "token spellings collide in the perfect hash, choose new coefficients in spellingHash");
+
+
+constexpr unsigned char CHAR_SEPARATOR = 1;     // 分隔符
+constexpr unsigned char CHAR_OPERATOR = 2;      // 运算符的第一个字符
+
+// 字符 ch 的类别
+constexpr unsigned char charClass(int ch, int i = 0) {
+    return i == SPELLING_COUNT ? 0 :
+           charClass(ch, i + 1) | ((unsigned char) SPELLINGS[i].text[0] != ch ? 0 :
+                                   SPELLINGS[i].length == 1 && isSeparatorType(SPELLINGS[i].type) ? CHAR_SEPARATOR :
+                                   isOperatorType(SPELLINGS[i].type) ? CHAR_OPERATOR : 0);
+}
+
+
+/* 0, 1, ..., N - 1，用来在编译时逐项生成表 */
+template <int... I>
+struct IndexList {};
+
+template <int N, int... I>
+struct MakeIndexList : MakeIndexList<N - 1, N - 1, I...> {};
+
+template <int... I>
+struct MakeIndexList<0, I...> {
+    typedef IndexList<I...> type;
 };
 
 
-vector<string> Token::OPERATORS = {"+",  "-",  "<",  ">", "!", "=", "*", "/", "%",
-                                   "++", "--", "<<", ">>","||", "&&", "==",
-                                   "<=", ">=", "!="};
+template <class L>
+struct SpellingTable;
+
+template <int... I>
+struct SpellingTable<IndexList<I...>> {
+    static constexpr signed char index[sizeof...(I)] = {spellingAt(I)...};
+};
+
+template <int... I>
+constexpr signed char SpellingTable<IndexList<I...>>::index[sizeof...(I)];
+
+
+template <class L>
+struct CharClassTable;
+
+template <int... I>
+struct CharClassTable<IndexList<I...>> {
+    static constexpr unsigned char classes[sizeof...(I)] = {charClass(I)...};
+};
+
+template <int... I>
+constexpr unsigned char CharClassTable<IndexList<I...>>::classes[sizeof...(I)];
+
+
+typedef SpellingTable<MakeIndexList<HASH_SIZE>::type> SPELLING_TABLE;
+typedef CharClassTable<MakeIndexList<256>::type> CHAR_CLASS_TABLE;
+
+}
 
 
-vector<char> Token::SEPARATORS = {'(', ')', '{', '}', '[', ']', ',', '\'', ';' , '\'', '\"'};
+/**
+ * @brief Token狗仔函数
+ */
+Token::Token() {
+    offset = length = 0;
+    type = TOKEN_TYPE_ENUM::NONE;
+    pos = -1;
+    line_number = -1;
+}
 
 
 /**
  * @brief Token狗仔函数
+ * @param source 整个源文件，Token 只记位置，源文件要比 Token 活得久
+ * @param _offset 在源文件里的位置
+ * @param _length 长度
  */
-Token::Token(string _value, TOKEN_TYPE_ENUM _type, int _pos, int _line_number) {
-    value = _value;
+Token::Token(const char * source, size_t _offset, size_t _length, TOKEN_TYPE_ENUM _type, int _pos, int _line_number) {
+    offset = uint32_t(_offset);
+    length = uint32_t(_length);
     type = _type;
     pos = _pos;
     line_number = _line_number;
 
     // 如果是分隔符、关键字和运算符的话，获取详细类别
+    // 表里没有的 (单独的 & |) 和原来查 map 插入的默认值一样当作 KEYWORD
     if (_type == TOKEN_TYPE_ENUM::SEPARATOR ||
         _type == TOKEN_TYPE_ENUM::KEYWORD ||
-        _type == TOKEN_TYPE_ENUM::OPERATOR)
-        type = Token::DETAIL_TOKEN_TYPE[_value];
+        _type == TOKEN_TYPE_ENUM::OPERATOR) {
+        type = detailType(source + _offset, _length);
+        if (type == TOKEN_TYPE_ENUM::NONE)
+            type = TOKEN_TYPE_ENUM::KEYWORD;
+    }
+}
+
+
+/**
+ * @brief 从源文件里取值
+ * @param source 生成 Token 的那个源文件
+ */
+string Token::value(const char * source) const {
+    return string(source + offset, length);
+}
+
+
+/**
+ * @brief 查关键字、运算符、分隔符的具体类别
+ * @param text 写法，不用以 '\0' 结尾
+ * @param length 长度
+ * @return 具体类别，不是关键字、运算符、分隔符返回 NONE
+ */
+TOKEN_TYPE_ENUM Token::detailType(const char * text, size_t length) {
+    if (length == 0 || length > size_t(MAX_SPELLING_LENGTH))
+        return TOKEN_TYPE_ENUM::NONE;
+
+    int i = SPELLING_TABLE::index[spellingHash(text, int(length))];
+    if (i < 0 || SPELLINGS[i].length != int(length) || memcmp(SPELLINGS[i].text, text, length) != 0)
+        return TOKEN_TYPE_ENUM::NONE;
+    return SPELLINGS[i].type;
+}
+
+
+TOKEN_TYPE_ENUM Token::detailType(const string & text) {
+    return detailType(text.data(), text.size());
+}
+
+
+/**
+ * @brief 具体类别的写法，报错的时候用
+ * @return 写法，没有返回 nullptr
+ */
+const char * Token::spelling(TOKEN_TYPE_ENUM t) {
+    for (auto & s: SPELLINGS)
+        if (s.type == t)
+            return s.text;
+    return nullptr;
+}
+
+
+/**
+ * @brief 判断是否是关键词
+ * @param text 词，不用以 '\0' 结尾
+ * @param length 长度
+ */
+bool Token::isKeyword(const char * text, size_t length) {
+    TOKEN_TYPE_ENUM t = detailType(text, length);
+    return TOKEN_TYPE_ENUM::INCLUDE <= t && t <= TOKEN_TYPE_ENUM::RETURN;
+}
+
+
+/**
+ * @brief 判断是否是分隔符
+ */
+bool Token::isSeparator(char ch) {
+    return CHAR_CLASS_TABLE::classes[(unsigned char) ch] & CHAR_SEPARATOR;
+}
+
+
+/**
+ * @brief 判断是否是运算符的第一个字符
+ */
+bool Token::isOperator(char ch) {
+    return CHAR_CLASS_TABLE::classes[(unsigned char) ch] & CHAR_OPERATOR;
 }
 
 
@@ -147,10 +328,11 @@ bool Token::isBoolOperator(TOKEN_TYPE_ENUM t) {
 
 
 /**
- * @brief 重载token输出流
+ * @brief 输出token
+ * @param source 生成 Token 的那个源文件
  */
-ostream & operator << (ostream & out, Token & t) {
-    TOKEN_TYPE_ENUM detail_type = t.type;
+void Token::display(ostream & out, const char * source) const {
+    TOKEN_TYPE_ENUM detail_type = type;
     int general_type = int(detail_type);
 
     // 输出detail type太啰嗦 这里对应回去 输出general type就好
@@ -164,9 +346,8 @@ ostream & operator << (ostream & out, Token & t) {
         detail_type <= TOKEN_TYPE_ENUM::SHARP)
         general_type = int(TOKEN_TYPE_ENUM::SEPARATOR);
 
-    out << setw(10) << setfill(' ') << t.value;
+    out << setw(10) << setfill(' ') << value(source);
     out << setw(10) << setfill(' ') << "type: ";
     out << Token::TOKEN_TYPE[general_type];
     out << endl;
-    return out;
 }
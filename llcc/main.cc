@@ -28,19 +28,43 @@ map<string, string> OPT = {
         {"--parser", "parser"},
         {"-a", "assembler"},
         {"--assembler", "assembler"},
+        {"-b", "binary"},
+        {"--binary", "binary"},
+        {"-m", "module"},
+        {"--module", "module"},
+        {"-k", "link"},
+        {"--link", "link"},
         {"-i", "interpreter"},
-        {"--interpreter", "interpreter"}
+        {"--interpreter", "interpreter"},
+        {"-j", "jit"},
+        {"--jit", "jit"},
+        {"-e", "emit-asm"},
+        {"--emit-asm", "emit-asm"},
+        {"-c", "checkpoint"},
+        {"--checkpoint", "checkpoint"},
+        {"-s", "steps"},
+        {"--steps", "steps"},
+        {"-r", "resume"},
+        {"--resume", "resume"}
 };
 
 
 map<string, string> HELP_TEXT = {
         {"help", "get help on llcc command line arguments"},
         {"version", "display llcc version"},
-        {"output", "the output file path"},
+        {"output", "write the program output (or the assembly of -e) to a file"},
         {"lexer", "lexical analyze a source AC file"},
         {"parser", "syntax analyze a source AC file"},
         {"assembler", "generate inter code(Quadruple) for a source AC file"},
-        {"interpreter", "interpret and execute an inter code file"}
+        {"binary", "with -a or -k, generate binary bytecode(.icb) instead of text"},
+        {"module", "with -a, compile to a relocatable object(.ico) for -k"},
+        {"link", "link relocatable objects(.ico) into one program, exactly one defines main"},
+        {"interpreter", "interpret and execute an inter code file"},
+        {"jit", "compile a source AC file and execute it with the x86-64 JIT"},
+        {"emit-asm", "compile a source AC file to x86-64 assembly(.s), build it with gcc"},
+        {"checkpoint", "with -i, save the interpreter state to a file on SIGUSR1/SIGINT/SIGTERM"},
+        {"steps", "with -c, also save the checkpoint every N instructions"},
+        {"resume", "with -i, continue from a checkpoint file"}
 };
 
 
@@ -56,7 +80,12 @@ void getHelp() {
     string temp_info;
     for (auto it = HELP_TEXT.begin(); it != HELP_TEXT.end(); it ++ ) {
         temp_info = it -> first;
-        display_info = "-" + temp_info.substr(0, 1) + ", --" + temp_info;
+        // 短选项不一定是长选项的首字母
+        display_info = "-" + temp_info.substr(0, 1);
+        for (auto & opt: OPT)
+            if (opt.first.size() == 2 && opt.second == temp_info)
+                display_info = opt.first;
+        display_info += ", --" + temp_info;
 
         cout << setw(30) << setfill(' ') << std::left << display_info;
         cout << it -> second << endl;
@@ -67,7 +96,13 @@ void getHelp() {
     cout << "acc source.ac -l" << endl;
     cout << "acc source.ac -p" << endl;
     cout << "acc source.ac -a" << endl;
+    cout << "acc source.ac -a -b && acc source.ac.icb -i" << endl;
     cout << "acc source.ac.ic -i" << endl;
+    cout << "acc main.ac -a -m && acc util.ac -a -m && acc main.ac.ico -k util.ac.ico -o prog.ic && acc prog.ic -i" << endl;
+    cout << "acc source.ac.icb -i -c state.ckpt -s 100000000 && acc source.ac.icb -i -r state.ckpt" << endl;
+    cout << "acc source.ac -j" << endl;
+    cout << "acc source.ac -o result.txt" << endl;
+    cout << "acc source.ac -e && gcc source.ac.s -o source" << endl;
     cout << "acc source.ac" << endl;
     cout << "acc -h" << endl;
     cout << "acc -v" << endl;
@@ -78,7 +113,7 @@ void getHelp() {
  * @brief 输出 version text
  */
 void getVersion() {
-    cout << "LLCC v1.1" << endl;
+    cout << "LLCC " << LLCC_VERSION << endl;
     cout << "developed by cjhahaha (https://github.com/cjhahaha/toy-compiler) " << endl;
 }
 
@@ -104,19 +139,75 @@ int main(int argc, char * argv[]) {
             return 0;
         }
         else {
+            // -o -c -s -r 带一个参数，-b -m 修饰 -a，先取出来，对后面所有的操作都有效
+            // 不是选项的是 -k 要链接的其他目标文件
+            map<string, string> values;
+            bool binary = false, module = false, link = false;
+            vector<string> opts, inputs = {path};
             for (int i = 2; i < argc; i ++) {
                 string opt = argv[i];
-                opt = OPT[opt];
+                if (OPT[opt] == "binary") {
+                    binary = true;
+                    continue;
+                }
+                if (OPT[opt] == "module") {
+                    module = true;
+                    continue;
+                }
+                if (OPT[opt] == "link")
+                    link = true;
+                if (! opt.empty() && opt[0] != '-') {
+                    inputs.emplace_back(opt);
+                    continue;
+                }
+                if (OPT[opt] != "output" && OPT[opt] != "checkpoint" && OPT[opt] != "steps" && OPT[opt] != "resume") {
+                    opts.emplace_back(opt);
+                    continue;
+                }
+                if (i + 1 >= argc) {
+                    cout << endl << "Error: missing value after `" << opt << "`" << endl;
+                    return 0;
+                }
+                values[OPT[opt]] = argv[++ i];
+            }
+            string output = values["output"];
+            long long steps = atoll(values["steps"].c_str());
+            if (steps < 0) {
+                cout << endl << "Error: the number of steps must not be negative" << endl;
+                return 0;
+            }
+
+            if (inputs.size() > 1 && ! link) {
+                cout << endl << "Error: unknown argument: `" << inputs[1] << "`" << endl;
+                return 0;
+            }
+
+            // 只有 -o 时照常编译执行
+            if (opts.empty())
+                compile_and_execute(path, false, output);
+
+            for (auto & arg: opts) {
+                string opt = OPT[arg];
                 if (opt == "lexer")
                     lexer(path);
                 else if (opt == "parser")
                     parser(path);
+                else if (opt == "assembler" && module)
+                    object_generator(path, output);
+                else if (opt == "assembler" && binary)
+                    bytecode_generator(path, output);
                 else if (opt == "assembler")
                     code_generator(path);
                 else if (opt == "interpreter")
-                    interpreter(path);
+                    interpreter(path, output, values["checkpoint"], steps, values["resume"]);
+                else if (opt == "jit")
+                    compile_and_execute(path, true, output);
+                else if (opt == "emit-asm")
+                    emit_asm(path, output);
+                else if (opt == "link")
+                    link_objects(inputs, output, binary);
                 else {
-                    cout << endl << "Error: unknown argument: `" << argv[i] << "`" << endl;
+                    cout << endl << "Error: unknown argument: `" << arg << "`" << endl;
                     return 0;
                 }
             }